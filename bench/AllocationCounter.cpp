@@ -0,0 +1,60 @@
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace Rovi {
+    namespace {
+        std::atomic<uint64_t> allocations{0};
+
+        void* allocate(const std::size_t size) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+            auto pointer = std::malloc(size > 0 ? size : 1);
+            if(pointer == nullptr) {
+                throw std::bad_alloc{};
+            }
+            return pointer;
+        }
+
+        void* allocateAligned(const std::size_t size, const std::align_val_t alignment) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+            auto pointer = static_cast<void*>(nullptr);
+            if(posix_memalign(&pointer, std::max(sizeof(void*), static_cast<std::size_t>(alignment)), size > 0 ? size : 1) != 0) {
+                throw std::bad_alloc{};
+            }
+            return pointer;
+        }
+    }
+
+    uint64_t allocationCount() {
+        return allocations.load(std::memory_order_relaxed);
+    }
+}
+
+// Replacements of the global allocation functions. The array and nothrow versions of the standard library forward
+// to these.
+void* operator new(std::size_t size) {
+    return Rovi::allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return Rovi::allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
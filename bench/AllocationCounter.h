@@ -0,0 +1,31 @@
+#ifndef __BENCH_ALLOCATIONCOUNTER_H__
+#define __BENCH_ALLOCATIONCOUNTER_H__
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+namespace Rovi {
+    // Heap allocations of the process so far (the global operator new is replaced in AllocationCounter.cpp)
+    uint64_t allocationCount();
+
+    // Reports the heap allocations per iteration as counter "allocs_per_op". Create it directly before the
+    // benchmark loop, so the allocations of the setup are not counted:
+    //   auto allocations = AllocationCounter{state};
+    //   for(auto _ : state) { ... }
+    class AllocationCounter {
+        public:
+            explicit AllocationCounter(benchmark::State& state) : m_state{state}, m_start{allocationCount()} {}
+            ~AllocationCounter() {
+                m_state.counters["allocs_per_op"] = benchmark::Counter(static_cast<double>(allocationCount() - m_start),
+                    benchmark::Counter::kAvgIterations);
+            }
+            AllocationCounter(const AllocationCounter&) = delete;
+            AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+        private:
+            benchmark::State& m_state;
+            uint64_t m_start;
+    };
+}
+
+#endif /* __BENCH_ALLOCATIONCOUNTER_H__ */
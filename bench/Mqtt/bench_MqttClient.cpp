@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Mqtt/MqttClient.h"
+#include "Mqtt/FakeBroker.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Rovi {
+    namespace Mqtt {
+        // Gateway with 'count' simulated devices on one connection to the in-process broker (loopback TCP)
+        class SimulatedFleet {
+            public:
+                explicit SimulatedFleet(const size_t count) : m_broker{m_loop}, m_client{m_loop, options()} {
+                    m_broker.listen();
+                    for(size_t i = 0; i < count; ++i) {
+                        char mac[18];
+                        snprintf(mac, sizeof(mac), "DE:AD:BE:%02X:%02X:%02X",
+                            static_cast<unsigned>((i >> 16) & 0xFF), static_cast<unsigned>((i >> 8) & 0xFF), static_cast<unsigned>(i & 0xFF));
+                        auto hwInfo = std::make_shared<Homie::HWInfo>(mac, "192.168.0.10", "esp32");
+                        m_devices.push_back(std::make_shared<Homie::Device>("Device", hwInfo, "firmware",
+                            std::make_shared<Homie::Version>(1, 0, 0), std::chrono::seconds{60}));
+                        m_client.addDevice(m_devices.back());
+                    }
+                    m_client.connect("127.0.0.1", m_broker.port());
+                    waitForBroker();
+
+                    m_broker.setPublishHandler([this](const PublishView&) {
+                        m_completions.push_back(Clock::now() - m_published);
+                    });
+                }
+
+                // Publish the stats of all devices and wait until the broker received them.
+                // Returns the number of messages.
+                uint64_t publishUpdates(const bool batched) {
+                    auto published = m_client.statistics().publishedMessages;
+                    m_published = Clock::now();
+                    if(batched) {
+                        m_client.publishUpdates();
+                    } else {
+                        for(auto& device : m_devices) {
+                            m_client.publishUpdate(*device);
+                        }
+                    }
+                    waitForBroker();
+                    return m_client.statistics().publishedMessages - published;
+                }
+
+                // Time from the start of the publication cycle until the broker decoded a message. It grows with the
+                // position of the message in the cycle, so the 99th percentile is close to the time to complete the whole
+                // cycle and not the latency of a single message.
+                void reportCycleCompletion(benchmark::State& state) {
+                    if(m_completions.empty()) {
+                        return;
+                    }
+                    auto p99 = m_completions.begin() + static_cast<std::ptrdiff_t>(m_completions.size() * 99 / 100);
+                    std::nth_element(m_completions.begin(), p99, m_completions.end());
+                    state.counters["cycle_p99_us"] = std::chrono::duration<double, std::micro>(*p99).count();
+                }
+
+            private:
+                static ConnectOptions options() {
+                    auto options = ConnectOptions{};
+                    options.clientID = "gateway";
+                    return options;
+                }
+
+                void waitForBroker() {
+                    while(m_broker.receivedMessages() < m_client.statistics().publishedMessages) {
+                        m_loop.runOnce(std::chrono::milliseconds{10});
+                    }
+                }
+
+                EventLoop m_loop;
+                FakeBroker m_broker;
+                MqttClient m_client;
+                std::vector<std::shared_ptr<Homie::Device>> m_devices;
+                Clock::time_point m_published;
+                std::vector<Clock::duration> m_completions;
+        };
+
+        // One batch (and as few sendmsg() calls as the socket allows) for all devices
+        static void BM_MqttClient_publishUpdates_batched(benchmark::State& state) {
+            auto fleet = SimulatedFleet{static_cast<size_t>(state.range(0))};
+            auto messages = uint64_t{0};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                messages += fleet.publishUpdates(true);
+            }
+            state.SetItemsProcessed(static_cast<int64_t>(messages));
+            fleet.reportCycleCompletion(state);
+        }
+        BENCHMARK(BM_MqttClient_publishUpdates_batched)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+        // One batch per device, pipelined over the same connection
+        static void BM_MqttClient_publishUpdates_perDevice(benchmark::State& state) {
+            auto fleet = SimulatedFleet{static_cast<size_t>(state.range(0))};
+            auto messages = uint64_t{0};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                messages += fleet.publishUpdates(false);
+            }
+            state.SetItemsProcessed(static_cast<int64_t>(messages));
+            fleet.reportCycleCompletion(state);
+        }
+        BENCHMARK(BM_MqttClient_publishUpdates_perDevice)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+    }
+}
@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Mqtt/MqttPacket.h"
+#include "Device.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+
+namespace Rovi {
+    namespace Mqtt {
+        // Socketpair with a thread on the receiving side that discards everything
+        class DrainedSocket {
+            public:
+                DrainedSocket() {
+                    socketpair(AF_UNIX, SOCK_STREAM, 0, m_fds);
+                    m_reader = std::thread{[this]() {
+                        char buffer[65536];
+                        while(read(m_fds[1], buffer, sizeof(buffer)) > 0) {
+                        }
+                    }};
+                }
+                ~DrainedSocket() {
+                    shutdown(m_fds[0], SHUT_WR);
+                    m_reader.join();
+                    close(m_fds[0]);
+                    close(m_fds[1]);
+                }
+
+                int fd() const { return m_fds[0]; }
+
+            private:
+                int m_fds[2];
+                std::thread m_reader;
+        };
+
+        // A batch of 'count' device statistics, similar to the attributes of Device::update()
+        static Homie::AttributeBuffer createAttributes(const size_t count) {
+            auto buffer = Homie::AttributeBuffer{};
+            auto prefix = Homie::TopicType{"homie", "super-car-deadbeeffeed", "$stats"};
+            for(size_t i = 0; i < count; ++i) {
+                buffer.append(prefix, Homie::TopicType{"stat" + std::to_string(i)}, std::to_string(i * 1000));
+            }
+            return buffer;
+        }
+
+        // Reference: One packet buffer and one send() per message
+        static void BM_Mqtt_sendPerMessage(benchmark::State& state) {
+            auto socket = DrainedSocket{};
+            auto buffer = createAttributes(static_cast<size_t>(state.range(0)));
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                for(size_t i = 0; i < buffer.size(); ++i) {
+                    auto packet = encodePublish(buffer.topic(i), buffer.payload(i), QoS::atMostOnce, true);
+                    send(socket.fd(), packet.data(), packet.size(), 0);
+                }
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+        }
+        BENCHMARK(BM_Mqtt_sendPerMessage)->Arg(10)->Arg(100)->Arg(1000);
+
+        // Headers only, topics and payloads referenced in place, one writev() per batch
+        static void BM_Mqtt_writevBatch(benchmark::State& state) {
+            auto socket = DrainedSocket{};
+            auto buffer = createAttributes(static_cast<size_t>(state.range(0)));
+            auto batch = PublishBatch{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                batch.clear();
+                batch.encode(buffer);
+                auto& iovecs = batch.iovecs();
+                writeAll(socket.fd(), iovecs.data(), iovecs.size());
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+        }
+        BENCHMARK(BM_Mqtt_writevBatch)->Arg(10)->Arg(100)->Arg(1000);
+
+        static void BM_Mqtt_encodeBatch(benchmark::State& state) {
+            auto buffer = createAttributes(static_cast<size_t>(state.range(0)));
+            auto batch = PublishBatch{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                batch.clear();
+                batch.encode(buffer);
+                benchmark::DoNotOptimize(batch.iovecs().data());
+            }
+            state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+        }
+        BENCHMARK(BM_Mqtt_encodeBatch)->Arg(100);
+    }
+}
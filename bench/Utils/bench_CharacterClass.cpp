@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Utils/CharacterClass.h"
+
+namespace Rovi {
+    // Reference implementation: StringUtils::checkStringForAllowedCharacters() before CharacterClass was introduced
+    static bool findAllowedCharacters(const std::string& inputString, const std::string& allowedChars) {
+        bool ok = true;
+        for(auto& character : inputString) {
+            ok = allowedChars.find(character) != std::string::npos;
+            if(!ok) {
+                break;
+            }
+        }
+        return ok;
+    }
+
+    static std::string topicIDInput(const size_t length) {
+        auto str = std::string{};
+        for(size_t i = 0; i < length; ++i) {
+            str += "abcdefghijklmnopqrstuvwxyz0123456789-"[i % 37];
+        }
+        return str;
+    }
+
+    static void BM_CharacterClass_find(benchmark::State& state) {
+        const auto input = topicIDInput(static_cast<size_t>(state.range(0)));
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(findAllowedCharacters(input, std::string("abcdefghijklmnopqrstuvwxyz-01234567890")));
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+    BENCHMARK(BM_CharacterClass_find)->Arg(22)->Arg(4096);
+
+    static void BM_CharacterClass_matchesAll(benchmark::State& state) {
+        const auto input = topicIDInput(static_cast<size_t>(state.range(0)));
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(CharacterClass::topicID().matchesAll(input));
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+    BENCHMARK(BM_CharacterClass_matchesAll)->Arg(22)->Arg(4096);
+
+    // Lookup table only (more ranges than supported by the SIMD path)
+    static void BM_CharacterClass_matchesAllScalar(benchmark::State& state) {
+        const auto characterClass = CharacterClass{"abcdefghijklmnopqrstuvwxyz0123456789-_$/"};
+        const auto input = topicIDInput(static_cast<size_t>(state.range(0)));
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(characterClass.matchesAll(input));
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+    BENCHMARK(BM_CharacterClass_matchesAllScalar)->Arg(22)->Arg(4096);
+}
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Utils/FlatHashMap.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Rovi {
+    // Inbound topics homie/<device>/sensor-<i>/value/set in random order. The lookups use the node level of
+    // the topic, as the router does for inbound messages.
+    static std::vector<std::string> inboundTopics(const size_t nodes) {
+        auto topics = std::vector<std::string>{};
+        for(size_t i = 0; i < nodes; ++i) {
+            topics.push_back("homie/super-car-deadbeeffeed/sensor-" + std::to_string(i) + "/value/set");
+        }
+        std::shuffle(topics.begin(), topics.end(), std::mt19937{42});
+        topics.resize(std::min(nodes, size_t{4096}));
+        return topics;
+    }
+
+    static std::string_view nodeLevel(std::string_view topic) {
+        auto begin = topic.find('/', 6) + 1;
+        return topic.substr(begin, topic.find('/', begin) - begin);
+    }
+
+    // Reference: The registry of Device::node() before, std::map with std::string keys
+    static void BM_StdMap_nodeLookup(benchmark::State& state) {
+        auto nodes = static_cast<size_t>(state.range(0));
+        auto map = std::map<std::string, void*>{};
+        for(size_t i = 0; i < nodes; ++i) {
+            map.emplace("sensor-" + std::to_string(i), &map);
+        }
+        auto topics = inboundTopics(nodes);
+        size_t next = 0;
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            // std::map<std::string, ...> needs a temporary std::string
+            benchmark::DoNotOptimize(map.find(std::string{nodeLevel(topics[next])}));
+            next = next + 1 < topics.size() ? next + 1 : 0;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_StdMap_nodeLookup)->Arg(10)->Arg(1000)->Arg(100000);
+
+    static void BM_UnorderedMap_nodeLookup(benchmark::State& state) {
+        auto nodes = static_cast<size_t>(state.range(0));
+        auto map = std::unordered_map<std::string, void*>{};
+        for(size_t i = 0; i < nodes; ++i) {
+            map.emplace("sensor-" + std::to_string(i), &map);
+        }
+        auto topics = inboundTopics(nodes);
+        size_t next = 0;
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(map.find(std::string{nodeLevel(topics[next])}));
+            next = next + 1 < topics.size() ? next + 1 : 0;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_UnorderedMap_nodeLookup)->Arg(10)->Arg(1000)->Arg(100000);
+
+    static void BM_FlatHashMap_nodeLookup(benchmark::State& state) {
+        auto nodes = static_cast<size_t>(state.range(0));
+        auto map = FlatHashMap<void*>{};
+        for(size_t i = 0; i < nodes; ++i) {
+            map.insert("sensor-" + std::to_string(i), &map);
+        }
+        auto topics = inboundTopics(nodes);
+        size_t next = 0;
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(map.find(nodeLevel(topics[next])));
+            next = next + 1 < topics.size() ? next + 1 : 0;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_FlatHashMap_nodeLookup)->Arg(10)->Arg(1000)->Arg(100000);
+}
@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+#include "Utils/MpscQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Rovi {
+    using Clock = std::chrono::steady_clock;
+
+    // Reference: std::deque guarded by a mutex, drained in batches like the MpscQueue
+    template<typename T>
+    class MutexDeque {
+        public:
+            explicit MutexDeque(const size_t capacity) : m_capacity{capacity} {}
+
+            bool push(T value) {
+                auto lock = std::lock_guard<std::mutex>{m_mutex};
+                if(m_values.size() >= m_capacity) {
+                    return false;
+                }
+                m_values.push_back(std::move(value));
+                return true;
+            }
+
+            template<typename Consumer>
+            size_t drain(Consumer&& consumer, const size_t maxCount) {
+                auto lock = std::lock_guard<std::mutex>{m_mutex};
+                auto count = std::min(maxCount, m_values.size());
+                for(size_t i = 0; i < count; ++i) {
+                    consumer(m_values.front());
+                    m_values.pop_front();
+                }
+                return count;
+            }
+
+        protected:
+            std::mutex m_mutex;
+            std::deque<T> m_values;
+            size_t m_capacity;
+    };
+
+    // Single consumer thread draining batches of 256 and summing up the latency from push to drain
+    template<typename Queue>
+    class LatencyConsumer {
+        public:
+            explicit LatencyConsumer(Queue& queue) : m_queue{queue}, m_running{true}, m_count{0}, m_latency{0} {
+                m_thread = std::thread{[this]() {
+                    while(m_running.load(std::memory_order_relaxed)) {
+                        if(drain() == 0) {
+                            std::this_thread::yield();
+                        }
+                    }
+                    while(drain() > 0) {
+                    }
+                }};
+            }
+
+            // All producers have to be finished
+            void stop() {
+                m_running = false;
+                m_thread.join();
+            }
+
+            uint64_t count() const { return m_count; }
+            double averageLatency() const { return m_count > 0 ? static_cast<double>(m_latency) / static_cast<double>(m_count) : 0.0; }
+
+        protected:
+            size_t drain() {
+                auto now = Clock::now().time_since_epoch().count();
+                return m_queue.drain([this, now](int64_t& pushed) {
+                    m_latency += static_cast<uint64_t>(now - pushed);
+                    ++m_count;
+                }, 256);
+            }
+
+            Queue& m_queue;
+            std::atomic<bool> m_running;
+            std::thread m_thread;
+            uint64_t m_count;
+            uint64_t m_latency;
+    };
+
+    // Every benchmark thread is a producer pushing its timestamp, a full queue is retried.
+    // latency_ns: Average time from push to drain. Includes the wait for the consumer, which shares the CPU
+    // with the producers if there are less cores than threads.
+    template<typename Queue>
+    static void queueLatency(benchmark::State& state, Queue*& queue, LatencyConsumer<Queue>*& consumer) {
+        if(state.thread_index() == 0) {
+            queue = new Queue(65536);
+            consumer = new LatencyConsumer<Queue>{*queue};
+        }
+        auto retries = int64_t{0};
+        for(auto _ : state) {
+            auto now = Clock::now().time_since_epoch().count();
+            while(!queue->push(now)) {
+                ++retries;
+                std::this_thread::yield();
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["full_retries"] = benchmark::Counter(static_cast<double>(retries));
+        if(state.thread_index() == 0) {
+            // The loop ends with a barrier, all producers are done
+            consumer->stop();
+            state.counters["latency_ns"] = consumer->averageLatency();
+            delete consumer;
+            delete queue;
+        }
+    }
+
+    static void BM_MpscQueue_latency(benchmark::State& state) {
+        static MpscQueue<int64_t>* queue = nullptr;
+        static LatencyConsumer<MpscQueue<int64_t>>* consumer = nullptr;
+        queueLatency(state, queue, consumer);
+    }
+    BENCHMARK(BM_MpscQueue_latency)->ThreadRange(1, 8)->UseRealTime();
+
+    static void BM_MutexDeque_latency(benchmark::State& state) {
+        static MutexDeque<int64_t>* queue = nullptr;
+        static LatencyConsumer<MutexDeque<int64_t>>* consumer = nullptr;
+        queueLatency(state, queue, consumer);
+    }
+    BENCHMARK(BM_MutexDeque_latency)->ThreadRange(1, 8)->UseRealTime();
+
+    // Producer side only: Contended push() into a ring which is drained by benchmark thread 0
+    static void BM_MpscQueue_contention(benchmark::State& state) {
+        static MpscQueue<int64_t>* queue = nullptr;
+        if(state.thread_index() == 0) {
+            queue = new MpscQueue<int64_t>{1024};
+        }
+        for(auto _ : state) {
+            if(state.thread_index() == 0) {
+                queue->drain([](int64_t&) {}, 64);
+            } else {
+                queue->push(1);
+            }
+        }
+        if(state.thread_index() == 0) {
+            auto statistics = queue->statistics();
+            state.counters["contended_per_push"] = statistics.pushed > 0
+                ? static_cast<double>(statistics.contended) / static_cast<double>(statistics.pushed) : 0.0;
+            state.counters["high_watermark"] = static_cast<double>(statistics.highWatermark);
+            delete queue;
+        }
+    }
+    BENCHMARK(BM_MpscQueue_contention)->ThreadRange(2, 8)->UseRealTime();
+}
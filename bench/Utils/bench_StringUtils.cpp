@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Utils/StringUtils.h"
+
+namespace Rovi {
+    // Reference implementation: StringUtils::toString() before the stream-free formatting was introduced
+    template<typename T>
+    static std::string streamToString(T value) {
+        std::stringstream ss;
+        ss << value;
+        return ss.str();
+    }
+
+    static void BM_StringUtils_streamToString_Integer(benchmark::State& state) {
+        auto value = uint32_t{5242880};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(streamToString(value));
+        }
+    }
+    BENCHMARK(BM_StringUtils_streamToString_Integer);
+
+    static void BM_StringUtils_toString_Integer(benchmark::State& state) {
+        auto value = uint32_t{5242880};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::toString(value));
+        }
+    }
+    BENCHMARK(BM_StringUtils_toString_Integer);
+
+    static void BM_StringUtils_formatNumber_Integer(benchmark::State& state) {
+        char buffer[StringUtils::maxNumberLength];
+        auto value = int64_t{-9223372036854775807};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::formatNumber(buffer, sizeof(buffer), value));
+            benchmark::ClobberMemory();
+        }
+    }
+    BENCHMARK(BM_StringUtils_formatNumber_Integer);
+
+    static void BM_StringUtils_streamToString_Float(benchmark::State& state) {
+        auto value = 3.3f;
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(streamToString(value));
+        }
+    }
+    BENCHMARK(BM_StringUtils_streamToString_Float);
+
+    static void BM_StringUtils_toString_Float(benchmark::State& state) {
+        auto value = 3.3f;
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::toString(value));
+        }
+    }
+    BENCHMARK(BM_StringUtils_toString_Float);
+
+    static void BM_StringUtils_formatNumber_Float(benchmark::State& state) {
+        char buffer[StringUtils::maxNumberLength];
+        auto value = -123.456;
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::formatNumber(buffer, sizeof(buffer), value));
+            benchmark::ClobberMemory();
+        }
+    }
+    BENCHMARK(BM_StringUtils_formatNumber_Float);
+
+    static void BM_StringUtils_splitString(benchmark::State& state) {
+        const auto str = std::string{"uptime,signal,cputemp,cpuload,battery,freeheap,supply"};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::splitString(str, ','));
+        }
+    }
+    BENCHMARK(BM_StringUtils_splitString);
+
+    static void BM_StringUtils_tokenize(benchmark::State& state) {
+        const auto str = std::string{"uptime,signal,cputemp,cpuload,battery,freeheap,supply"};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            for(auto token : StringUtils::tokenize(str, ',')) {
+                benchmark::DoNotOptimize(token);
+            }
+        }
+    }
+    BENCHMARK(BM_StringUtils_tokenize);
+
+    // Payload of 'size' characters with surrounding whitespace
+    static std::string paddedPayload(const int64_t size) {
+        return "  \t" + std::string(static_cast<size_t>(size), 'A') + "\t  ";
+    }
+
+    static void BM_StringUtils_trim(benchmark::State& state) {
+        const auto str = paddedPayload(state.range(0));
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::trim(str));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_StringUtils_trim)->RangeMultiplier(8)->Range(8, 32768);
+
+    static void BM_StringUtils_trimView(benchmark::State& state) {
+        const auto str = paddedPayload(state.range(0));
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::trimView(str));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_StringUtils_trimView)->RangeMultiplier(8)->Range(8, 32768);
+
+    static void BM_StringUtils_toLower(benchmark::State& state) {
+        const auto str = paddedPayload(state.range(0));
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::toLower(str));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_StringUtils_toLower)->RangeMultiplier(8)->Range(8, 32768);
+
+    static void BM_StringUtils_checkStringForAllowedCharacters(benchmark::State& state) {
+        const auto str = std::string(static_cast<size_t>(state.range(0)), '7');
+        const auto allowed = std::string{"0123456789-"};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::checkStringForAllowedCharacters(str, allowed));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_StringUtils_checkStringForAllowedCharacters)->RangeMultiplier(8)->Range(8, 32768);
+
+    static void BM_StringUtils_removeCharsFromString(benchmark::State& state) {
+        const auto str = std::string{"DE:AD:BE:EF:FE:ED"};
+        const auto separators = std::string{":"};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::removeCharsFromString(str, separators));
+        }
+    }
+    BENCHMARK(BM_StringUtils_removeCharsFromString);
+
+    static void BM_StringUtils_fullfile(benchmark::State& state) {
+        const auto directory = std::string{"/sys/class/power_supply"};
+        const auto file = std::string{"BAT0"};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(StringUtils::fullfile(directory, file));
+        }
+    }
+    BENCHMARK(BM_StringUtils_fullfile);
+}
+
+BENCHMARK_MAIN();
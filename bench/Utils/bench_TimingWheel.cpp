@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Utils/TimingWheel.h"
+
+#include <queue>
+#include <random>
+
+namespace Rovi {
+    // 'count' periodic timers with intervals between 10 s and 10 min at 100 ms resolution. Each iteration
+    // advances the time by one tick and reschedules every expired timer (items = expired timers).
+    static std::vector<uint64_t> createIntervals(const size_t count) {
+        auto generator = std::mt19937_64{42};
+        auto distribution = std::uniform_int_distribution<uint64_t>{100, 6000};
+        auto intervals = std::vector<uint64_t>(count);
+        for(auto& interval : intervals) {
+            interval = distribution(generator);
+        }
+        return intervals;
+    }
+
+    // Reference: Binary heap, O(log n) per insert and expiry
+    static void BM_TimingWheel_priorityQueue(benchmark::State& state) {
+        auto intervals = createIntervals(static_cast<size_t>(state.range(0)));
+        using Timer = std::pair<uint64_t, uint32_t>;
+        auto queue = std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>>{};
+        for(uint32_t i = 0; i < intervals.size(); ++i) {
+            queue.emplace(intervals[i] * i / intervals.size(), i);
+        }
+        auto tick = uint64_t{0};
+        auto expired = int64_t{0};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            while(!queue.empty() && queue.top().first <= tick) {
+                auto timer = queue.top();
+                queue.pop();
+                queue.emplace(timer.first + intervals[timer.second], timer.second);
+                ++expired;
+            }
+            ++tick;
+        }
+        state.SetItemsProcessed(expired);
+    }
+    BENCHMARK(BM_TimingWheel_priorityQueue)->Arg(10000)->Arg(100000);
+
+    static void BM_TimingWheel_wheel(benchmark::State& state) {
+        auto intervals = createIntervals(static_cast<size_t>(state.range(0)));
+        auto wheel = TimingWheel<uint32_t>{};
+        for(uint32_t i = 0; i < intervals.size(); ++i) {
+            wheel.schedule(intervals[i] * i / intervals.size(), i);
+        }
+        auto tick = uint64_t{0};
+        auto expired = int64_t{0};
+        auto allocations = AllocationCounter{state};
+        for(auto _ : state) {
+            expired += static_cast<int64_t>(wheel.advance(tick, [&](TimingWheel<uint32_t>::TimerID, uint32_t& index, uint64_t expiry) {
+                wheel.schedule(expiry + intervals[index], index);
+            }));
+            ++tick;
+        }
+        state.SetItemsProcessed(expired);
+    }
+    BENCHMARK(BM_TimingWheel_wheel)->Arg(10000)->Arg(100000);
+}
@@ -0,0 +1,181 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Device.h"
+#include "Node.h"
+#include "Utils/StringUtils.h"
+
+#include <atomic>
+
+namespace Rovi {
+    namespace Homie {
+        // Device with 'nodes' nodes. The node count determines the length of $nodes.
+        static std::shared_ptr<Device> createDevice(const int64_t nodes) {
+            auto hwInfo = std::make_shared<HWInfo>("DE:AD:BE:EF:FE:ED", "192.168.0.10", "esp32");
+            auto device = std::make_shared<Device>("Super car", hwInfo, "weatherstation-firmware",
+                std::make_shared<Version>(1, 0, 0), std::chrono::seconds{60});
+            for(auto i = 0; i < nodes; ++i) {
+                device->addNode("Sensor " + StringUtils::toString(i), "temperature");
+            }
+            return device;
+        }
+
+        static void BM_Device_connectionInitialized(benchmark::State& state) {
+            auto device = createDevice(state.range(0));
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(device->connectionInitialized());
+            }
+        }
+        BENCHMARK(BM_Device_connectionInitialized)->Arg(0)->Arg(8)->Arg(64);
+
+        static void BM_Device_connectionInitialized_buffer(benchmark::State& state) {
+            auto device = createDevice(state.range(0));
+            auto buffer = AttributeBuffer{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                buffer.clear();
+                device->connectionInitialized(buffer);
+                benchmark::DoNotOptimize(buffer.bytes());
+            }
+        }
+        BENCHMARK(BM_Device_connectionInitialized_buffer)->Arg(0)->Arg(8)->Arg(64);
+
+        static void BM_Device_update(benchmark::State& state) {
+            auto device = createDevice(0);
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(device->update());
+            }
+        }
+        BENCHMARK(BM_Device_update);
+
+        static void BM_Device_update_buffer(benchmark::State& state) {
+            auto device = createDevice(0);
+            auto buffer = AttributeBuffer{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                buffer.clear();
+                device->update(buffer);
+                benchmark::DoNotOptimize(buffer.bytes());
+            }
+        }
+        BENCHMARK(BM_Device_update_buffer);
+
+        // Buffer allocated from a CycleArena, which is reset after every cycle. The initial block of 64 KiB covers
+        // a cycle, so nothing is allocated from the global heap.
+        static void BM_Device_connectionInitialized_arena(benchmark::State& state) {
+            auto device = createDevice(state.range(0));
+            auto arena = CycleArena{64 * 1024};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                {
+                    auto buffer = AttributeBuffer{arena.resource()};
+                    device->connectionInitialized(buffer);
+                    benchmark::DoNotOptimize(buffer.bytes());
+                }
+                arena.reset();
+            }
+        }
+        BENCHMARK(BM_Device_connectionInitialized_arena)->Arg(0)->Arg(8)->Arg(64);
+
+        static void BM_Device_update_arena(benchmark::State& state) {
+            auto device = createDevice(0);
+            auto arena = CycleArena{64 * 1024};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                {
+                    auto buffer = AttributeBuffer{arena.resource()};
+                    device->update(buffer);
+                    benchmark::DoNotOptimize(buffer.bytes());
+                }
+                arena.reset();
+            }
+        }
+        BENCHMARK(BM_Device_update_arena);
+
+        static void BM_Node_attribute(benchmark::State& state) {
+            auto device = createDevice(1);
+            auto node = device->node("sensor-0");
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(node->attribute(Node::Attributes::name));
+            }
+        }
+        BENCHMARK(BM_Node_attribute);
+
+        static void BM_Node_appendAttribute(benchmark::State& state) {
+            auto device = createDevice(1);
+            auto node = device->node("sensor-0");
+            auto buffer = AttributeBuffer{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                buffer.clear();
+                node->appendAttribute(buffer, Node::Attributes::name);
+                benchmark::DoNotOptimize(buffer.bytes());
+            }
+        }
+        BENCHMARK(BM_Node_appendAttribute);
+
+        // Reader scaling: Every benchmark thread reads the state and name of a device, thread 0 additionally changes
+        // the state every 1024 iterations. Snapshot: RCU (Device::snapshot()), no shared writes for readers.
+        static void BM_Device_snapshot(benchmark::State& state) {
+            static std::shared_ptr<Device> device;
+            if(state.thread_index() == 0) {
+                device = createDevice(8);
+            }
+            auto length = size_t{0};
+            auto iteration = uint32_t{0};
+            for(auto _ : state) {
+                if(state.thread_index() == 0 && ++iteration % 1024 == 0) {
+                    device->setState(iteration % 2048 == 0 ? Device::State::ready : Device::State::alert);
+                    device->publishSnapshot();
+                }
+                auto snapshot = device->snapshot();
+                length += snapshot->name.size() + static_cast<size_t>(snapshot->state);
+            }
+            benchmark::DoNotOptimize(length);
+            state.SetItemsProcessed(state.iterations());
+            if(state.thread_index() == 0) {
+                device.reset();
+            }
+        }
+        BENCHMARK(BM_Device_snapshot)->ThreadRange(1, 8)->UseRealTime();
+
+        // Reference: Snapshot held by a std::shared_ptr, read and replaced with std::atomic_load/atomic_store
+        // Every read increments and decrements the shared reference count.
+        static void BM_Device_sharedPtrSnapshot(benchmark::State& state) {
+            static std::shared_ptr<const Device::Snapshot> snapshot;
+            if(state.thread_index() == 0) {
+                auto device = createDevice(8);
+                snapshot = std::make_shared<const Device::Snapshot>(*device->snapshot());
+            }
+            auto length = size_t{0};
+            auto iteration = uint32_t{0};
+            for(auto _ : state) {
+                if(state.thread_index() == 0 && ++iteration % 1024 == 0) {
+                    auto next = std::make_shared<Device::Snapshot>(*std::atomic_load(&snapshot));
+                    next->state = iteration % 2048 == 0 ? Device::State::ready : Device::State::alert;
+                    std::atomic_store(&snapshot, std::shared_ptr<const Device::Snapshot>{std::move(next)});
+                }
+                auto current = std::atomic_load(&snapshot);
+                length += current->name.size() + static_cast<size_t>(current->state);
+            }
+            benchmark::DoNotOptimize(length);
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_Device_sharedPtrSnapshot)->ThreadRange(1, 8)->UseRealTime();
+
+        // Topic with 'levels' levels, e.g. homie/device/node/property/set for 5
+        static void BM_mqttPathToString(benchmark::State& state) {
+            auto topic = TopicType{"homie"};
+            for(auto i = 1; i < state.range(0); ++i) {
+                topic.append("level-" + StringUtils::toString(i));
+            }
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(mqttPathToString(topic));
+            }
+        }
+        BENCHMARK(BM_mqttPathToString)->Arg(3)->Arg(5)->Arg(16);
+    }
+}
@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Gateway.h"
+
+#include <cstdio>
+
+namespace Rovi {
+    namespace Homie {
+        // Attribute generation throughput vs. number of shards (worker threads, pinned per core)
+        // 100k devices, each iteration generates the stats of all devices (items = attributes).
+        // The shards only scale up to the number of cores of the machine.
+        static void BM_Gateway_updateAll(benchmark::State& state) {
+            auto options = Gateway::Options{};
+            options.shards = static_cast<size_t>(state.range(0));
+            auto gateway = Gateway{nullptr, options};
+            for(size_t i = 0; i < 100000; ++i) {
+                char mac[18];
+                snprintf(mac, sizeof(mac), "DE:AD:BE:%02X:%02X:%02X",
+                    static_cast<unsigned>((i >> 16) & 0xFF), static_cast<unsigned>((i >> 8) & 0xFF), static_cast<unsigned>(i & 0xFF));
+                auto hwInfo = std::make_shared<HWInfo>(mac, "192.168.0.10", "esp32");
+                // No statsInterval, only updated by updateAll()
+                gateway.addDevice(std::make_shared<Device>("Device", hwInfo, "firmware",
+                    std::make_shared<Version>(1, 0, 0), std::chrono::seconds{0}));
+            }
+            gateway.start();
+            gateway.flush();
+
+            auto attributes = int64_t{0};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                attributes += static_cast<int64_t>(gateway.updateAll());
+            }
+            state.SetItemsProcessed(attributes);
+            state.counters["cores"] = static_cast<double>(std::thread::hardware_concurrency());
+        }
+        BENCHMARK(BM_Gateway_updateAll)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+    }
+}
@@ -0,0 +1,217 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "PayloadDataTypes.h"
+
+namespace Rovi {
+    namespace Homie {
+        // Reference implementation: Integer/Float validation and conversion before the single pass scanners were introduced
+        static bool twoPhaseInteger(const std::string& value, int64_t& result) {
+            bool isValid = true;
+            isValid &= StringUtils::checkStringForAllowedCharacters(value, std::string("01234567890-"));
+            isValid &= !(value == "-");
+            isValid &= !(value == "");
+            isValid &= (value.find_last_of("-") == 0 || value.find_last_of("-") == std::string::npos);
+            if(isValid) {
+                result = atoll(value.c_str());
+            }
+            return isValid;
+        }
+
+        static bool twoPhaseFloat(const std::string& value, double& result) {
+            bool isValid = true;
+            isValid &= StringUtils::checkStringForAllowedCharacters(value, std::string("01234567890-eE."));
+            isValid &= std::count(value.begin(), value.end(), '.') <= 1;
+            isValid &= !(value == "-");
+            isValid &= !(value == "");
+            isValid &= !(value.find_last_of("E") == 0 || value.find_last_of("e") == 0 ||
+                        (value.find_last_of("-") ==  0 && (value.find_last_of("E") == 1 || value.find_last_of("e") == 1)));
+            if(isValid) {
+                result = atof(value.c_str());
+            }
+            return isValid;
+        }
+
+        static std::set<std::string> sceneNames() {
+            auto enumValues = std::set<std::string>{};
+            for(auto i = 0; i < 500; ++i) {
+                enumValues.insert("scene-" + StringUtils::toString(i));
+            }
+            return enumValues;
+        }
+
+        // Reference implementation: Enumeration before the flat lookup table was introduced
+        static void BM_Enumeration_set(benchmark::State& state) {
+            const auto enumValues = sceneNames();
+            const auto payload = std::string{"scene-321"};
+            auto value = std::string{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                auto isValid = payload.size() > 0 && enumValues.find(payload) != enumValues.end();
+                if(isValid) {
+                    value = payload;
+                }
+                benchmark::DoNotOptimize(isValid);
+                benchmark::DoNotOptimize(value);
+            }
+        }
+        BENCHMARK(BM_Enumeration_set);
+
+        static void BM_Enumeration_setValue(benchmark::State& state) {
+            auto value = Enumeration{sceneNames()};
+            const auto payload = std::string{"scene-321"};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.setValue(payload));
+            }
+        }
+        BENCHMARK(BM_Enumeration_setValue);
+
+        static void BM_Integer_twoPhase(benchmark::State& state) {
+            const auto payload = std::string{"-4611686018427387904"};
+            auto value = int64_t{0};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(twoPhaseInteger(payload, value));
+            }
+        }
+        BENCHMARK(BM_Integer_twoPhase);
+
+        static void BM_Integer_setValue(benchmark::State& state) {
+            const auto payload = std::string{"-4611686018427387904"};
+            auto value = Integer{0};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.setValue(payload));
+            }
+        }
+        BENCHMARK(BM_Integer_setValue);
+
+        static void BM_Integer_staticPayload(benchmark::State& state) {
+            const auto payload = std::string{"-4611686018427387904"};
+            auto value = StaticPayload<Format::Integer>{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.setPayload(payload));
+            }
+        }
+        BENCHMARK(BM_Integer_staticPayload);
+
+        static void BM_Float_twoPhase(benchmark::State& state) {
+            const auto payload = std::string{"-123.456e-3"};
+            auto value = 0.0;
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(twoPhaseFloat(payload, value));
+            }
+        }
+        BENCHMARK(BM_Float_twoPhase);
+
+        static void BM_Float_setValue(benchmark::State& state) {
+            const auto payload = std::string{"-123.456e-3"};
+            auto value = Float{0.0};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.setValue(payload));
+            }
+        }
+        BENCHMARK(BM_Float_setValue);
+
+        static void BM_Float_staticPayload(benchmark::State& state) {
+            const auto payload = std::string{"-123.456e-3"};
+            auto value = StaticPayload<Format::Float>{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.setPayload(payload));
+            }
+        }
+        BENCHMARK(BM_Float_staticPayload);
+
+        static void BM_Color_setValue(benchmark::State& state) {
+            const auto payload = std::string{"300,50,75"};
+            auto value = Color{ColorFormat::HSV};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.setValue(payload));
+            }
+        }
+        BENCHMARK(BM_Color_setValue);
+
+        static void BM_Color_toString(benchmark::State& state) {
+            auto value = Color{ColorFormat::RGB, "255,128,0"};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.toString());
+            }
+        }
+        BENCHMARK(BM_Color_toString);
+
+        // Parse and format paths of all datatypes. String payloads are parameterized by size.
+        static void BM_String_setValue(benchmark::State& state) {
+            const auto payload = std::string(static_cast<size_t>(state.range(0)), 'x');
+            auto value = String{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.setValue(payload));
+            }
+            state.SetBytesProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(BM_String_setValue)->RangeMultiplier(8)->Range(8, 32768);
+
+        static void BM_String_toString(benchmark::State& state) {
+            auto value = String{std::string(static_cast<size_t>(state.range(0)), 'x')};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.toString());
+            }
+            state.SetBytesProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(BM_String_toString)->RangeMultiplier(8)->Range(8, 32768);
+
+        static void BM_Integer_toString(benchmark::State& state) {
+            auto value = Integer{int64_t{-4611686018427387904}};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.toString());
+            }
+        }
+        BENCHMARK(BM_Integer_toString);
+
+        static void BM_Float_toString(benchmark::State& state) {
+            auto value = Float{-123.456e-3};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.toString());
+            }
+        }
+        BENCHMARK(BM_Float_toString);
+
+        static void BM_Boolean_setValue(benchmark::State& state) {
+            const auto payload = std::string{"false"};
+            auto value = Boolean{true};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.setValue(payload));
+            }
+        }
+        BENCHMARK(BM_Boolean_setValue);
+
+        static void BM_Boolean_toString(benchmark::State& state) {
+            auto value = Boolean{true};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.toString());
+            }
+        }
+        BENCHMARK(BM_Boolean_toString);
+
+        static void BM_Enumeration_toString(benchmark::State& state) {
+            auto value = Enumeration{sceneNames()};
+            value.setValue("scene-321");
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(value.toString());
+            }
+        }
+        BENCHMARK(BM_Enumeration_toString);
+    }
+}
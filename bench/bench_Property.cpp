@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "Property.h"
+#include "PayloadDataTypes.h"
+#include "Utils/StringUtils.h"
+
+#include <memory>
+
+namespace Rovi {
+    namespace Homie {
+        // Node with 'properties' float properties, e.g. the channels of a sensor array
+
+        // Reference: One heap allocated Float per property, formatted via PayloadDatatype::toString()
+        static void BM_Property_appendValues_objects(benchmark::State& state) {
+            auto nodeTopic = TopicType{"homie", "device", "sensors"};
+            auto topics = std::vector<TopicType>{};
+            auto values = std::vector<std::unique_ptr<Float>>{};
+            for(auto i = 0; i < state.range(0); ++i) {
+                topics.push_back(TopicType{"channel-" + StringUtils::toString(i)});
+                values.push_back(std::make_unique<Float>(20.0 + i * 0.25));
+            }
+            auto buffer = AttributeBuffer{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                buffer.clear();
+                for(size_t i = 0; i < values.size(); ++i) {
+                    buffer.append(nodeTopic, topics[i], values[i]->toString());
+                }
+                benchmark::DoNotOptimize(buffer.bytes());
+            }
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(BM_Property_appendValues_objects)->Arg(16)->Arg(256)->Arg(1024);
+
+        static void BM_Property_appendValues_table(benchmark::State& state) {
+            auto nodeTopic = TopicType{"homie", "device", "sensors"};
+            auto properties = PropertyTable{};
+            for(auto i = 0; i < state.range(0); ++i) {
+                auto property = properties.add({"Channel " + StringUtils::toString(i), Datatype::floating});
+                properties.setFloat(property, 20.0 + i * 0.25);
+            }
+            auto buffer = AttributeBuffer{};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                buffer.clear();
+                properties.appendValues(buffer, nodeTopic);
+                benchmark::DoNotOptimize(buffer.bytes());
+            }
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(BM_Property_appendValues_table)->Arg(16)->Arg(256)->Arg(1024);
+
+        // Inbound <property>/set payload
+        static void BM_Property_setPayload(benchmark::State& state) {
+            auto properties = PropertyTable{};
+            auto property = properties.add({"Target", Datatype::integer, "0:100", "%", true});
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(properties.setPayload(property, "42"));
+            }
+        }
+        BENCHMARK(BM_Property_setPayload);
+    }
+}
@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "TopicRouter.h"
+#include "Utils/StringUtils.h"
+
+#include <map>
+#include <random>
+
+namespace Rovi {
+    namespace Homie {
+        // 10k devices x 10 nodes x 10 properties = 1M settable properties
+        // Each iteration dispatches one of 4096 randomly chosen homie/<device>/<node>/<property>/set topics.
+        constexpr auto devices = 10000;
+        constexpr auto nodes = 10;
+        constexpr auto properties = 10;
+
+        static std::string deviceID(const int device) { return "device-" + StringUtils::toString(device); }
+        static std::string nodeID(const int node) { return "node-" + StringUtils::toString(node); }
+        static std::string propertyID(const int property) { return "property-" + StringUtils::toString(property); }
+
+        static const std::vector<std::string>& sampleTopics() {
+            static const auto topics = []() {
+                auto generator = std::mt19937{42};
+                auto topics = std::vector<std::string>{};
+                for(auto i = 0; i < 4096; ++i) {
+                    auto index = static_cast<int>(generator() % (devices * nodes * properties));
+                    topics.push_back("homie/" + deviceID(index / (nodes * properties)) + "/" + nodeID(index / properties % nodes)
+                        + "/" + propertyID(index % properties) + "/set");
+                }
+                return topics;
+            }();
+            return topics;
+        }
+
+        // Reference: Split the topic and look up device, node and property in nested std::maps (s. Device::node())
+        using PropertyMap = std::map<std::string, uint64_t>;
+        using NodeMap = std::map<std::string, PropertyMap>;
+
+        static const std::map<std::string, NodeMap>& deviceMaps() {
+            static const auto maps = []() {
+                auto maps = std::map<std::string, NodeMap>{};
+                for(auto device = 0; device < devices; ++device) {
+                    auto& nodeMap = maps[deviceID(device)];
+                    for(auto node = 0; node < nodes; ++node) {
+                        auto& propertyMap = nodeMap[nodeID(node)];
+                        for(auto property = 0; property < properties; ++property) {
+                            propertyMap[propertyID(property)] = static_cast<uint64_t>((device * nodes + node) * properties + property);
+                        }
+                    }
+                }
+                return maps;
+            }();
+            return maps;
+        }
+
+        static void BM_TopicRouter_splitAndMap(benchmark::State& state) {
+            auto& maps = deviceMaps();
+            auto& topics = sampleTopics();
+            auto sum = uint64_t{0};
+            auto index = size_t{0};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                auto levels = StringUtils::splitString(topics[index++ % topics.size()], '/');
+                if(levels.size() == 5 && levels[4] == "set") {
+                    auto device = maps.find(levels[1]);
+                    if(device != maps.end()) {
+                        auto node = device->second.find(levels[2]);
+                        if(node != device->second.end()) {
+                            auto property = node->second.find(levels[3]);
+                            if(property != node->second.end()) {
+                                sum += property->second;
+                            }
+                        }
+                    }
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+            state.SetItemsProcessed(state.iterations());
+        }
+        BENCHMARK(BM_TopicRouter_splitAndMap);
+
+        static const TopicRouter& router(uint64_t& sum) {
+            static const auto router = [&sum]() {
+                auto router = TopicRouter{};
+                // 10k devices + 100k nodes + 1M properties + 1M set levels
+                router.reserve(devices * (1 + nodes * (1 + properties * 2)) + 1);
+                for(auto device = 0; device < devices; ++device) {
+                    for(auto node = 0; node < nodes; ++node) {
+                        for(auto property = 0; property < properties; ++property) {
+                            auto value = static_cast<uint64_t>((device * nodes + node) * properties + property);
+                            router.add("homie/" + deviceID(device) + "/" + nodeID(node) + "/" + propertyID(property) + "/set",
+                                [&sum, value](std::string_view, std::string_view) { sum += value; });
+                        }
+                    }
+                }
+                return router;
+            }();
+            return router;
+        }
+
+        static void BM_TopicRouter_dispatch(benchmark::State& state) {
+            static auto sum = uint64_t{0};
+            auto& trie = router(sum);
+            auto& topics = sampleTopics();
+            auto index = size_t{0};
+            auto allocations = AllocationCounter{state};
+            for(auto _ : state) {
+                benchmark::DoNotOptimize(trie.dispatch(topics[index++ % topics.size()], "true"));
+            }
+            benchmark::DoNotOptimize(sum);
+            state.SetItemsProcessed(state.iterations());
+            state.counters["routes"] = static_cast<double>(trie.size());
+        }
+        BENCHMARK(BM_TopicRouter_dispatch);
+    }
+}
@@ -2,6 +2,7 @@
 
 #include <utility>
 #include <algorithm>
+#include <cmath>
 
 #include "Utils/StringUtils.h"
 
@@ -14,253 +15,433 @@ namespace Rovi {
             const std::chrono::seconds statsInterval)
               : m_hwInfo{hwInfo},
                 m_deviceID{std::make_shared<TopicID>(nameToTopic(deviceName) + "-" + macToTopic(hwInfo))}, 
+                m_baseTopic{std::string{"homie"}, m_deviceID->toString()},
                 m_homie{std::make_shared<Version>(3, 0, 1)}, m_name{deviceName}, 
                 m_state(State::init),
                 m_localip{hwInfo->ip()}, m_mac{hwInfo->mac()},
                 m_fw_name{std::make_shared<TopicID>(firmwareName)}, m_fw_version{firmwareVersion}, 
-                m_implementation{hwInfo->implementation()}, m_statsInterval{statsInterval}
+                m_nodes{}, m_nodeIndex{}, m_nodeIDs{}, m_nodesChanged{false}, m_removedTopics{},
+                m_implementation{hwInfo->implementation()}, m_statsInterval{statsInterval},
+                m_deltaPublication{false}, m_fullRefreshInterval{0}, m_updateCount{0}, m_publishedStats{},
+                m_snapshot{}, m_snapshotChanged{true}
             {
                 m_availableStats = hwInfo->supportedStats();
+                publishSnapshot();
             }
 
 
         std::vector<AttributeType> Device::connectionInitialized()  {
-            auto deviceAttributes = std::vector<AttributeType>{};
-            deviceAttributes.emplace_back(attribute(Attributes::homie));
-            deviceAttributes.emplace_back(attribute(Attributes::name));
-            deviceAttributes.emplace_back(attribute(Attributes::localip));
-            deviceAttributes.emplace_back(attribute(Attributes::mac));
-            deviceAttributes.emplace_back(attribute(Attributes::firmwareName));
-            deviceAttributes.emplace_back(attribute(Attributes::firmwareVersion));
-            deviceAttributes.emplace_back(attribute(Attributes::nodes));
-            deviceAttributes.emplace_back(attribute(Attributes::implementation));
-            deviceAttributes.emplace_back(attribute(Attributes::stats));
-            deviceAttributes.emplace_back(attribute(Attributes::statsInterval_s));
+            auto buffer = AttributeBuffer{};
+            connectionInitialized(buffer);
+            return buffer.toAttributes();
+        }
+
+        std::vector<AttributeType> Device::update() {
+            auto buffer = AttributeBuffer{};
+            update(buffer);
+            return buffer.toAttributes();
+        }
 
-            m_state = State::ready;
-            deviceAttributes.emplace_back(attribute(Attributes::state));      // TODO: Andere Fälle
 
-            return deviceAttributes;
+        void Device::connectionInitialized(AttributeBuffer& buffer) {
+            appendAttribute(buffer, Attributes::homie);
+            appendAttribute(buffer, Attributes::name);
+            appendAttribute(buffer, Attributes::localip);
+            appendAttribute(buffer, Attributes::mac);
+            appendAttribute(buffer, Attributes::firmwareName);
+            appendAttribute(buffer, Attributes::firmwareVersion);
+            appendAttribute(buffer, Attributes::nodes);
+            appendAttribute(buffer, Attributes::implementation);
+            appendAttribute(buffer, Attributes::stats);
+            appendAttribute(buffer, Attributes::statsInterval_s);
+            // Nodes and their properties have to be published before the device is ready
+            for(auto& node : m_nodes) {
+                node->connectionInitialized(buffer);
+            }
+
+            m_nodesChanged = false;
+
+            setState(State::ready);
+            appendAttribute(buffer, Attributes::state);      // TODO: Andere Fälle
+
+            // The broker might have lost the retained stats, so the next update() publishes all of them
+            for(auto& publishedStat : m_publishedStats) {
+                publishedStat.valid = false;
+            }
+            m_updateCount = 0;
+            publishSnapshot();
         }
 
-        std::vector<AttributeType> Device::update() const {
-            // TODO: Wo wird das Intervall gecheckt?        default = 60
+        void Device::update(AttributeBuffer& buffer) {
+            // The interval is handled by the caller, e.g. StatsScheduler
+            m_hwInfo->sample();
+            auto values = m_hwInfo->values();
+
+            auto fullRefresh = !m_deltaPublication || (m_fullRefreshInterval > 0 && m_updateCount % m_fullRefreshInterval == 0);
+            ++m_updateCount;
 
-            auto deviceStatistic = std::vector<AttributeType>{};
             for(auto& stat : m_availableStats) {
-                deviceStatistic.emplace_back(statictic(stat));
+                auto raw = rawValue(stat, values);
+                auto& publishedStat = m_publishedStats[static_cast<size_t>(stat)];
+                if(!fullRefresh && publishedStat.valid && std::abs(raw - publishedStat.value) <= publishedStat.deadband) {
+                    continue;
+                }
+                publishedStat.value = raw;
+                publishedStat.valid = true;
+                buffer.appendPayload(m_baseTopic, statsTopic(stat), [this, stat, raw](auto& data) {
+                    writeStatValue(stat, raw, data);
+                });
+            }
+
+            // Before, connectionInitialized() publishes everything
+            if(m_state != State::ready) {
+                publishSnapshot();
+                return;
+            }
+            if(m_nodesChanged) {
+                appendAttribute(buffer, Attributes::nodes);
+                m_nodesChanged = false;
+            }
+            // An empty retained message deletes the retained message of the topic
+            for(auto& topic : m_removedTopics) {
+                buffer.appendPath(topic, "");
             }
-          
-            return deviceStatistic;
+            m_removedTopics.clear();
+            for(auto& node : m_nodes) {
+                node->update(buffer);
+            }
+            publishSnapshot();
         }
 
 
-        void Device::addNode(const std::shared_ptr<Node>& node) {
-            std::cout << "Adding node " << node->value(Node::Attributes::name) << " to device " << m_name << std::endl;
+        void Device::setDeltaPublication(const bool enabled, const uint32_t fullRefreshInterval) {
+            m_deltaPublication = enabled;
+            m_fullRefreshInterval = fullRefreshInterval;
+            m_updateCount = 0;
+        }
+
 
-            // TODO: Check, if node is already connected/ID existing
-            m_nodes[node->value(Node::Attributes::nodeID)] = node;
-            // TODO: shared_from_this only works, if there is already a shared_ptr owning this otherwise it crashes
-            //       Find a solution if this is not the case, e.g. https://mortoray.com/2013/08/02/safely-using-enable_shared_from_this/
-            node->setDevice(shared_from_this());
+        void Device::setDeadband(const Stats& stat, const double deadband) {
+            m_publishedStats[static_cast<size_t>(stat)].deadband = deadband;
         }
 
 
-        std::shared_ptr<Node> Device::node(const std::string& nodeID) const {
-            std::shared_ptr<Node> node;
-            auto it = m_nodes.find(nodeID);
-            if(it != m_nodes.end()) {
-                node = it->second; 
+        bool Device::messageReceived(std::string_view topic, std::string_view payload) const {
+            auto& base = m_baseTopic.path();
+            if(!m_messageHandler || topic.size() <= base.size() + 1 || topic.compare(0, base.size(), base) != 0
+                || topic[base.size()] != '/') {
+                return false;
             }
-            return node;
+            m_messageHandler(topic.substr(base.size() + 1), payload);
+            return true;
         }
 
 
-        AttributeType Device::attribute(const Attributes& attribute) const {
-            return deviceAttribute(topic(attribute), value(attribute));
+        Node* Device::addNode(const std::string& name, const std::string type, const size_t arraySize) {
+            auto node = std::make_unique<Node>(name, type, arraySize);
+            auto nodeID = node->id();
+            if(m_nodeIndex.contains(nodeID)) {
+                std::cerr << "Node " << nodeID << " already exists in device " << m_name << std::endl;
+                return nullptr;
+            }
+            std::cout << "Adding node " << name << " to device " << m_name << std::endl;
+
+            node->setDevice(*this);
+            if(!m_nodeIDs.empty()) {
+                m_nodeIDs += ',';
+            }
+            m_nodeIDs += nodeID;
+            if(node->isArray()) {
+                m_nodeIDs += "[]";
+            }
+            m_nodesChanged = true;
+            m_nodeIndex.insert(std::move(nodeID), node.get());
+            m_nodes.push_back(std::move(node));
+            m_snapshotChanged = true;
+            return m_nodes.back().get();
         }
 
 
-        TopicType Device::topic(const Attributes& attribute) const {
-            auto ret = TopicType{};
-            switch (attribute)
-            {
-                case Attributes::deviceID:
-                    ret.emplace_back("");       // TODO
-                    break;                    
-                case Attributes::homie:
-                    ret.emplace_back("$homie");
-                    break;                    
-                case Attributes::name:
-                    ret.emplace_back("$name");
-                    break;                    
-                case Attributes::state:
-                    ret.emplace_back("$state");
-                    break;                    
-                case Attributes::localip:
-                    ret.emplace_back("$localip");
-                    break;                    
-                case Attributes::mac:
-                    ret.emplace_back("$mac");
-                    break;                    
-                case Attributes::firmwareName:
-                    ret.emplace_back("$fw");
-                    ret.emplace_back("name");
-                    break;                    
-                case Attributes::firmwareVersion:
-                    ret.emplace_back("$fw");
-                    ret.emplace_back("version");
-                    break;                    
-                case Attributes::nodes:
-                    ret.emplace_back("$nodes");
-                    break;                    
-                case Attributes::implementation:
-                    ret.emplace_back("$implementation");
-                    break;                    
-                case Attributes::stats:
-                    ret.emplace_back("$stats");
-                    break;                    
-                case Attributes::statsInterval_s:
-                    ret.emplace_back("$stats");
-                    ret.emplace_back("interval");
-                    break;                    
-                default:
+        Node* Device::addNode(const std::string& name, const std::string type) {
+            return addNode(name, type, 1);
+        }
+
+
+        bool Device::removeNode(std::string_view nodeID) {
+            auto node = m_nodeIndex.find(nodeID);
+            if(node == nullptr) {
+                return false;
+            }
+            // Erase the entry "<node-id>" or "<node-id>[]" and one separator from $nodes
+            auto begin = size_t{0};
+            for(auto entry : StringUtils::tokenize(m_nodeIDs, ',')) {
+                if(entry.substr(0, entry.find('[')) == nodeID) {
+                    auto end = begin + entry.size();
+                    if(end < m_nodeIDs.size()) {
+                        ++end;
+                    } else if(begin > 0) {
+                        --begin;
+                    }
+                    m_nodeIDs.erase(begin, end - begin);
                     break;
+                }
+                begin += entry.size() + 1;
+            }
+            m_nodesChanged = true;
+
+            auto removed = *node;
+            if(removed->published()) {
+                // Everything the node has published, except the values of non-retained properties
+                auto published = AttributeBuffer{};
+                removed->connectionInitialized(published);
+                for(size_t i = 0; i < published.size(); ++i) {
+                    if(published.retained(i)) {
+                        m_removedTopics.emplace_back(published.topic(i));
+                    }
+                }
+            }
+            m_nodeIndex.erase(nodeID);
+            m_nodes.erase(std::find_if(m_nodes.begin(), m_nodes.end(),
+                [removed](const std::unique_ptr<Node>& candidate) { return candidate.get() == removed; }));
+            m_snapshotChanged = true;
+            return true;
+        }
+
+
+        void Device::setState(const State& state) {
+            if(state != m_state) {
+                m_state = state;
+                m_snapshotChanged = true;
+            }
+        }
+
+
+        void Device::publishSnapshot() {
+            if(!m_snapshotChanged) {
+                return;
             }
+            m_snapshotChanged = false;
+            auto snapshot = std::make_unique<Snapshot>();
+            snapshot->deviceID = m_deviceID->toString();
+            snapshot->name = m_name;
+            snapshot->state = m_state;
+            snapshot->localip = m_localip;
+            snapshot->mac = m_mac;
+            snapshot->firmwareName = m_fw_name->toString();
+            snapshot->firmwareVersion = m_fw_version->toString();
+            snapshot->implementation = m_implementation;
+            snapshot->statsInterval = m_statsInterval;
+            snapshot->nodeIDs = m_nodeIDs;
+            snapshot->nodes.reserve(m_nodes.size());
+            for(auto& node : m_nodes) {
+                snapshot->nodes.push_back(Snapshot::NodeSnapshot{node->id(),
+                    node->value(Node::Attributes::name), node->value(Node::Attributes::type), node->arraySize(),
+                    node->value(Node::Attributes::properties)});
+            }
+            m_snapshot.publish(std::move(snapshot));
+        }
+
+
+        Node* Device::node(std::string_view nodeID) const {
+            auto node = m_nodeIndex.find(nodeID);
+            return node != nullptr ? *node : nullptr;
+        }
+
 
-            return ret;
+        AttributeType Device::attribute(const Attributes& attribute) const {
+            return deviceAttribute(topic(attribute), value(attribute));
+        }
+
+
+        void Device::appendAttribute(AttributeBuffer& buffer, const Attributes& attribute) const {
+            buffer.appendPayload(m_baseTopic, topic(attribute), [this, &attribute](auto& data) {
+                writeValue(attribute, data);
+            });
+        }
+
+
+        const TopicType& Device::topic(const Attributes& attribute) const {
+            // Indexed by Attributes, built once instead of for every published attribute
+            static const auto topics = std::array<TopicType, 12>{
+                TopicType{""},          // TODO: deviceID
+                TopicType{"$homie"},
+                TopicType{"$name"},
+                TopicType{"$state"},
+                TopicType{"$localip"},
+                TopicType{"$mac"},
+                TopicType{"$fw", "name"},
+                TopicType{"$fw", "version"},
+                TopicType{"$nodes"},
+                TopicType{"$implementation"},
+                TopicType{"$stats"},
+                TopicType{"$stats", "interval"}
+            };
+            return topics[static_cast<size_t>(attribute)];
         }
 
 
         ValueType Device::value(const Attributes& attribute) const {
             auto str = ValueType{};
+            writeValue(attribute, str);
+            return str;
+        }
+
+
+        template<typename String>
+        void Device::writeValue(const Attributes& attribute, String& str) const {
             switch (attribute)
             {
                 case Attributes::deviceID:
-                    str = m_deviceID->toString();
+                    str += m_deviceID->toString();
                     break;                    
                 case Attributes::homie:
-                    str = m_homie->toString();
+                    str += m_homie->toString();
                     break;                    
                 case Attributes::name:
-                    str = m_name;
+                    str += m_name;
                     break;                    
                 case Attributes::state:
-                    str = stateToValue(m_state);
+                    str += stateToValue(m_state);
                     break;                    
                 case Attributes::localip:
-                    str = m_localip;
+                    str += m_localip;
                     break;                    
                 case Attributes::mac:
-                    str = m_mac;
+                    str += m_mac;
                     break;                    
                 case Attributes::firmwareName:
-                    str = m_fw_name->toString();
+                    str += m_fw_name->toString();
                     break;                    
                 case Attributes::firmwareVersion:
-                    str = m_fw_version->toString();
+                    str += m_fw_version->toString();
                     break;                    
                 case Attributes::nodes:
-                    for(auto& node : m_nodes) {
-                        str += node.first;
-                        if(node.second->isArray()) {
-                            str += "[]";
-                        }
-                        str += ",";
-                    }
-                    if(!str.empty()) {
-                        str.pop_back();     // Remove tailing ','
-                    }
-                    // str = "Not implemented yet!";
-                    break;                    
+                    str += m_nodeIDs;
+                    break;
                 case Attributes::implementation:
-                    str = m_implementation;
-                    break;                    
-                case Attributes::stats:
-                    str = availableStatsToValue(m_availableStats);
+                    str += m_implementation;
                     break;                    
+                case Attributes::stats: {
+                    auto separator = false;
+                    for(auto& stat : m_availableStats) {
+                        if(separator) {
+                            str += ',';
+                        }
+                        str += topic(stat).path();
+                        separator = true;
+                    }
+                    break;
+                }
                 case Attributes::statsInterval_s:
-                    str = StringUtils::toString(m_statsInterval.count());
+                    StringUtils::appendNumber(str, m_statsInterval.count());
                     break;
                 default:
                     break;
             }
-
-            return str;
         }
 
         AttributeType Device::statictic(const Stats& stat) const {
-            auto statsBaseTopic = topic(Attributes::stats);
-            auto statsSubtopic = topic(stat);
-            statsBaseTopic.splice(statsBaseTopic.end(), statsSubtopic);
-            return deviceAttribute(statsBaseTopic, value(stat));
+            return deviceAttribute(statsTopic(stat), value(stat));
         }
 
-        TopicType Device::topic(const Stats& stat) const {
-           auto ret = TopicType{};
-            switch (stat)
-            {
-                case Stats::uptime:
-                    ret.emplace_back("uptime");
-                    break;                    
-                case Stats::signal:
-                    ret.emplace_back("signal");
-                    break;                    
-                case Stats::cputemp:
-                    ret.emplace_back("cputemp");
-                    break;                    
-                case Stats::cpuload:
-                    ret.emplace_back("cpuload");
-                    break;                    
-                case Stats::battery:
-                    ret.emplace_back("battery");
-                    break;                    
-                case Stats::freeheap:
-                    ret.emplace_back("freeheap");
-                    break;                    
-                case Stats::supply:
-                    ret.emplace_back("supply");
-                    break;                               
-                default:
-                    break;
-            }
+        void Device::appendStatistic(AttributeBuffer& buffer, const Stats& stat) const {
+            auto raw = rawValue(stat);
+            buffer.appendPayload(m_baseTopic, statsTopic(stat), [this, stat, raw](auto& data) {
+                writeStatValue(stat, raw, data);
+            });
+        }
+
+        const TopicType& Device::topic(const Stats& stat) const {
+            // Indexed by Stats
+            static const auto topics = std::array<TopicType, statsCount>{
+                TopicType{"uptime"},
+                TopicType{"signal"},
+                TopicType{"cputemp"},
+                TopicType{"cpuload"},
+                TopicType{"battery"},
+                TopicType{"freeheap"},
+                TopicType{"supply"}
+            };
+            return topics[static_cast<size_t>(stat)];
+        }
 
-            return ret;
+
+        const TopicType& Device::statsTopic(const Stats& stat) {
+            // Indexed by Stats
+            static const auto topics = std::array<TopicType, statsCount>{
+                TopicType{"$stats", "uptime"},
+                TopicType{"$stats", "signal"},
+                TopicType{"$stats", "cputemp"},
+                TopicType{"$stats", "cpuload"},
+                TopicType{"$stats", "battery"},
+                TopicType{"$stats", "freeheap"},
+                TopicType{"$stats", "supply"}
+            };
+            return topics[static_cast<size_t>(stat)];
         }
 
+
         ValueType Device::value(const Stats& stat) const {
-            auto str = ValueType{};
+            return statToValue(stat, rawValue(stat));
+        }
+
+
+        double Device::rawValue(const Stats& stat) const {
+            return rawValue(stat, m_hwInfo->values());
+        }
+
+
+        double Device::rawValue(const Stats& stat, const HWInfo::Values& values) const {
+            auto value = 0.0;
             switch (stat)
             {
                 case Stats::uptime:
-                    str = StringUtils::toString(m_hwInfo->uptime().count());
+                    value = static_cast<double>(values.uptime.count());
                     break;
                 case Stats::signal:
-                    str = StringUtils::toString(m_hwInfo->signalStrength());
+                    value = values.signalStrength;
                     break;
                 case Stats::cputemp:
-                    str = StringUtils::toString(m_hwInfo->cpuTemperature());
+                    value = values.cpuTemperature;
                     break;
                 case Stats::cpuload:
-                    str = StringUtils::toString(m_hwInfo->cpuLoad());
+                    value = values.cpuLoad;
                     break;
                 case Stats::battery:
-                    str = StringUtils::toString(m_hwInfo->batteryLevel());
+                    value = values.batteryLevel;
                     break;
                 case Stats::freeheap:
-                    str = StringUtils::toString(m_hwInfo->freeheap());
+                    value = values.freeheap;
                     break;
                 case Stats::supply:
-                    str = StringUtils::toString(m_hwInfo->supplyVoltage());
+                    value = values.supplyVoltage;
                     break;
                 default:
                     break;
-            }                  
+            }
+
+            return value;
+        }
 
+
+        ValueType Device::statToValue(const Stats& stat, const double rawValue) const {
+            auto str = ValueType{};
+            writeStatValue(stat, rawValue, str);
             return str;
         }
 
 
+        template<typename String>
+        void Device::writeStatValue(const Stats& stat, const double rawValue, String& str) const {
+            // All stats except the supply voltage are integers (s. HWInfo)
+            if(stat == Stats::supply) {
+                StringUtils::appendNumber(str, static_cast<float>(rawValue));
+            } else {
+                StringUtils::appendNumber(str, static_cast<int64_t>(rawValue));
+            }
+        }
+
+
         std::string Device::nameToTopic(const std::string& topic) const {
             auto convertedTopic = StringUtils::toLower(topic);
             std::replace( convertedTopic.begin(), convertedTopic.end(), ' ', '-');
@@ -308,40 +489,18 @@ namespace Rovi {
 
 
         AttributeType Device::deviceAttribute(const TopicType& topic, const ValueType& value) const {
-            auto deviceTopicPath = TopicType{std::string{"homie"}, m_deviceID->toString()};
-            deviceTopicPath.insert(deviceTopicPath.end(), topic.begin(), topic.end());
-            return make_pair(deviceTopicPath, value);
+            return make_pair(TopicType{m_baseTopic, topic}, value);
         }
 
 
-        std::string Device::availableStatsToValue(const std::list<Stats>& stats) const {
-            auto str = std::string{};
-            for(auto& stat : stats) {
-                auto statTopic = topic(stat);
-                if(statTopic.size() != 1) {
-                    std::cout << "WARNING: statTopic.size() != 1" << std::endl;
-                }
-                str += statTopic.front() + ",";
-            }
-            str.pop_back();        // Remove last ","
-
-            return str;
-        }
-
 
 
 
         //*******************************************************************//
         // TBD
         //*******************************************************************//
-        std::string mqttPathToString(const TopicType mqttPath) {
-            const auto seperator = std::string{"/"};
-            auto path = std::string{};
-            for(auto& mqttDir : mqttPath) {
-                path += mqttDir + seperator;
-            }
-
-            return path;
+        std::string mqttPathToString(const TopicType& mqttPath) {
+            return mqttPath.toString();
         }
 
 
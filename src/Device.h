@@ -6,10 +6,15 @@
 #include <list>
 #include <chrono>
 #include <memory>
-#include <map>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <string_view>
 
 #include "HomieHelper.h"
 #include "Node.h"
+#include "Utils/FlatHashMap.h"
+#include "Utils/Rcu.h"
 
 namespace Rovi {
     namespace  Homie {
@@ -20,7 +25,9 @@ namespace Rovi {
         class HWInfo;
         class Node;
 
-        class Device : public std::enable_shared_from_this<Device> {
+        // The device owns its nodes, nodes only refer back to it (s. Node::device()). Neither has to be owned by a
+        // std::shared_ptr and destroying the device destroys its nodes.
+        class Device {
             public:
                 enum class Attributes {
                     deviceID,
@@ -37,7 +44,6 @@ namespace Rovi {
                     statsInterval_s
                 };
 
-                // TODO: Implement state changes (requires MQTT...)
                 enum class State {
                     init,
                     ready,
@@ -47,37 +53,111 @@ namespace Rovi {
                     alert
                 };
 
+                // Immutable copy of the metadata of a device and its nodes (s. snapshot())
+                struct Snapshot {
+                    struct NodeSnapshot {
+                        std::string id;
+                        std::string name;
+                        std::string type;
+                        size_t arraySize;
+                        std::string properties;         // $properties
+                    };
+
+                    std::string deviceID;
+                    std::string name;
+                    State state;
+                    std::string localip;
+                    std::string mac;
+                    std::string firmwareName;
+                    std::string firmwareVersion;
+                    std::string implementation;
+                    std::chrono::seconds statsInterval;
+                    std::string nodeIDs;                // $nodes
+                    std::vector<NodeSnapshot> nodes;
+                };
+                using SnapshotGuard = RcuValue<Snapshot>::ReadGuard;
+
                 Device(const std::string deviceName, const std::shared_ptr<HWInfo>& hwInfo, 
                     const std::string& firmwareName, const std::shared_ptr<Version>& firmwareVersion,
                     const std::chrono::seconds statsInterval_s);
 
                 // TBD: Visibility 
                 std::vector<AttributeType> connectionInitialized();
-                std::vector<AttributeType> update() const;
-
-                void addNode(const std::shared_ptr<Node>& node);
-                std::shared_ptr<Node> node(const std::string& nodeID) const;
+                std::vector<AttributeType> update();
+                // Append the attributes to a (reusable) buffer instead of creating new (topic, value) pairs
+                void connectionInitialized(AttributeBuffer& buffer);
+                // Stats and, once the device is ready, the changes of the nodes since the last call: $nodes if nodes
+                // have been added or removed, the attributes of new nodes and the changed property values.
+                void update(AttributeBuffer& buffer);
+
+                // Delta publication: update() only emits stats that changed since they were last published.
+                // Every 'fullRefreshInterval' calls of update() all stats are published (0 = never).
+                // Disabled by default, i.e. every update() publishes all stats.
+                void setDeltaPublication(const bool enabled, const uint32_t fullRefreshInterval = 0);
+                // Changes up to 'deadband' (absolute, in the unit of the stat) are not published, e.g. for cpuload or supply
+                void setDeadband(const Stats& stat, const double deadband);
+
+                // Called by the transport, e.g. Mqtt::MqttClient
+                void setState(const State& state);
+                // Inbound message for this device. 'topic' is the complete topic, the handler receives the
+                // topic relative to the base topic (e.g. <node-id>/<property>/set).
+                // Returns false if the topic does not belong to this device or no handler is set.
+                using MessageHandler = std::function<void(std::string_view topic, std::string_view payload)>;
+                void setMessageHandler(MessageHandler handler) { m_messageHandler = std::move(handler); }
+                bool messageReceived(std::string_view topic, std::string_view payload) const;
+
+                // Creates a node owned by this device. The node stays at its address as long as the device exists.
+                // Returns nullptr, if a node with the same ID exists already.
+                Node* addNode(const std::string& name, const std::string type, const size_t arraySize);
+                Node* addNode(const std::string& name, const std::string type);
+                // Destroys the node, pointers to it become invalid. Returns false, if the node does not exist.
+                // The next update() deletes the retained topics of the node on the broker.
+                bool removeNode(std::string_view nodeID);
+                // nullptr, if the node does not exist. Accepts a level of an inbound topic without copying it.
+                Node* node(std::string_view nodeID) const;
+
+                // Consistent view of the metadata for other threads (status page, metrics, ...), read without any
+                // lock or reference count (s. RcuValue). The snapshot stays valid as long as the guard lives.
+                // Changes (addNode(), removeNode(), setState(), Node::addProperty(), ...) only mark the snapshot as
+                // outdated. It is copied once per connectionInitialized() or update() call, or by publishSnapshot().
+                SnapshotGuard snapshot() const { return m_snapshot.read(); }
+                // Replaces the snapshot, if the metadata changed since the last publication
+                void publishSnapshot();
+                // Called after the metadata changed, e.g. by Node::addProperty()
+                void snapshotChanged() { m_snapshotChanged = true; }
 
                 AttributeType attribute(const Attributes& attribute) const;
-                TopicType topic(const Attributes& attribute) const;
+                // Relative to the base topic, e.g. $fw/name
+                const TopicType& topic(const Attributes& attribute) const;
                 ValueType value(const Attributes& attribute) const;
 
+                void appendAttribute(AttributeBuffer& buffer, const Attributes& attribute) const;
+
                 AttributeType statictic(const Stats& stat) const;
-                TopicType topic(const Stats& stat) const;
+                void appendStatistic(AttributeBuffer& buffer, const Stats& stat) const;
+                // Relative to $stats, e.g. uptime
+                const TopicType& topic(const Stats& stat) const;
                 ValueType value(const Stats& stat) const;
+                // Unformatted value as reported by HWInfo
+                double rawValue(const Stats& stat) const;
 
 
                 // TBD: Required?
                 std::shared_ptr<TopicID> deviceID() const { return m_deviceID; };
+                // homie/<device-id>
+                const TopicType& baseTopic() const { return m_baseTopic; };
                 std::shared_ptr<Version> homie() const { return m_homie; };
-                std::string name() const { return m_name; };
-                State state() const { return m_state; };
-                std::string localip() const { return m_localip; };
-                std::string mac() const { return m_mac; };
+                // name, localip, mac and implementation do not change after the construction
+                const std::string& name() const { return m_name; };
+                // Safe to call from any thread, also before the changed state is published in the snapshot
+                State state() const { return m_state.load(); };
+                const std::string& localip() const { return m_localip; };
+                const std::string& mac() const { return m_mac; };
                 std::shared_ptr<TopicID> firmwareName() const { return m_fw_name; };
                 std::shared_ptr<Version> firmwareVersion() const { return m_fw_version; };
-                //TODO: nodes
-                std::string implementation() const { return m_implementation; };
+                // $nodes, e.g. "engine,wheels[]"
+                const std::string& nodes() const { return m_nodeIDs; };
+                const std::string& implementation() const { return m_implementation; };
                 std::chrono::seconds statsInterval_s() const { return m_statsInterval; };
 
             protected:
@@ -85,27 +165,61 @@ namespace Rovi {
                 std::string macToTopic(const std::shared_ptr<HWInfo>& hwInfo) const;
                 std::string stateToValue(const State& state) const;
                 AttributeType deviceAttribute(const TopicType& topic, const ValueType& value) const;
-                std::string availableStatsToValue(const std::list<Stats>& stats) const;
+                ValueType statToValue(const Stats& stat, const double rawValue) const;
+                double rawValue(const Stats& stat, const HWInfo::Values& values) const;
+                // $stats/<stat>
+                static const TopicType& statsTopic(const Stats& stat);
+                // Append the value to 'str' (std::string or std::pmr::string), so that the attributes can be written
+                // directly into an AttributeBuffer
+                template<typename String>
+                void writeValue(const Attributes& attribute, String& str) const;
+                template<typename String>
+                void writeStatValue(const Stats& stat, const double rawValue, String& str) const;
 
                 std::shared_ptr<HWInfo> m_hwInfo;
                 std::shared_ptr<TopicID> m_deviceID;
+                TopicType m_baseTopic;
                 // $device-attribute
                 std::shared_ptr<Version> m_homie;
                 std::string m_name;
-                State m_state;
+                // Written by the owning thread only, atomic for state()
+                std::atomic<State> m_state;
                 std::string m_localip;
                 std::string m_mac;
                 std::shared_ptr<TopicID> m_fw_name;
                 std::shared_ptr<Version> m_fw_version;
-                std::map<std::string, std::shared_ptr<Node>> m_nodes;
+                // Nodes in the order they were added (also the order of $nodes), m_nodeIndex maps the node IDs to them
+                std::vector<std::unique_ptr<Node>> m_nodes;
+                FlatHashMap<Node*> m_nodeIndex;
+                // $nodes, updated by addNode() and removeNode(). m_nodesChanged: Not published since the last change.
+                std::string m_nodeIDs;
+                bool m_nodesChanged;
+                // Retained topics of removed nodes, update() clears them with empty payloads
+                std::vector<std::string> m_removedTopics;
                 std::string m_implementation;
                 std::chrono::seconds m_statsInterval;
 
                 std::list<Stats> m_availableStats;
+                MessageHandler m_messageHandler;
+
+                // Delta publication
+                struct PublishedStat {
+                    double value = 0.0;
+                    double deadband = 0.0;
+                    bool valid = false;
+                };
+                static constexpr size_t statsCount = static_cast<size_t>(Stats::supply) + 1;
+                bool m_deltaPublication;
+                uint32_t m_fullRefreshInterval;
+                uint32_t m_updateCount;
+                std::array<PublishedStat, statsCount> m_publishedStats;
+
+                RcuValue<Snapshot> m_snapshot;
+                bool m_snapshotChanged;
         };
 
         // TODO: Move somewhere else
-        extern std::string mqttPathToString(const TopicType mqttPath);
+        extern std::string mqttPathToString(const TopicType& mqttPath);
         extern void printMqttMessages(const std::vector<AttributeType>& attributes);
     }
 }
@@ -0,0 +1,292 @@
+#include "Gateway.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Rovi {
+    namespace Homie {
+        //*******************************************************************//
+        // Gateway
+        //*******************************************************************//
+        Gateway::Gateway(PublishFunction publish)
+            : Gateway{std::move(publish), Options{}}
+        {}
+
+
+        Gateway::Gateway(PublishFunction publish, const Options& options)
+            : m_publish{std::move(publish)}, m_options{options}, m_shards{}, m_running{false}
+        {
+            auto count = m_options.shards > 0 ? m_options.shards : std::max(1u, std::thread::hardware_concurrency());
+            for(size_t i = 0; i < count; ++i) {
+                m_shards.push_back(std::make_unique<Shard>(*this, i));
+            }
+        }
+
+
+        Gateway::~Gateway() {
+            stop();
+        }
+
+
+        void Gateway::start() {
+            if(m_running) {
+                return;
+            }
+            m_running = true;
+            for(auto& shard : m_shards) {
+                shard->start(m_options.pinThreads);
+            }
+        }
+
+
+        void Gateway::stop() {
+            if(!m_running) {
+                return;
+            }
+            for(auto& shard : m_shards) {
+                shard->stop();
+            }
+            m_running = false;
+        }
+
+
+        size_t Gateway::shardOf(std::string_view deviceID) const {
+            // FNV-1a as in the StatsScheduler, followed by the MurmurHash3 finalizer: The upper bits of FNV-1a hardly depend
+            // on the last characters, and the scheduler derives the phase of a device from the same hash. Without mixing,
+            // all devices of a shard would share the same phases.
+            auto hash = uint64_t{14695981039346656037ull};
+            for(auto c : deviceID) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ull;
+            hash ^= hash >> 33;
+            return static_cast<size_t>(hash % m_shards.size());
+        }
+
+
+        size_t Gateway::deviceCount() const {
+            auto count = size_t{0};
+            for(auto& shard : m_shards) {
+                count += shard->deviceCount();
+            }
+            return count;
+        }
+
+
+        void Gateway::addDevice(std::shared_ptr<Device> device) {
+            auto& shard = *m_shards[shardOf(device->deviceID()->id())];
+            shard.post([&shard, device = std::move(device)]() { shard.addDevice(device); });
+        }
+
+
+        void Gateway::removeDevice(std::string_view deviceID) {
+            auto& shard = *m_shards[shardOf(deviceID)];
+            shard.post([&shard, id = std::string{deviceID}]() { shard.removeDevice(id); });
+        }
+
+
+        void Gateway::post(std::string_view deviceID, DeviceTask task) {
+            auto& shard = *m_shards[shardOf(deviceID)];
+            shard.post([&shard, id = std::string{deviceID}, task = std::move(task)]() {
+                auto device = shard.device(id);
+                if(device != nullptr) {
+                    task(*device);
+                }
+            });
+        }
+
+
+        void Gateway::messageReceived(std::string_view topic, std::string_view payload) {
+            // homie/<device-id>/...
+            auto begin = topic.find('/');
+            if(begin == std::string_view::npos) {
+                return;
+            }
+            auto end = topic.find('/', begin + 1);
+            auto deviceID = topic.substr(begin + 1, end == std::string_view::npos ? end : end - begin - 1);
+            // The views are only valid during this call
+            post(deviceID, [topic = std::string{topic}, payload = std::string{payload}](Device& device) {
+                device.messageReceived(topic, payload);
+            });
+        }
+
+
+        size_t Gateway::updateAll() {
+            auto attributes = std::atomic<size_t>{0};
+            runOnAllShards([&attributes](Shard& shard) {
+                attributes.fetch_add(shard.updateAll(), std::memory_order_relaxed);
+            });
+            return attributes.load();
+        }
+
+
+        void Gateway::flush() {
+            runOnAllShards([](Shard&) {});
+        }
+
+
+        bool Gateway::runOnAllShards(const std::function<void(Shard& shard)>& task) {
+            if(!m_running) {
+                return false;
+            }
+            for(auto& shard : m_shards) {
+                if(shard->isWorkerThread()) {
+                    std::cerr << "Waiting for all shards on the worker thread of a shard would deadlock" << std::endl;
+                    return false;
+                }
+            }
+            auto mutex = std::mutex{};
+            auto done = std::condition_variable{};
+            auto pending = m_shards.size();
+            for(auto& shard : m_shards) {
+                auto& current = *shard;
+                current.post([&, shard = &current]() {
+                    task(*shard);
+                    auto lock = std::lock_guard<std::mutex>{mutex};
+                    if(--pending == 0) {
+                        done.notify_one();
+                    }
+                });
+            }
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            done.wait(lock, [&pending]() { return pending == 0; });
+            return true;
+        }
+
+
+        //*******************************************************************//
+        // Shard
+        //*******************************************************************//
+        Gateway::Shard::Shard(Gateway& gateway, const size_t index)
+            : m_gateway{gateway}, m_index{index}, m_thread{}, m_mutex{}, m_wakeup{}, m_mailbox{}, m_stopping{false},
+              m_devices{},
+              m_scheduler{[this](Device& device, AttributeBuffer& buffer) {
+                      if(m_gateway.m_publish) {
+                          m_gateway.m_publish(m_index, device, buffer);
+                      }
+                  }, gateway.m_options.resolution},
+              m_buffer{}, m_deviceCount{0}
+        {}
+
+
+        void Gateway::Shard::start(const bool pin) {
+            {
+                auto lock = std::lock_guard<std::mutex>{m_mutex};
+                m_stopping = false;
+            }
+            m_thread = std::thread{&Shard::run, this};
+#ifdef __linux__
+            if(pin) {
+                auto cores = std::max(1u, std::thread::hardware_concurrency());
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(m_index % cores, &cpus);
+                auto error = pthread_setaffinity_np(m_thread.native_handle(), sizeof(cpus), &cpus);
+                if(error != 0) {
+                    std::cerr << "Failed to pin shard " << m_index << " to core " << m_index % cores << ": " << error << std::endl;
+                }
+            }
+#else
+            (void) pin;
+#endif
+        }
+
+
+        void Gateway::Shard::stop() {
+            {
+                auto lock = std::lock_guard<std::mutex>{m_mutex};
+                m_stopping = true;
+            }
+            m_wakeup.notify_one();
+            if(m_thread.joinable()) {
+                m_thread.join();
+            }
+        }
+
+
+        void Gateway::Shard::post(Task task) {
+            {
+                auto lock = std::lock_guard<std::mutex>{m_mutex};
+                m_mailbox.push_back(std::move(task));
+            }
+            m_wakeup.notify_one();
+        }
+
+
+        void Gateway::Shard::addDevice(const std::shared_ptr<Device>& device) {
+            auto inserted = m_devices.emplace(device->deviceID()->id(), device).second;
+            if(!inserted) {
+                std::cerr << "Device " << device->deviceID()->id() << " already exists" << std::endl;
+                return;
+            }
+            m_scheduler.addDevice(device);
+            m_deviceCount.store(m_devices.size(), std::memory_order_relaxed);
+        }
+
+
+        void Gateway::Shard::removeDevice(std::string_view deviceID) {
+            auto it = m_devices.find(deviceID);
+            if(it == m_devices.end()) {
+                return;
+            }
+            m_scheduler.removeDevice(*it->second);
+            m_devices.erase(it);
+            m_deviceCount.store(m_devices.size(), std::memory_order_relaxed);
+        }
+
+
+        Device* Gateway::Shard::device(std::string_view deviceID) const {
+            auto it = m_devices.find(deviceID);
+            return it != m_devices.end() ? it->second.get() : nullptr;
+        }
+
+
+        size_t Gateway::Shard::updateAll() {
+            auto attributes = size_t{0};
+            for(auto& device : m_devices) {
+                m_buffer.clear();
+                device.second->update(m_buffer);
+                attributes += m_buffer.size();
+                if(m_gateway.m_publish) {
+                    m_gateway.m_publish(m_index, *device.second, m_buffer);
+                }
+            }
+            return attributes;
+        }
+
+
+        void Gateway::Shard::run() {
+            auto tasks = std::vector<Task>{};
+            while(true) {
+                {
+                    auto lock = std::unique_lock<std::mutex>{m_mutex};
+                    auto wake = [this]() { return m_stopping || !m_mailbox.empty(); };
+                    if(m_scheduler.deviceCount() > 0) {
+                        m_wakeup.wait_until(lock, m_scheduler.nextPoll(), wake);
+                    } else {
+                        m_wakeup.wait(lock, wake);
+                    }
+                    if(m_stopping && m_mailbox.empty()) {
+                        break;
+                    }
+                    // Keep the capacity of both vectors, so posting does not allocate in the steady state
+                    std::swap(tasks, m_mailbox);
+                }
+                for(auto& task : tasks) {
+                    task();
+                }
+                tasks.clear();
+                m_scheduler.poll();
+            }
+        }
+    }
+}
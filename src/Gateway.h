@@ -0,0 +1,128 @@
+#ifndef __HOMIE_GATEWAY_H__
+#define __HOMIE_GATEWAY_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Device.h"
+#include "HomieHelper.h"
+#include "StatsScheduler.h"
+
+namespace Rovi {
+    namespace Homie {
+        // Hosts a large number of devices in one process
+        // The devices are sharded across worker threads (by default one per core, pinned to it). A shard owns its
+        // devices exclusively: The devices, their nodes and the StatsScheduler of a shard are only touched by the worker
+        // thread of the shard, so generating attributes does not need any locks. Everything coming from outside, e.g.
+        // an inbound command for a device, is passed as a message to the mailbox of the owning shard.
+        class Gateway {
+            public:
+                using Clock = StatsScheduler::Clock;
+                // Called on the worker thread of the shard, e.g. forwards the buffer to the MQTT connection of the shard
+                using PublishFunction = std::function<void(size_t shard, Device& device, AttributeBuffer& buffer)>;
+                // Executed on the worker thread of the shard owning the device
+                using DeviceTask = std::function<void(Device& device)>;
+
+                struct Options {
+                    // 0: One shard per core
+                    size_t shards = 0;
+                    // Pin the worker thread of shard n to core n % cores (Linux only)
+                    bool pinThreads = true;
+                    // Resolution of the StatsScheduler of every shard
+                    std::chrono::milliseconds resolution{100};
+                };
+
+                explicit Gateway(PublishFunction publish);
+                Gateway(PublishFunction publish, const Options& options);
+                ~Gateway();
+                Gateway(const Gateway&) = delete;
+                Gateway& operator=(const Gateway&) = delete;
+
+                void start();
+                // Processes the messages which are already posted and joins the worker threads
+                void stop();
+                bool running() const { return m_running; }
+
+                size_t shardCount() const { return m_shards.size(); }
+                size_t shardOf(std::string_view deviceID) const;
+                size_t deviceCount() const;
+
+                // The device is handed over to its shard and must not be accessed directly afterwards, use post() instead.
+                // Devices with a statsInterval are updated by the StatsScheduler of the shard.
+                void addDevice(std::shared_ptr<Device> device);
+                void removeDevice(std::string_view deviceID);
+                // Run 'task' on the shard owning the device. Tasks for unknown devices are dropped.
+                void post(std::string_view deviceID, DeviceTask task);
+                // Inbound message homie/<device-id>/..., passed to Device::messageReceived() on the owning shard
+                void messageReceived(std::string_view topic, std::string_view payload);
+
+                // Generate and publish the stats of all devices on all shards in parallel. Blocks until all shards
+                // are done and returns the number of generated attributes.
+                size_t updateAll();
+                // Blocks until all messages posted so far are processed
+                void flush();
+                // updateAll() and flush() must not be called on a worker thread, e.g. from the PublishFunction or a
+                // DeviceTask: The shard would wait for its own mailbox. Such calls are rejected (updateAll() returns 0).
+
+            protected:
+                // Aligned to a cache line, so the hot members of different shards never share one
+                class alignas(64) Shard {
+                    public:
+                        using Task = std::function<void()>;
+
+                        Shard(Gateway& gateway, const size_t index);
+
+                        void start(const bool pin);
+                        void stop();
+                        void post(Task task);
+
+                        // Only called on the worker thread
+                        void addDevice(const std::shared_ptr<Device>& device);
+                        void removeDevice(std::string_view deviceID);
+                        Device* device(std::string_view deviceID) const;
+                        size_t updateAll();
+
+                        size_t deviceCount() const { return m_deviceCount.load(std::memory_order_relaxed); }
+                        bool isWorkerThread() const { return m_thread.get_id() == std::this_thread::get_id(); }
+
+                    protected:
+                        void run();
+
+                        Gateway& m_gateway;
+                        size_t m_index;
+                        std::thread m_thread;
+
+                        // Mailbox, the only state shared with other threads
+                        std::mutex m_mutex;
+                        std::condition_variable m_wakeup;
+                        std::vector<Task> m_mailbox;
+                        bool m_stopping;
+
+                        // Owned by the worker thread
+                        std::map<std::string, std::shared_ptr<Device>, std::less<>> m_devices;
+                        StatsScheduler m_scheduler;
+                        AttributeBuffer m_buffer;
+                        std::atomic<size_t> m_deviceCount;
+                };
+
+                // Run 'task' on every shard and wait until all are done. Returns false, if the gateway is not running
+                // or the caller is a worker thread.
+                bool runOnAllShards(const std::function<void(Shard& shard)>& task);
+
+                PublishFunction m_publish;
+                Options m_options;
+                std::vector<std::unique_ptr<Shard>> m_shards;
+                bool m_running;
+        };
+    }
+}
+
+#endif /* __HOMIE_GATEWAY_H__ */
@@ -3,10 +3,222 @@
 
 #include <algorithm>
 
+#include "Utils/CharacterClass.h"
 #include "Utils/StringUtils.h"
 
 namespace Rovi {
     namespace Homie {
+        //*******************************************************************//
+        // TopicPath
+        //*******************************************************************//
+        TopicPath::TopicPath(std::initializer_list<std::string> levels) 
+            : TopicPath{} 
+        {
+            auto bytes = size_t{0};
+            for(auto& level : levels) {
+                bytes += level.size() + 1;
+            }
+            m_path.reserve(bytes);
+            for(auto& level : levels) {
+                append(level);
+            }
+        }
+
+
+        TopicPath::TopicPath(const TopicListType& levels) 
+            : TopicPath{} 
+        {
+            for(auto& level : levels) {
+                append(level);
+            }
+        }
+
+
+        TopicPath::TopicPath(const TopicPath& prefix, const TopicPath& subpath) 
+            : TopicPath{} 
+        {
+            m_path.reserve(prefix.m_path.size() + 1 + subpath.m_path.size());
+            append(prefix);
+            append(subpath);
+        }
+
+
+        TopicPath& TopicPath::append(const std::string& level) {
+            if(m_levels > 0) {
+                m_path += '/';
+            }
+            m_path += level;
+            ++m_levels;
+            return *this;
+        }
+
+
+        TopicPath& TopicPath::append(const TopicPath& subpath) {
+            if(subpath.empty()) {
+                return *this;
+            }
+            if(m_levels > 0) {
+                m_path += '/';
+            }
+            m_path += subpath.m_path;
+            m_levels += subpath.m_levels;
+            return *this;
+        }
+
+
+        TopicPath TopicPath::fromPath(std::string_view path) {
+            auto topic = TopicPath{};
+            if(!path.empty()) {
+                topic.m_path.assign(path.data(), path.size());
+                topic.m_levels = static_cast<size_t>(std::count(path.begin(), path.end(), '/')) + 1;
+            }
+            return topic;
+        }
+
+
+        std::string TopicPath::front() const {
+            return m_path.substr(0, m_path.find('/'));
+        }
+
+
+        std::string TopicPath::back() const {
+            auto pos = m_path.rfind('/');
+            return pos == std::string::npos ? m_path : m_path.substr(pos + 1);
+        }
+
+
+        std::string TopicPath::toString() const {
+            auto str = std::string{};
+            if(m_levels > 0) {
+                str.reserve(m_path.size() + 1);
+                str += m_path;
+                str += '/';
+            }
+            return str;
+        }
+
+
+        TopicListType TopicPath::toList() const {
+            auto levels = TopicListType{};
+            if(m_levels == 0) {
+                return levels;
+            }
+            auto begin = size_t{0};
+            auto end = m_path.find('/');
+            while(end != std::string::npos) {
+                levels.emplace_back(m_path.substr(begin, end - begin));
+                begin = end + 1;
+                end = m_path.find('/', begin);
+            }
+            levels.emplace_back(m_path.substr(begin));
+            return levels;
+        }
+
+
+
+        //*******************************************************************//
+        // AttributeBuffer
+        //*******************************************************************//
+        void AttributeBuffer::append(const TopicType& prefix, const TopicType& topic, std::string_view payload) {
+            append(prefix, topic, payload, true);
+        }
+
+
+        void AttributeBuffer::append(const TopicType& prefix, const TopicType& topic, std::string_view payload, const bool retained) {
+            auto record = beginRecord(prefix, topic);
+            record.payloadLength = payload.size();
+            record.retained = retained;
+            m_data.append(payload.data(), payload.size());
+            m_records.push_back(record);
+        }
+
+
+        void AttributeBuffer::append(const TopicType& topic, std::string_view payload) {
+            append(TopicType{}, topic, payload);
+        }
+
+
+        void AttributeBuffer::appendPath(std::string_view topic, std::string_view payload) {
+            appendPath(topic, payload, true);
+        }
+
+
+        void AttributeBuffer::appendPath(std::string_view topic, std::string_view payload, const bool retained) {
+            auto record = Record{m_data.size(), topic.size(), m_data.size() + topic.size(), payload.size(), retained};
+            m_data.append(topic.data(), topic.size());
+            m_data.append(payload.data(), payload.size());
+            m_records.push_back(record);
+        }
+
+
+        void AttributeBuffer::append(const TopicType& prefix, const TopicType& topic, const TopicType& subtopic, std::string_view payload) {
+            auto record = beginRecord(prefix, topic);
+            appendLevels(record.topicOffset, subtopic);
+            record.topicLength = m_data.size() - record.topicOffset;
+            record.payloadOffset = m_data.size();
+            record.payloadLength = payload.size();
+            m_data.append(payload.data(), payload.size());
+            m_records.push_back(record);
+        }
+
+
+        AttributeBuffer::Record AttributeBuffer::beginRecord(const TopicType& prefix, const TopicType& topic) {
+            auto record = Record{};
+            record.topicOffset = m_data.size();
+            m_data += prefix.path();
+            appendLevels(record.topicOffset, topic);
+            record.topicLength = m_data.size() - record.topicOffset;
+            record.payloadOffset = m_data.size();
+            record.payloadLength = 0;
+            record.retained = true;
+            return record;
+        }
+
+
+        void AttributeBuffer::appendLevels(const size_t topicOffset, const TopicType& topic) {
+            if(topic.empty()) {
+                return;
+            }
+            if(m_data.size() > topicOffset) {
+                m_data += '/';
+            }
+            m_data += topic.path();
+        }
+
+
+        std::string_view AttributeBuffer::topic(const size_t index) const {
+            auto& record = m_records[index];
+            return std::string_view{m_data.data() + record.topicOffset, record.topicLength};
+        }
+
+
+        std::string_view AttributeBuffer::payload(const size_t index) const {
+            auto& record = m_records[index];
+            return std::string_view{m_data.data() + record.payloadOffset, record.payloadLength};
+        }
+
+
+        std::vector<AttributeType> AttributeBuffer::toAttributes() const {
+            auto attributes = std::vector<AttributeType>{};
+            attributes.reserve(m_records.size());
+            for(size_t i = 0; i < m_records.size(); ++i) {
+                attributes.emplace_back(TopicType::fromPath(topic(i)), ValueType{payload(i)});
+            }
+            return attributes;
+        }
+
+
+
+        //*******************************************************************//
+        // CycleArena
+        //*******************************************************************//
+        CycleArena::CycleArena(const size_t initialBytes, std::pmr::memory_resource* upstream)
+            : m_block{new std::byte[initialBytes]}, m_resource{m_block.get(), initialBytes, upstream}
+        {
+        }
+
+
+
         //*******************************************************************//
         // TopicID
         //*******************************************************************//
@@ -24,7 +236,7 @@ namespace Rovi {
         // A topic level ID MUST NOT start or end with a hyphen (-). The special character $ is used and reserved for Homie attributes. The underscore (_) is used and reserved for Homie node arrays.
         bool TopicID::isValid(const std::string id) const {
             auto isValid = bool{true};
-            isValid &= StringUtils::checkStringForAllowedCharacters(id, std::string("abcdefghijklmnopqrstuvwxyz-01234567890"));
+            isValid &= CharacterClass::topicID().matchesAll(id);
             if(id.size() > 0) {
                 isValid &= (id.front() != '-');
                 isValid &= (id.back() != '-');
@@ -44,7 +256,14 @@ namespace Rovi {
 
 
         std::string Version::toString() const {
-            return StringUtils::toString((uint32_t) m_major) + "." + StringUtils::toString((uint32_t) m_minor) + "." + StringUtils::toString((uint32_t) m_revision);
+            auto str = std::string{};
+            str.reserve(11);        // max "255.255.255"
+            StringUtils::appendNumber(str, (uint32_t) m_major);
+            str += '.';
+            StringUtils::appendNumber(str, (uint32_t) m_minor);
+            str += '.';
+            StringUtils::appendNumber(str, (uint32_t) m_revision);
+            return str;
         }
 
 
@@ -74,6 +293,19 @@ namespace Rovi {
         }
 
 
+        HWInfo::Values HWInfo::values() const {
+            auto values = Values{};
+            values.uptime = uptime();
+            values.signalStrength = signalStrength();
+            values.cpuTemperature = cpuTemperature();
+            values.cpuLoad = cpuLoad();
+            values.batteryLevel = batteryLevel();
+            values.freeheap = freeheap();
+            values.supplyVoltage = supplyVoltage();
+            return values;
+        }
+
+
         std::string HWInfo::toString() const {
             return std::string{"MAC: "} + m_mac + std::string{", IP: "} + m_ip + std::string{", implementation: "} + m_implementation;
         }
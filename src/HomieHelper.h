@@ -2,22 +2,157 @@
 #define __HOMIE_HELPER_H__
 
 #include <string>
+#include <string_view>
+#include <vector>
 #include <stdint.h>
 #include <list>
+#include <initializer_list>
+#include <utility>
 #include <chrono>
+#include <memory>
+#include <memory_resource>
 
 namespace Rovi {
     namespace Homie{
-        using TopicType = std::list<std::string>;
+        // Legacy representation of a topic path: One list entry per topic level
+        using TopicListType = std::list<std::string>;
+
+        // Contiguous MQTT topic path. All levels are stored in a single buffer separated
+        // by '/', so building and extending a path requires (at most) one allocation
+        // instead of one list node and one string per level.
+        class TopicPath {
+            public:
+                TopicPath() : m_path{}, m_levels{0} {}
+                TopicPath(std::initializer_list<std::string> levels);
+                explicit TopicPath(const TopicListType& levels);
+                // Concatenation of prefix and subpath using a single allocation
+                TopicPath(const TopicPath& prefix, const TopicPath& subpath);
+                // Split a '/' separated path, e.g. "homie/device/$name"
+                static TopicPath fromPath(std::string_view path);
+
+                TopicPath& append(const std::string& level);
+                TopicPath& append(const TopicPath& subpath);
+                void reserve(const size_t bytes) { m_path.reserve(bytes); }
+
+                size_t size() const { return m_levels; }
+                bool empty() const { return m_levels == 0; }
+                std::string front() const;
+                std::string back() const;
+
+                // Levels joined by '/' without tailing separator, e.g. "homie/device/$name"
+                const std::string& path() const { return m_path; }
+                // Levels joined by '/' including the tailing separator, e.g. "homie/device/$name/"
+                std::string toString() const;
+                TopicListType toList() const;
+
+                bool operator==(const TopicPath& rhs) const { return m_levels == rhs.m_levels && m_path == rhs.m_path; }
+                bool operator!=(const TopicPath& rhs) const { return !(*this == rhs); }
+
+            protected:
+                std::string m_path;
+                size_t m_levels;
+        };
+
+        using TopicType = TopicPath;
         using ValueType = std::string;
         using AttributeType = std::pair<TopicType, ValueType>;
 
+        // Reusable output buffer for a batch of attributes
+        // The topics and payloads of all attributes are serialized back to back into one contiguous buffer:
+        //   [topic 0][payload 0][topic 1][payload 1]...
+        // Topics are written without tailing '/', i.e. as sent via MQTT. The records only store offsets, so a
+        // transport can hand the topic and payload ranges (e.g. as iovec) to the kernel without further copying.
+        // clear() keeps the allocated memory, so a buffer reused for every cycle does not allocate after warm up.
+        // Alternatively the buffer can allocate from a memory resource, e.g. a CycleArena released after every cycle.
+        class AttributeBuffer {
+            public:
+                struct Record {
+                    size_t topicOffset;
+                    size_t topicLength;
+                    size_t payloadOffset;
+                    size_t payloadLength;
+                    // False for the values of properties with $retained = false
+                    bool retained;
+                };
+
+                AttributeBuffer() : AttributeBuffer(std::pmr::get_default_resource()) {}
+                explicit AttributeBuffer(std::pmr::memory_resource* resource) : m_data{resource}, m_records{resource} {}
+
+                void clear() { m_data.clear(); m_records.clear(); }
+                void reserve(const size_t records, const size_t bytes) { m_records.reserve(records); m_data.reserve(bytes); }
+                std::pmr::memory_resource* resource() const { return m_records.get_allocator().resource(); }
+
+                // Append a record with the topic <prefix>/<topic>
+                void append(const TopicType& prefix, const TopicType& topic, std::string_view payload);
+                void append(const TopicType& prefix, const TopicType& topic, std::string_view payload, const bool retained);
+                void append(const TopicType& topic, std::string_view payload);
+                // Append a record with the topic <prefix>/<topic>/<subtopic>, e.g. for the attributes of properties
+                void append(const TopicType& prefix, const TopicType& topic, const TopicType& subtopic, std::string_view payload);
+                // Topic given as '/' separated path, e.g. "homie/device/node/property"
+                void appendPath(std::string_view topic, std::string_view payload);
+                void appendPath(std::string_view topic, std::string_view payload, const bool retained);
+                // The payload is appended to the buffer by 'writePayload(std::pmr::string& data)', so it does not need
+                // a temporary string
+                template<typename Writer>
+                void appendPayload(const TopicType& prefix, const TopicType& topic, Writer&& writePayload) {
+                    auto record = beginRecord(prefix, topic);
+                    writePayload(m_data);
+                    record.payloadLength = m_data.size() - record.payloadOffset;
+                    m_records.push_back(record);
+                }
+
+                size_t size() const { return m_records.size(); }
+                bool empty() const { return m_records.empty(); }
+                const std::pmr::vector<Record>& records() const { return m_records; }
+                // Start and size of the serialized data of all records
+                const char* data() const { return m_data.data(); }
+                size_t bytes() const { return m_data.size(); }
+
+                std::string_view topic(const size_t index) const;
+                std::string_view payload(const size_t index) const;
+                bool retained(const size_t index) const { return m_records[index].retained; }
+
+                // Compatibility view: Convert all records into the (topic, value) pairs
+                std::vector<AttributeType> toAttributes() const;
+
+            protected:
+                // Writes the topic, the payload offset is set to the end of the topic
+                Record beginRecord(const TopicType& prefix, const TopicType& topic);
+                // Appends the levels of 'topic' to the topic of the record starting at 'topicOffset'
+                void appendLevels(const size_t topicOffset, const TopicType& topic);
+
+                std::pmr::string m_data;
+                std::pmr::vector<Record> m_records;
+        };
+
+        // Memory for the attributes of one publish cycle
+        // Allocations advance a pointer in a monotonic buffer, deallocations are no-ops and reset() releases all of
+        // them at once. A cycle like
+        //   { auto buffer = AttributeBuffer{arena.resource()}; device->update(buffer); client.publish(buffer); }
+        //   arena.reset();
+        // therefore does not use the global heap, as long as the initial block is large enough for a cycle.
+        // Additional blocks are requested from 'upstream' and returned by reset().
+        class CycleArena {
+            public:
+                explicit CycleArena(const size_t initialBytes, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+                CycleArena(const CycleArena&) = delete;
+                CycleArena& operator=(const CycleArena&) = delete;
+
+                std::pmr::memory_resource* resource() { return &m_resource; }
+                // All memory allocated since the last reset() must not be used anymore
+                void reset() { m_resource.release(); }
+
+            protected:
+                std::unique_ptr<std::byte[]> m_block;
+                std::pmr::monotonic_buffer_resource m_resource;
+        };
+
         class TopicID {
             public:
                 TopicID(const std::string& id);
 
-                std::string id() const {return m_id; }
-                std::string toString() const {return m_id; }
+                const std::string& id() const {return m_id; }
+                const std::string& toString() const {return m_id; }
 
             protected:
                 bool isValid(const std::string id) const;
@@ -55,7 +190,19 @@ namespace Rovi {
         // TODO: Move to some MQTT and/or ESP32 interface
         class HWInfo {
             public:
+                // All stats of one sample
+                struct Values {
+                    std::chrono::seconds uptime{0};
+                    uint32_t signalStrength = 0;
+                    uint32_t cpuTemperature = 0;
+                    uint32_t cpuLoad = 0;
+                    uint32_t batteryLevel = 0;
+                    uint32_t freeheap = 0;
+                    float supplyVoltage = 0.0f;
+                };
+
                 HWInfo(const std::string& mac, const std::string& ip, const std::string& implementation);
+                virtual ~HWInfo() = default;
 
                 std::string mac() const { return m_mac; }
                 std::string ip() const { return m_ip; }
@@ -67,7 +214,14 @@ namespace Rovi {
                 // Make this function pure virtual
                 virtual std::list<Stats> supportedStats() const; 
 
-                std::chrono::seconds uptime() const;
+                // Called by Device::update() before the stats are read, so an implementation can read all its sources
+                // in one pass instead of once per getter
+                virtual void sample() {}
+                // All stats at once, read by Device::update() after sample(). The default implementation calls the
+                // getters, implementations shared by several threads return one consistent sample without locking.
+                virtual Values values() const;
+
+                virtual std::chrono::seconds uptime() const;
                 // TODO: Implement (hardware specific)
                 // Signal strength in %
                 virtual uint32_t signalStrength() const { return 100; }
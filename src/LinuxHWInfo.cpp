@@ -0,0 +1,273 @@
+#include "LinuxHWInfo.h"
+#include "Utils/StringUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Rovi {
+    namespace Homie {
+        namespace {
+            int openSource(const std::string& path) {
+                return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            }
+
+            // Content of small sysfs attributes, e.g. the type of a thermal zone
+            std::string readAttribute(const std::filesystem::path& path) {
+                auto fd = openSource(path.string());
+                if(fd < 0) {
+                    return {};
+                }
+                char buffer[64];
+                auto size = ::pread(fd, buffer, sizeof(buffer), 0);
+                ::close(fd);
+                return size > 0 ? std::string{StringUtils::trimView(std::string_view{buffer, static_cast<size_t>(size)}, " \t\n")} : std::string{};
+            }
+
+            // Decimal digits of a token, no allocation (the token is not null terminated)
+            uint64_t parseUnsigned(std::string_view token) {
+                auto value = uint64_t{0};
+                for(auto c : token) {
+                    if(c < '0' || c > '9') {
+                        break;
+                    }
+                    value = value * 10 + static_cast<uint64_t>(c - '0');
+                }
+                return value;
+            }
+        }
+
+
+        LinuxHWInfo::LinuxHWInfo(const std::string& mac, const std::string& ip, const std::string& implementation, const std::string& root)
+            : HWInfo{mac, ip, implementation}, m_fds{}, m_buffer{}, m_minimumSampleInterval{std::chrono::seconds{1}},
+              m_lastSample{}, m_sampled{false}, m_cpuBusy{0}, m_cpuTotal{0}, m_mutex{}, m_values{std::make_unique<Values>()}
+        {
+            m_fds.fill(-1);
+            m_fds[procStat] = openSource(root + "/proc/stat");
+            m_fds[procMeminfo] = openSource(root + "/proc/meminfo");
+            m_fds[procUptime] = openSource(root + "/proc/uptime");
+            openThermalZone(root);
+            openBattery(root);
+            if(m_fds[procStat] < 0 || m_fds[procMeminfo] < 0 || m_fds[procUptime] < 0) {
+                std::cerr << "Failed to open " << root << "/proc" << std::endl;
+            }
+            sample();
+        }
+
+
+        LinuxHWInfo::~LinuxHWInfo() {
+            for(auto fd : m_fds) {
+                if(fd >= 0) {
+                    ::close(fd);
+                }
+            }
+        }
+
+
+        void LinuxHWInfo::setMinimumSampleInterval(const std::chrono::milliseconds interval) {
+            auto lock = std::lock_guard<std::mutex>{m_mutex};
+            m_minimumSampleInterval = interval;
+        }
+
+
+        std::list<Stats> LinuxHWInfo::supportedStats() const {
+            auto stats = std::list<Stats>{};
+            if(m_fds[procUptime] >= 0) {
+                stats.push_back(Stats::uptime);
+            }
+            if(m_fds[thermalTemp] >= 0) {
+                stats.push_back(Stats::cputemp);
+            }
+            if(m_fds[procStat] >= 0) {
+                stats.push_back(Stats::cpuload);
+            }
+            if(m_fds[batteryCapacity] >= 0) {
+                stats.push_back(Stats::battery);
+            }
+            if(m_fds[procMeminfo] >= 0) {
+                stats.push_back(Stats::freeheap);
+            }
+            if(m_fds[batteryVoltage] >= 0) {
+                stats.push_back(Stats::supply);
+            }
+            return stats;
+        }
+
+
+        void LinuxHWInfo::sample() {
+            // Another thread is sampling, its values are published in a moment
+            auto lock = std::unique_lock<std::mutex>{m_mutex, std::try_to_lock};
+            if(!lock.owns_lock()) {
+                return;
+            }
+            auto now = Clock::now();
+            if(m_sampled && now - m_lastSample < m_minimumSampleInterval) {
+                return;
+            }
+            m_sampled = true;
+            m_lastSample = now;
+
+            auto values = std::make_unique<Values>(*m_values.read());
+            values->signalStrength = signalStrength();
+            sampleCpu(*values);
+            sampleMemory(*values);
+            if(auto data = read(procUptime)) {
+                values->uptime = std::chrono::seconds{static_cast<int64_t>(std::strtod(data, nullptr))};
+            }
+            // Millidegree Celsius
+            if(auto data = read(thermalTemp)) {
+                values->cpuTemperature = static_cast<uint32_t>(std::max(0l, std::strtol(data, nullptr, 10)) / 1000);
+            }
+            if(auto data = read(batteryCapacity)) {
+                values->batteryLevel = static_cast<uint32_t>(std::strtoul(data, nullptr, 10));
+            }
+            // Microvolt
+            if(auto data = read(batteryVoltage)) {
+                values->supplyVoltage = static_cast<float>(std::strtod(data, nullptr) / 1e6);
+            }
+            m_values.publish(std::move(values));
+        }
+
+
+        HWInfo::Values LinuxHWInfo::values() const {
+            return *m_values.read();
+        }
+
+
+        std::chrono::seconds LinuxHWInfo::uptime() const {
+            return m_values.read()->uptime;
+        }
+
+
+        uint32_t LinuxHWInfo::cpuTemperature() const {
+            return m_values.read()->cpuTemperature;
+        }
+
+
+        uint32_t LinuxHWInfo::cpuLoad() const {
+            return m_values.read()->cpuLoad;
+        }
+
+
+        uint32_t LinuxHWInfo::batteryLevel() const {
+            return m_values.read()->batteryLevel;
+        }
+
+
+        uint32_t LinuxHWInfo::freeheap() const {
+            return m_values.read()->freeheap;
+        }
+
+
+        float LinuxHWInfo::supplyVoltage() const {
+            return m_values.read()->supplyVoltage;
+        }
+
+
+        void LinuxHWInfo::openThermalZone(const std::string& root) {
+            // Prefer the zone of the CPU package, otherwise take the first one
+            auto directory = std::filesystem::path{root + "/sys/class/thermal"};
+            auto error = std::error_code{};
+            auto zones = std::vector<std::filesystem::path>{};
+            for(auto& entry : std::filesystem::directory_iterator{directory, error}) {
+                if(entry.path().filename().string().rfind("thermal_zone", 0) == 0) {
+                    zones.push_back(entry.path());
+                }
+            }
+            std::sort(zones.begin(), zones.end());
+            auto selected = zones.empty() ? std::filesystem::path{} : zones.front();
+            for(auto& zone : zones) {
+                auto type = readAttribute(zone / "type");
+                if(type == "x86_pkg_temp" || type.find("cpu") != std::string::npos || type.find("soc") != std::string::npos) {
+                    selected = zone;
+                    break;
+                }
+            }
+            if(!selected.empty()) {
+                m_fds[thermalTemp] = openSource((selected / "temp").string());
+            }
+        }
+
+
+        void LinuxHWInfo::openBattery(const std::string& root) {
+            auto directory = std::filesystem::path{root + "/sys/class/power_supply"};
+            auto error = std::error_code{};
+            for(auto& entry : std::filesystem::directory_iterator{directory, error}) {
+                if(readAttribute(entry.path() / "type") == "Battery") {
+                    m_fds[batteryCapacity] = openSource((entry.path() / "capacity").string());
+                    m_fds[batteryVoltage] = openSource((entry.path() / "voltage_now").string());
+                    return;
+                }
+            }
+        }
+
+
+        const char* LinuxHWInfo::read(const Source source) {
+            if(m_fds[source] < 0) {
+                return nullptr;
+            }
+            auto size = ::pread(m_fds[source], m_buffer.data(), m_buffer.size() - 1, 0);
+            if(size <= 0) {
+                return nullptr;
+            }
+            m_buffer[static_cast<size_t>(size)] = '\0';
+            return m_buffer.data();
+        }
+
+
+        void LinuxHWInfo::sampleCpu(Values& values) {
+            // First line: cpu  user nice system idle iowait irq softirq steal guest guest_nice (in ticks)
+            auto data = read(procStat);
+            if(data == nullptr) {
+                return;
+            }
+            auto line = std::string_view{data};
+            line = line.substr(0, line.find('\n'));
+            auto total = uint64_t{0};
+            auto idle = uint64_t{0};
+            auto column = 0;
+            for(auto token : StringUtils::tokenize(line, ' ')) {
+                if(token.empty() || column++ == 0) {
+                    continue;
+                }
+                // Guest time is already included in user and nice
+                if(column > 9) {
+                    break;
+                }
+                auto value = parseUnsigned(token);
+                total += value;
+                // idle and iowait
+                if(column == 5 || column == 6) {
+                    idle += value;
+                }
+            }
+            auto busy = total - idle;
+            if(total > m_cpuTotal && busy >= m_cpuBusy && m_cpuTotal > 0) {
+                values.cpuLoad = static_cast<uint32_t>((busy - m_cpuBusy) * 100 / (total - m_cpuTotal));
+            }
+            m_cpuBusy = busy;
+            m_cpuTotal = total;
+        }
+
+
+        void LinuxHWInfo::sampleMemory(Values& values) {
+            // MemAvailable:    1234567 kB
+            auto data = read(procMeminfo);
+            if(data == nullptr) {
+                return;
+            }
+            auto content = std::string_view{data};
+            auto position = content.find("MemAvailable:");
+            if(position == std::string_view::npos) {
+                return;
+            }
+            auto available = std::strtoull(data + position + 13, nullptr, 10) * 1024;
+            values.freeheap = static_cast<uint32_t>(std::min<unsigned long long>(available, std::numeric_limits<uint32_t>::max()));
+        }
+    }
+}
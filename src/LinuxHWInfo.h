@@ -0,0 +1,81 @@
+#ifndef __HOMIE_LINUXHWINFO_H__
+#define __HOMIE_LINUXHWINFO_H__
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "HomieHelper.h"
+#include "Utils/Rcu.h"
+
+namespace Rovi {
+    namespace Homie {
+        // HWInfo of a Linux host, read from /proc and /sys
+        // All sources are opened once and re-read with pread(), which makes procfs and sysfs regenerate their content.
+        // sample() reads all of them in one pass and publishes the values via RCU, values() and the getters read the
+        // last sample without a lock. The CPU load is the average since the previous sample.
+        // One instance can be shared by all devices on the host (even across Gateway shards): Samples younger than
+        // the minimum sample interval are reused, and a sample() call while another thread samples returns at once.
+        // The CPU load is then averaged since the last sample taken for any device (at least the minimum sample
+        // interval), not over the stats interval of each device.
+        // Stats without a source (e.g. no battery or no thermal zone) are not reported by supportedStats().
+        class LinuxHWInfo : public HWInfo {
+            public:
+                // 'root' is prepended to all paths, e.g. for a copy of /proc and /sys in tests
+                LinuxHWInfo(const std::string& mac, const std::string& ip, const std::string& implementation,
+                    const std::string& root = "");
+                ~LinuxHWInfo() override;
+                LinuxHWInfo(const LinuxHWInfo&) = delete;
+                LinuxHWInfo& operator=(const LinuxHWInfo&) = delete;
+
+                void setMinimumSampleInterval(const std::chrono::milliseconds interval);
+
+                std::list<Stats> supportedStats() const override;
+                void sample() override;
+                Values values() const override;
+
+                std::chrono::seconds uptime() const override;
+                uint32_t cpuTemperature() const override;
+                uint32_t cpuLoad() const override;
+                uint32_t batteryLevel() const override;
+                // MemAvailable, saturated at 4 GiB
+                uint32_t freeheap() const override;
+                float supplyVoltage() const override;
+
+            protected:
+                using Clock = std::chrono::steady_clock;
+
+                enum Source {
+                    procStat,
+                    procMeminfo,
+                    procUptime,
+                    thermalTemp,
+                    batteryCapacity,
+                    batteryVoltage,
+                    sourceCount
+                };
+
+                void openThermalZone(const std::string& root);
+                void openBattery(const std::string& root);
+                // Reads the whole file (up to the buffer size) into m_buffer. Returns nullptr on errors.
+                const char* read(const Source source);
+                void sampleCpu(Values& values);
+                void sampleMemory(Values& values);
+
+                std::array<int, sourceCount> m_fds;
+                std::array<char, 4096> m_buffer;
+                Clock::duration m_minimumSampleInterval;
+                Clock::time_point m_lastSample;
+                bool m_sampled;
+                uint64_t m_cpuBusy;
+                uint64_t m_cpuTotal;
+
+                // Serializes the samplers, readers only use m_values
+                std::mutex m_mutex;
+                RcuValue<Values> m_values;
+        };
+    }
+}
+
+#endif /* __HOMIE_LINUXHWINFO_H__ */
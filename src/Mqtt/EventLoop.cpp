@@ -0,0 +1,415 @@
+#include "EventLoop.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <iostream>
+
+namespace Rovi {
+    namespace Mqtt {
+        namespace {
+            // writev() without SIGPIPE on closed connections
+            ssize_t sendv(const int fd, const iovec* iovecs, const size_t count) {
+                auto message = msghdr{};
+                message.msg_iov = const_cast<iovec*>(iovecs);
+                message.msg_iovlen = count;
+                return sendmsg(fd, &message, MSG_NOSIGNAL);
+            }
+        }
+
+
+        //*******************************************************************//
+        // EventLoop
+        //*******************************************************************//
+        EventLoop::EventLoop()
+            : m_epollFD{epoll_create1(EPOLL_CLOEXEC)}, m_running{false}
+        {
+            if(m_epollFD < 0) {
+                std::cerr << "Failed to create epoll instance (errno " << errno << ")" << std::endl;
+            }
+        }
+
+
+        EventLoop::~EventLoop() {
+            if(m_epollFD >= 0) {
+                ::close(m_epollFD);
+            }
+        }
+
+
+        bool EventLoop::add(const int fd, const uint32_t events, Handler* handler) {
+            auto event = epoll_event{};
+            event.events = events;
+            event.data.ptr = handler;
+            if(epoll_ctl(m_epollFD, EPOLL_CTL_ADD, fd, &event) != 0) {
+                return false;
+            }
+            m_handlers.push_back(handler);
+            m_removedHandlers.erase(std::remove(m_removedHandlers.begin(), m_removedHandlers.end(), handler), m_removedHandlers.end());
+            return true;
+        }
+
+
+        bool EventLoop::modify(const int fd, const uint32_t events, Handler* handler) {
+            auto event = epoll_event{};
+            event.events = events;
+            event.data.ptr = handler;
+            return epoll_ctl(m_epollFD, EPOLL_CTL_MOD, fd, &event) == 0;
+        }
+
+
+        void EventLoop::remove(const int fd, Handler* handler) {
+            epoll_ctl(m_epollFD, EPOLL_CTL_DEL, fd, nullptr);
+            m_handlers.erase(std::remove(m_handlers.begin(), m_handlers.end(), handler), m_handlers.end());
+            // Events of the current iteration may still refer to the handler
+            m_removedHandlers.push_back(handler);
+        }
+
+
+        int EventLoop::runOnce(const std::chrono::milliseconds timeout) {
+            auto now = Clock::now();
+            auto deadline = now + timeout;
+            for(auto handler : m_handlers) {
+                deadline = std::min(deadline, handler->nextDeadline());
+            }
+            auto timeout_ms = deadline <= now ? 0 :
+                static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+
+            constexpr int maxEvents = 64;
+            epoll_event events[maxEvents];
+            m_removedHandlers.clear();
+            auto count = epoll_wait(m_epollFD, events, maxEvents, timeout_ms);
+            if(count < 0) {
+                count = 0;          // EINTR
+            }
+            for(int i = 0; i < count; ++i) {
+                auto handler = static_cast<Handler*>(events[i].data.ptr);
+                if(std::find(m_removedHandlers.begin(), m_removedHandlers.end(), handler) != m_removedHandlers.end()) {
+                    continue;
+                }
+                handler->handleEvents(events[i].events);
+            }
+
+            now = Clock::now();
+            auto handlers = m_handlers;
+            for(auto handler : handlers) {
+                if(std::find(m_handlers.begin(), m_handlers.end(), handler) != m_handlers.end()) {
+                    handler->handleTick(now);
+                }
+            }
+            return count;
+        }
+
+
+        void EventLoop::run() {
+            m_running = true;
+            while(m_running) {
+                runOnce();
+            }
+        }
+
+
+        //*******************************************************************//
+        // Connection
+        //*******************************************************************//
+        Connection::Connection(EventLoop& loop)
+            : m_loop(loop), m_fd{-1}, m_connecting{false}, m_closeAfterFlush{false}, m_writeInterest{false},
+              m_outbound{}, m_outboundOffset{0}, m_inbound{}, m_lastSent{Clock::now()}
+        {}
+
+
+        Connection::~Connection() {
+            if(isOpen()) {
+                m_loop.remove(m_fd, this);
+                ::close(m_fd);
+            }
+        }
+
+
+        bool Connection::attach(const int fd, const bool connecting) {
+            m_fd = fd;
+            m_connecting = connecting;
+            m_closeAfterFlush = false;
+            m_outbound.clear();
+            m_outboundOffset = 0;
+            m_inbound.clear();
+            m_writeInterest = connecting;
+            m_lastSent = Clock::now();
+            auto events = static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP | (connecting ? static_cast<uint32_t>(EPOLLOUT) : 0u));
+            if(!m_loop.add(fd, events, this)) {
+                ::close(fd);
+                m_fd = -1;
+                return false;
+            }
+            return true;
+        }
+
+
+        bool Connection::send(const iovec* iovecs, const size_t count) {
+            if(!isOpen() || m_closeAfterFlush) {
+                return false;
+            }
+
+            auto index = size_t{0};
+            auto offset = size_t{0};
+            if(!m_connecting && pendingBytes() == 0) {
+                // Fast path: Hand the iovecs to the kernel until it stops accepting data
+                while(index < count) {
+                    auto chunk = std::min<size_t>(count - index, IOV_MAX);
+                    auto written = ssize_t{0};
+                    if(offset == 0) {
+                        written = sendv(m_fd, iovecs + index, chunk);
+                    } else {
+                        // Partially written iovec
+                        auto first = iovec{static_cast<char*>(iovecs[index].iov_base) + offset, iovecs[index].iov_len - offset};
+                        written = sendv(m_fd, &first, 1);
+                    }
+                    if(written < 0) {
+                        if(errno == EINTR) {
+                            continue;
+                        }
+                        if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                            break;
+                        }
+                        close();
+                        return false;
+                    }
+                    m_lastSent = Clock::now();
+                    auto bytes = static_cast<size_t>(written);
+                    while(index < count && bytes >= iovecs[index].iov_len - offset) {
+                        bytes -= iovecs[index].iov_len - offset;
+                        offset = 0;
+                        ++index;
+                    }
+                    offset += bytes;
+                }
+            }
+
+            // Keep the remainder until the socket becomes writable again
+            if(index < count) {
+                if(m_outboundOffset > 0 && m_outboundOffset == m_outbound.size()) {
+                    m_outbound.clear();
+                    m_outboundOffset = 0;
+                }
+                for(; index < count; ++index) {
+                    auto data = static_cast<const uint8_t*>(iovecs[index].iov_base);
+                    m_outbound.insert(m_outbound.end(), data + offset, data + iovecs[index].iov_len);
+                    offset = 0;
+                }
+                updateEvents();
+            }
+            return true;
+        }
+
+
+        bool Connection::send(const std::vector<uint8_t>& packet) {
+            auto vec = iovec{const_cast<uint8_t*>(packet.data()), packet.size()};
+            return send(&vec, 1);
+        }
+
+
+        void Connection::closeAfterFlush() {
+            if(!isOpen()) {
+                return;
+            }
+            m_closeAfterFlush = true;
+            if(pendingBytes() == 0 && !m_connecting) {
+                shutdown(m_fd, SHUT_WR);
+            }
+        }
+
+
+        void Connection::close() {
+            if(!isOpen()) {
+                return;
+            }
+            m_loop.remove(m_fd, this);
+            ::close(m_fd);
+            m_fd = -1;
+            m_connecting = false;
+            m_outbound.clear();
+            m_outboundOffset = 0;
+            m_inbound.clear();
+            connectionClosed();
+        }
+
+
+        void Connection::handleEvents(const uint32_t events) {
+            if(m_connecting && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+                auto error = 0;
+                auto length = socklen_t{sizeof(error)};
+                getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                if(error != 0) {
+                    close();
+                    return;
+                }
+                m_connecting = false;
+                connectionEstablished();
+                if(!isOpen()) {
+                    return;
+                }
+            }
+            if(events & EPOLLIN) {
+                receive();
+                if(!isOpen()) {
+                    return;
+                }
+            }
+            if(events & EPOLLOUT) {
+                flush();
+                if(!isOpen()) {
+                    return;
+                }
+            }
+            if(events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+                close();
+            }
+        }
+
+
+        void Connection::flush() {
+            while(pendingBytes() > 0) {
+                auto written = ::send(m_fd, m_outbound.data() + m_outboundOffset, pendingBytes(), MSG_NOSIGNAL);
+                if(written < 0) {
+                    if(errno == EINTR) {
+                        continue;
+                    }
+                    if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                        break;
+                    }
+                    close();
+                    return;
+                }
+                m_lastSent = Clock::now();
+                m_outboundOffset += static_cast<size_t>(written);
+            }
+            if(pendingBytes() == 0) {
+                m_outbound.clear();
+                m_outboundOffset = 0;
+                if(m_closeAfterFlush) {
+                    shutdown(m_fd, SHUT_WR);
+                }
+            }
+            updateEvents();
+        }
+
+
+        void Connection::receive() {
+            uint8_t buffer[16384];
+            auto peerClosed = false;
+            while(true) {
+                auto received = recv(m_fd, buffer, sizeof(buffer), 0);
+                if(received < 0) {
+                    if(errno == EINTR) {
+                        continue;
+                    }
+                    if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                        break;
+                    }
+                    close();
+                    return;
+                }
+                if(received == 0) {
+                    // Packets received before the end of the stream are still processed
+                    peerClosed = true;
+                    break;
+                }
+                m_inbound.insert(m_inbound.end(), buffer, buffer + received);
+            }
+
+            auto offset = size_t{0};
+            auto packet = PacketView{};
+            auto consumed = size_t{0};
+            while(isOpen()) {
+                auto result = decodePacket(m_inbound.data() + offset, m_inbound.size() - offset, packet, consumed);
+                if(result == DecodeResult::incomplete) {
+                    break;
+                }
+                if(result == DecodeResult::malformed) {
+                    close();
+                    return;
+                }
+                offset += consumed;
+                packetReceived(packet);
+            }
+            if(peerClosed) {
+                close();
+            } else if(isOpen()) {
+                m_inbound.erase(m_inbound.begin(), m_inbound.begin() + static_cast<std::ptrdiff_t>(offset));
+            }
+        }
+
+
+        void Connection::updateEvents() {
+            auto writeInterest = m_connecting || pendingBytes() > 0;
+            if(writeInterest != m_writeInterest) {
+                m_writeInterest = writeInterest;
+                m_loop.modify(m_fd, static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP | (writeInterest ? static_cast<uint32_t>(EPOLLOUT) : 0u)), this);
+            }
+        }
+
+
+        //*******************************************************************//
+        // Sockets
+        //*******************************************************************//
+        int connectNonBlocking(const std::string& host, const uint16_t port, bool& connecting) {
+            auto address = sockaddr_in{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            if(inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+                return -1;
+            }
+
+            auto fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if(fd < 0) {
+                return -1;
+            }
+            // Small PUBLISH packets must not wait for Nagle's algorithm
+            auto noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+            connecting = false;
+            if(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                if(errno != EINPROGRESS) {
+                    ::close(fd);
+                    return -1;
+                }
+                connecting = true;
+            }
+            return fd;
+        }
+
+
+        int listenNonBlocking(const std::string& host, const uint16_t port, uint16_t& boundPort) {
+            auto address = sockaddr_in{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            if(inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+                return -1;
+            }
+
+            auto fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if(fd < 0) {
+                return -1;
+            }
+            auto reuse = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+                ::close(fd);
+                return -1;
+            }
+
+            auto length = socklen_t{sizeof(address)};
+            getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+            boundPort = ntohs(address.sin_port);
+            return fd;
+        }
+    }
+}
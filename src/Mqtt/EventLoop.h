@@ -0,0 +1,109 @@
+#ifndef __MQTT_EVENTLOOP_H__
+#define __MQTT_EVENTLOOP_H__
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "MqttPacket.h"
+
+namespace Rovi {
+    namespace Mqtt {
+        using Clock = std::chrono::steady_clock;
+
+        // Single threaded event loop on top of Linux epoll
+        // Handlers are registered with their file descriptor and get called for every readiness event.
+        // After each iteration all handlers get a tick with the current time, e.g. for keepalive timeouts.
+        class EventLoop {
+            public:
+                class Handler {
+                    public:
+                        virtual ~Handler() = default;
+
+                        virtual void handleEvents(const uint32_t events) = 0;
+                        virtual void handleTick(const Clock::time_point /*now*/) {}
+                        // The loop does not sleep past the earliest deadline of all handlers
+                        virtual Clock::time_point nextDeadline() const { return Clock::time_point::max(); }
+                };
+
+                EventLoop();
+                ~EventLoop();
+                EventLoop(const EventLoop&) = delete;
+                EventLoop& operator=(const EventLoop&) = delete;
+
+                bool add(const int fd, const uint32_t events, Handler* handler);
+                bool modify(const int fd, const uint32_t events, Handler* handler);
+                void remove(const int fd, Handler* handler);
+
+                // Wait at most 'timeout' for events and dispatch them. Returns the number of dispatched events.
+                int runOnce(const std::chrono::milliseconds timeout = std::chrono::milliseconds{100});
+                // Run until stop() is called
+                void run();
+                void stop() { m_running = false; }
+
+            protected:
+                int m_epollFD;
+                bool m_running;
+                std::vector<Handler*> m_handlers;
+                std::vector<Handler*> m_removedHandlers;
+        };
+
+
+        // Non-blocking stream socket speaking MQTT
+        // Outgoing data is written directly with writev() as long as the socket accepts it. Only the part that
+        // could not be written (partial write, EAGAIN) is copied into the pending buffer and flushed on EPOLLOUT.
+        // Incoming data is collected until complete packets can be decoded and passed to packetReceived().
+        class Connection : public EventLoop::Handler {
+            public:
+                explicit Connection(EventLoop& loop);
+                virtual ~Connection();
+                Connection(const Connection&) = delete;
+                Connection& operator=(const Connection&) = delete;
+
+                bool isOpen() const { return m_fd >= 0; }
+                int fd() const { return m_fd; }
+
+                bool send(const iovec* iovecs, const size_t count);
+                bool send(const std::vector<uint8_t>& packet);
+                // Bytes waiting for the socket to become writable
+                size_t pendingBytes() const { return m_outbound.size() - m_outboundOffset; }
+
+                // Shut down the sending side after all pending data is written and close when the peer
+                // closes, too. Closing right away would reset the connection if there is unread inbound data.
+                void closeAfterFlush();
+                void close();
+
+                void handleEvents(const uint32_t events) override;
+
+            protected:
+                // Take ownership of a socket. 'connecting' is set for a non-blocking connect() in progress.
+                bool attach(const int fd, const bool connecting);
+
+                virtual void packetReceived(const PacketView& packet) = 0;
+                virtual void connectionEstablished() {}
+                virtual void connectionClosed() {}
+
+                void flush();
+                void receive();
+                void updateEvents();
+
+                EventLoop& m_loop;
+                int m_fd;
+                bool m_connecting;
+                bool m_closeAfterFlush;
+                bool m_writeInterest;
+                std::vector<uint8_t> m_outbound;
+                size_t m_outboundOffset;
+                std::vector<uint8_t> m_inbound;
+                Clock::time_point m_lastSent;
+        };
+
+        // Helpers for sockets on the loopback interface (IPv4, numeric addresses only)
+        int connectNonBlocking(const std::string& host, const uint16_t port, bool& connecting);
+        int listenNonBlocking(const std::string& host, const uint16_t port, uint16_t& boundPort);
+    }
+}
+
+#endif /* __MQTT_EVENTLOOP_H__ */
@@ -0,0 +1,152 @@
+#include "FakeBroker.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <algorithm>
+
+namespace Rovi {
+    namespace Mqtt {
+        FakeBroker::FakeBroker(EventLoop& loop)
+            : m_loop(loop), m_fd{-1}, m_port{0}, m_sessions{}, m_publishHandler{}, m_respondToPing{true},
+              m_receivedMessages{0}, m_pingRequests{0}
+        {}
+
+
+        FakeBroker::~FakeBroker() {
+            m_sessions.clear();
+            if(m_fd >= 0) {
+                m_loop.remove(m_fd, this);
+                ::close(m_fd);
+            }
+        }
+
+
+        bool FakeBroker::listen(const std::string& host, const uint16_t port) {
+            m_fd = listenNonBlocking(host, port, m_port);
+            if(m_fd < 0) {
+                return false;
+            }
+            return m_loop.add(m_fd, EPOLLIN, this);
+        }
+
+
+        void FakeBroker::publish(std::string_view topic, std::string_view payload) {
+            auto packet = encodePublish(topic, payload);
+            for(auto& session : m_sessions) {
+                if(session->isOpen() && session->subscribed(topic)) {
+                    session->send(packet);
+                }
+            }
+        }
+
+
+        size_t FakeBroker::sessionCount() const {
+            return static_cast<size_t>(std::count_if(m_sessions.begin(), m_sessions.end(),
+                [](const std::unique_ptr<Session>& session) { return session->isOpen(); }));
+        }
+
+
+        size_t FakeBroker::subscriptionCount() const {
+            auto count = size_t{0};
+            for(auto& session : m_sessions) {
+                count += session->subscriptionCount();
+            }
+            return count;
+        }
+
+
+        void FakeBroker::handleEvents(const uint32_t /*events*/) {
+            while(true) {
+                auto fd = accept4(m_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if(fd < 0) {
+                    break;          // EAGAIN
+                }
+                auto noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                m_sessions.push_back(std::make_unique<Session>(m_loop, *this, fd));
+            }
+        }
+
+
+        void FakeBroker::handleTick(const Clock::time_point /*now*/) {
+            m_sessions.erase(std::remove_if(m_sessions.begin(), m_sessions.end(),
+                [](const std::unique_ptr<Session>& session) { return !session->isOpen(); }), m_sessions.end());
+        }
+
+
+        //*******************************************************************//
+        // Session
+        //*******************************************************************//
+        FakeBroker::Session::Session(EventLoop& loop, FakeBroker& broker, const int fd)
+            : Connection(loop), m_broker(broker), m_topicFilters{}
+        {
+            attach(fd, false);
+        }
+
+
+        bool FakeBroker::Session::subscribed(std::string_view topic) const {
+            return std::any_of(m_topicFilters.begin(), m_topicFilters.end(),
+                [topic](const std::string& filter) { return topicMatches(filter, topic); });
+        }
+
+
+        void FakeBroker::Session::packetReceived(const PacketView& packet) {
+            switch(packet.type) {
+                case PacketType::connect: {
+                    auto connect = ConnectView{};
+                    if(!decodeConnect(packet, connect)) {
+                        close();
+                        return;
+                    }
+                    // Return code 1: Unacceptable protocol version
+                    send(encodeConnack(false, connect.protocolLevel == 4 ? 0 : 1));
+                    break;
+                }
+                case PacketType::publish: {
+                    auto publish = PublishView{};
+                    if(!decodePublish(packet, publish)) {
+                        close();
+                        return;
+                    }
+                    ++m_broker.m_receivedMessages;
+                    if(publish.qos == QoS::atLeastOnce) {
+                        send(encodePuback(publish.packetID));
+                    }
+                    if(m_broker.m_publishHandler) {
+                        m_broker.m_publishHandler(publish);
+                    }
+                    break;
+                }
+                case PacketType::subscribe: {
+                    auto packetID = uint16_t{0};
+                    auto topicFilters = std::vector<std::pair<std::string_view, QoS>>{};
+                    if(!decodeSubscribe(packet, packetID, topicFilters)) {
+                        close();
+                        return;
+                    }
+                    // Granted QoS is always 0
+                    for(auto& topicFilter : topicFilters) {
+                        m_topicFilters.emplace_back(topicFilter.first);
+                    }
+                    send(encodeSuback(packetID, std::vector<uint8_t>(topicFilters.size(), 0)));
+                    break;
+                }
+                case PacketType::pingreq:
+                    ++m_broker.m_pingRequests;
+                    if(m_broker.m_respondToPing) {
+                        send(encodePingresp());
+                    }
+                    break;
+                case PacketType::disconnect:
+                    close();
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef __MQTT_FAKEBROKER_H__
+#define __MQTT_FAKEBROKER_H__
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <vector>
+#include <functional>
+
+#include "EventLoop.h"
+#include "MqttPacket.h"
+
+namespace Rovi {
+    namespace Mqtt {
+        // Minimal in-process MQTT broker for tests and benchmarks
+        // Accepts connections on the loopback interface and runs on the same event loop as the clients.
+        // CONNECT, SUBSCRIBE and PINGREQ are acknowledged, PUBLISH packets are counted, passed to the publish
+        // handler and forwarded to matching subscriptions (QoS 0). No sessions, retained messages or last wills.
+        class FakeBroker : public EventLoop::Handler {
+            public:
+                using PublishHandler = std::function<void(const PublishView& publish)>;
+
+                explicit FakeBroker(EventLoop& loop);
+                ~FakeBroker();
+                FakeBroker(const FakeBroker&) = delete;
+                FakeBroker& operator=(const FakeBroker&) = delete;
+
+                // Port 0 selects a free port, s. port()
+                bool listen(const std::string& host = "127.0.0.1", const uint16_t port = 0);
+                uint16_t port() const { return m_port; }
+
+                void setPublishHandler(PublishHandler handler) { m_publishHandler = std::move(handler); }
+                // Answer PINGREQ packets (disable to test keepalive timeouts)
+                void setRespondToPing(const bool respond) { m_respondToPing = respond; }
+                // Send a message to all matching subscriptions, as if published by another client
+                void publish(std::string_view topic, std::string_view payload);
+
+                size_t sessionCount() const;
+                size_t subscriptionCount() const;
+                uint64_t receivedMessages() const { return m_receivedMessages; }
+                uint64_t pingRequests() const { return m_pingRequests; }
+
+                void handleEvents(const uint32_t events) override;
+                // Removes closed sessions
+                void handleTick(const Clock::time_point now) override;
+
+            protected:
+                class Session : public Connection {
+                    public:
+                        Session(EventLoop& loop, FakeBroker& broker, const int fd);
+
+                        bool subscribed(std::string_view topic) const;
+                        size_t subscriptionCount() const { return m_topicFilters.size(); }
+
+                    protected:
+                        void packetReceived(const PacketView& packet) override;
+
+                        FakeBroker& m_broker;
+                        std::vector<std::string> m_topicFilters;
+                };
+
+                EventLoop& m_loop;
+                int m_fd;
+                uint16_t m_port;
+                std::vector<std::unique_ptr<Session>> m_sessions;
+                PublishHandler m_publishHandler;
+                bool m_respondToPing;
+                uint64_t m_receivedMessages;
+                uint64_t m_pingRequests;
+        };
+    }
+}
+
+#endif /* __MQTT_FAKEBROKER_H__ */
@@ -0,0 +1,253 @@
+#include "MqttClient.h"
+
+#include <iostream>
+
+namespace Rovi {
+    namespace Mqtt {
+        MqttClient::MqttClient(EventLoop& loop, const ConnectOptions& options)
+            : Connection(loop), m_options{options}, m_state{State::disconnected}, m_disconnecting{false},
+              m_devices{}, m_router{}, m_buffer{}, m_batch{}, m_pingOutstanding{false}, m_pingSent{}, m_packetID{0}, m_statistics{}
+        {}
+
+
+        bool MqttClient::connect(const std::string& host, const uint16_t port) {
+            if(m_state != State::disconnected) {
+                return false;
+            }
+            auto connectPacket = encodeConnect(m_options);
+            if(connectPacket.empty()) {
+                std::cerr << "Invalid connect options for client " << m_options.clientID << std::endl;
+                return false;
+            }
+            auto connecting = false;
+            auto fd = connectNonBlocking(host, port, connecting);
+            if(fd < 0 || !attach(fd, connecting)) {
+                std::cerr << "Failed to connect to " << host << ":" << port << std::endl;
+                return false;
+            }
+            m_state = State::connecting;
+            m_disconnecting = false;
+            m_pingOutstanding = false;
+
+            // Pipelined: Everything is queued behind the CONNECT without waiting for the CONNACK
+            send(connectPacket);
+            auto devices = std::vector<std::shared_ptr<Homie::Device>>{};
+            devices.reserve(m_devices.size());
+            for(auto& device : m_devices) {
+                initializeDevice(*device.second);
+                devices.push_back(device.second);
+            }
+            subscribe(devices);
+            return isOpen();
+        }
+
+
+        void MqttClient::disconnect() {
+            if(m_state == State::disconnected) {
+                return;
+            }
+            m_buffer.clear();
+            for(auto& device : m_devices) {
+                device.second->setState(Homie::Device::State::disconnected);
+                device.second->appendAttribute(m_buffer, Homie::Device::Attributes::state);
+            }
+            sendBatch();
+            send(encodeDisconnect());
+            m_disconnecting = true;
+            closeAfterFlush();
+        }
+
+
+        void MqttClient::addDevice(const std::shared_ptr<Homie::Device>& device) {
+            m_devices[device->deviceID()->id()] = device;
+            // The device is kept alive by m_devices
+            m_router.add(device->baseTopic().path() + "/#", [raw = device.get()](std::string_view topic, std::string_view payload) {
+                raw->messageReceived(topic, payload);
+            });
+            if(m_state != State::disconnected) {
+                initializeDevice(*device);
+                subscribe({device});
+            }
+        }
+
+
+        std::shared_ptr<Homie::Device> MqttClient::device(std::string_view deviceID) const {
+            auto it = m_devices.find(deviceID);
+            return it != m_devices.end() ? it->second : nullptr;
+        }
+
+
+        bool MqttClient::publish(const Homie::AttributeBuffer& buffer, const QoS qos, const bool retain) {
+            if(m_state == State::disconnected) {
+                return false;
+            }
+            m_batch.clear();
+            auto encoded = size_t{0};
+            if(qos == QoS::atMostOnce) {
+                encoded = m_batch.encode(buffer, qos, retain);
+            } else {
+                encoded = m_batch.encode(buffer, qos, retain, nextPacketID());
+                for(size_t i = 1; i < encoded; ++i) {
+                    nextPacketID();
+                }
+            }
+            if(encoded < buffer.size()) {
+                std::cerr << "Dropped " << buffer.size() - encoded << " attributes too large for a PUBLISH packet" << std::endl;
+            }
+            auto& iovecs = m_batch.iovecs();
+            m_statistics.publishedMessages += m_batch.size();
+            m_statistics.publishedBytes += m_batch.bytes();
+            return send(iovecs.data(), iovecs.size()) && encoded == buffer.size();
+        }
+
+
+        bool MqttClient::publish(std::string_view topic, std::string_view payload, const QoS qos, const bool retain) {
+            if(m_state == State::disconnected) {
+                return false;
+            }
+            m_batch.clear();
+            m_batch.append(topic, payload, qos, retain, qos == QoS::atMostOnce ? 0 : nextPacketID());
+            auto& iovecs = m_batch.iovecs();
+            m_statistics.publishedMessages += m_batch.size();
+            m_statistics.publishedBytes += m_batch.bytes();
+            return send(iovecs.data(), iovecs.size());
+        }
+
+
+        bool MqttClient::publishUpdate(Homie::Device& device) {
+            m_buffer.clear();
+            device.update(m_buffer);
+            return sendBatch();
+        }
+
+
+        bool MqttClient::publishUpdates() {
+            m_buffer.clear();
+            for(auto& device : m_devices) {
+                device.second->update(m_buffer);
+            }
+            return sendBatch();
+        }
+
+
+        void MqttClient::handleTick(const Clock::time_point now) {
+            if(m_state != State::connected || m_options.keepAlive_s == 0) {
+                return;
+            }
+            auto keepAlive = std::chrono::seconds{m_options.keepAlive_s};
+            if(m_pingOutstanding) {
+                if(now - m_pingSent >= keepAlive) {
+                    std::cerr << "No PINGRESP from broker, closing connection" << std::endl;
+                    close();
+                }
+            } else if(now - m_lastSent >= keepAlive) {
+                m_pingOutstanding = true;
+                m_pingSent = now;
+                ++m_statistics.pingRequests;
+                send(encodePingreq());
+            }
+        }
+
+
+        Clock::time_point MqttClient::nextDeadline() const {
+            if(m_state != State::connected || m_options.keepAlive_s == 0) {
+                return Clock::time_point::max();
+            }
+            auto keepAlive = std::chrono::seconds{m_options.keepAlive_s};
+            return m_pingOutstanding ? m_pingSent + keepAlive : m_lastSent + keepAlive;
+        }
+
+
+        void MqttClient::packetReceived(const PacketView& packet) {
+            switch(packet.type) {
+                case PacketType::connack: {
+                    auto sessionPresent = false;
+                    auto returnCode = uint8_t{0};
+                    if(!decodeConnack(packet, sessionPresent, returnCode) || returnCode != 0) {
+                        std::cerr << "Connection refused by broker (return code " << static_cast<int>(returnCode) << ")" << std::endl;
+                        close();
+                        return;
+                    }
+                    m_state = State::connected;
+                    break;
+                }
+                case PacketType::publish: {
+                    auto publish = PublishView{};
+                    if(!decodePublish(packet, publish)) {
+                        close();
+                        return;
+                    }
+                    ++m_statistics.receivedMessages;
+                    if(publish.qos == QoS::atLeastOnce) {
+                        send(encodePuback(publish.packetID));
+                    }
+                    m_router.dispatch(publish.topic, publish.payload);
+                    break;
+                }
+                case PacketType::pingresp:
+                    m_pingOutstanding = false;
+                    break;
+                case PacketType::suback:
+                case PacketType::puback:
+                    break;
+                default:
+                    std::cerr << "Unexpected packet type " << static_cast<int>(packet.type) << std::endl;
+                    close();
+                    break;
+            }
+        }
+
+
+        void MqttClient::connectionClosed() {
+            m_state = State::disconnected;
+            m_pingOutstanding = false;
+            // Only the local state of the devices changes. A connection has a single last will, i.e. on unexpected
+            // disconnects the broker publishes $state = lost only for the will topic in ConnectOptions, the retained
+            // $state of all other devices stays at ready.
+            auto state = m_disconnecting ? Homie::Device::State::disconnected : Homie::Device::State::lost;
+            for(auto& device : m_devices) {
+                device.second->setState(state);
+            }
+            m_disconnecting = false;
+        }
+
+
+        void MqttClient::initializeDevice(Homie::Device& device) {
+            m_buffer.clear();
+            device.connectionInitialized(m_buffer);
+            sendBatch();
+        }
+
+
+        void MqttClient::subscribe(const std::vector<std::shared_ptr<Homie::Device>>& devices) {
+            if(devices.empty()) {
+                return;
+            }
+            auto topicFilters = std::vector<std::pair<std::string, QoS>>{};
+            topicFilters.reserve(devices.size());
+            for(auto& device : devices) {
+                topicFilters.emplace_back(device->baseTopic().path() + "/+/+/set", QoS::atMostOnce);
+            }
+            auto packet = encodeSubscribe(nextPacketID(), topicFilters);
+            if(packet.empty()) {
+                std::cerr << "Failed to encode the subscription of " << devices.size() << " devices" << std::endl;
+                return;
+            }
+            send(packet);
+        }
+
+
+        bool MqttClient::sendBatch() {
+            return publish(m_buffer, QoS::atMostOnce, true);
+        }
+
+
+        uint16_t MqttClient::nextPacketID() {
+            // Packet identifiers must be non-zero
+            if(++m_packetID == 0) {
+                ++m_packetID;
+            }
+            return m_packetID;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef __MQTT_CLIENT_H__
+#define __MQTT_CLIENT_H__
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <map>
+
+#include "EventLoop.h"
+#include "MqttPacket.h"
+#include "Device.h"
+#include "TopicRouter.h"
+
+namespace Rovi {
+    namespace Mqtt {
+        // Non-blocking MQTT client sharing one broker connection between many devices
+        // After the CONNECT all devices publish their attributes (Device::connectionInitialized()) and subscribe
+        // to homie/<device-id>/+/+/set. Packets are pipelined, i.e. sent without waiting for the CONNACK.
+        // Inbound PUBLISH packets are dispatched by a TopicRouter: Every device has the route homie/<device-id>/#, which
+        // calls Device::messageReceived(). More specific routes, e.g. for a single property, can be added via router().
+        // QoS 1 publishes are sent once, there is no retransmission of unacknowledged packets.
+        // MQTT allows one last will per connection: If the connection is lost, the broker only publishes $state = lost
+        // for the will topic in ConnectOptions (e.g. of the gateway device), not for every device of the client.
+        class MqttClient : public Connection {
+            public:
+                enum class State {
+                    disconnected,
+                    connecting,
+                    connected
+                };
+
+                struct Statistics {
+                    uint64_t publishedMessages = 0;
+                    uint64_t publishedBytes = 0;
+                    uint64_t receivedMessages = 0;
+                    uint64_t pingRequests = 0;
+                };
+
+                MqttClient(EventLoop& loop, const ConnectOptions& options);
+
+                bool connect(const std::string& host, const uint16_t port);
+                // Publish $state = disconnected for all devices and close the connection after a DISCONNECT
+                void disconnect();
+
+                void addDevice(const std::shared_ptr<Homie::Device>& device);
+                std::shared_ptr<Homie::Device> device(std::string_view deviceID) const;
+                size_t deviceCount() const { return m_devices.size(); }
+                Homie::TopicRouter& router() { return m_router; }
+
+                // Returns false, if sending failed or attributes were too large for a PUBLISH packet (the others are sent)
+                bool publish(const Homie::AttributeBuffer& buffer, const QoS qos = QoS::atMostOnce, const bool retain = true);
+                bool publish(std::string_view topic, std::string_view payload, const QoS qos = QoS::atMostOnce, const bool retain = true);
+                // Stats of a single device (Device::update())
+                bool publishUpdate(Homie::Device& device);
+                // Stats of all devices in a single batch
+                bool publishUpdates();
+
+                State state() const { return m_state; }
+                const Statistics& statistics() const { return m_statistics; }
+
+                // Keepalive: PINGREQ after 'keepAlive' without outgoing packets, close if there is no PINGRESP within 'keepAlive'
+                void handleTick(const Clock::time_point now) override;
+                Clock::time_point nextDeadline() const override;
+
+            protected:
+                void packetReceived(const PacketView& packet) override;
+                void connectionClosed() override;
+
+                void initializeDevice(Homie::Device& device);
+                void subscribe(const std::vector<std::shared_ptr<Homie::Device>>& devices);
+                bool sendBatch();
+                uint16_t nextPacketID();
+
+                ConnectOptions m_options;
+                State m_state;
+                bool m_disconnecting;
+                std::map<std::string, std::shared_ptr<Homie::Device>, std::less<>> m_devices;
+                Homie::TopicRouter m_router;
+                // Reused for every publication
+                Homie::AttributeBuffer m_buffer;
+                PublishBatch m_batch;
+                bool m_pingOutstanding;
+                Clock::time_point m_pingSent;
+                uint16_t m_packetID;
+                Statistics m_statistics;
+        };
+    }
+}
+
+#endif /* __MQTT_CLIENT_H__ */
@@ -0,0 +1,478 @@
+#include "MqttPacket.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace Rovi {
+    namespace Mqtt {
+        namespace {
+            void appendUint16(std::vector<uint8_t>& buffer, const uint16_t value) {
+                buffer.push_back(static_cast<uint8_t>(value >> 8));
+                buffer.push_back(static_cast<uint8_t>(value & 0xFF));
+            }
+
+            // Returns false if the string does not fit the 16 bit length prefix
+            bool appendString(std::vector<uint8_t>& buffer, std::string_view str) {
+                if(str.size() > 0xFFFF) {
+                    return false;
+                }
+                appendUint16(buffer, static_cast<uint16_t>(str.size()));
+                buffer.insert(buffer.end(), str.begin(), str.end());
+                return true;
+            }
+
+            // Prepend the fixed header to an encoded variable header and payload
+            // Returns an empty buffer if the body exceeds the maximum remaining length
+            std::vector<uint8_t> packet(const PacketType type, const uint8_t flags, const std::vector<uint8_t>& body) {
+                if(body.size() > maxRemainingLength) {
+                    return {};
+                }
+                uint8_t remainingLength[4];
+                auto length = encodeRemainingLength(remainingLength, body.size());
+                auto buffer = std::vector<uint8_t>{};
+                buffer.reserve(1 + length + body.size());
+                buffer.push_back(static_cast<uint8_t>((static_cast<uint8_t>(type) << 4) | (flags & 0x0F)));
+                buffer.insert(buffer.end(), remainingLength, remainingLength + length);
+                buffer.insert(buffer.end(), body.begin(), body.end());
+                return buffer;
+            }
+
+            // Packet identifiers must be non-zero
+            uint16_t nextPacketID(const uint16_t packetID) {
+                return packetID == 0xFFFF ? 1 : static_cast<uint16_t>(packetID + 1);
+            }
+
+            // Sequential reader for the body of a packet
+            class Reader {
+                public:
+                    explicit Reader(std::string_view data) : m_data{data}, m_pos{0}, m_ok{true} {}
+
+                    uint8_t byte() {
+                        if(m_pos + 1 > m_data.size()) {
+                            m_ok = false;
+                            return 0;
+                        }
+                        return static_cast<uint8_t>(m_data[m_pos++]);
+                    }
+                    uint16_t uint16() {
+                        auto msb = byte();
+                        auto lsb = byte();
+                        return static_cast<uint16_t>((msb << 8) | lsb);
+                    }
+                    std::string_view string() {
+                        auto length = uint16();
+                        return bytes(length);
+                    }
+                    std::string_view bytes(const size_t length) {
+                        if(!m_ok || m_pos + length > m_data.size()) {
+                            m_ok = false;
+                            return {};
+                        }
+                        auto view = m_data.substr(m_pos, length);
+                        m_pos += length;
+                        return view;
+                    }
+                    std::string_view rest() {
+                        return bytes(m_data.size() - std::min(m_pos, m_data.size()));
+                    }
+                    bool atEnd() const { return m_pos >= m_data.size(); }
+                    bool ok() const { return m_ok; }
+
+                private:
+                    std::string_view m_data;
+                    size_t m_pos;
+                    bool m_ok;
+            };
+        }
+
+
+        bool topicMatches(std::string_view filter, std::string_view topic) {
+            // Topics starting with '$' are not matched by wildcards at the first level
+            if(!topic.empty() && topic[0] == '$' && !filter.empty() && (filter[0] == '+' || filter[0] == '#')) {
+                return false;
+            }
+            auto f = size_t{0};
+            auto t = size_t{0};
+            while(true) {
+                // 'a/#' matches 'a' as well
+                if(filter.substr(f) == "#") {
+                    return true;
+                }
+                if(t > topic.size()) {
+                    return false;
+                }
+                auto filterEnd = std::min(filter.find('/', f), filter.size());
+                auto topicEnd = std::min(topic.find('/', t), topic.size());
+                auto level = filter.substr(f, filterEnd - f);
+                if(level != "+" && level != topic.substr(t, topicEnd - t)) {
+                    return false;
+                }
+                if(filterEnd == filter.size()) {
+                    return topicEnd == topic.size();
+                }
+                f = filterEnd + 1;
+                t = topicEnd + 1;
+            }
+        }
+
+
+        size_t encodeRemainingLength(uint8_t* buffer, size_t length) {
+            auto pos = size_t{0};
+            do {
+                auto encodedByte = static_cast<uint8_t>(length % 128);
+                length /= 128;
+                if(length > 0) {
+                    encodedByte |= 0x80;
+                }
+                buffer[pos++] = encodedByte;
+            } while(length > 0 && pos < 4);
+            return pos;
+        }
+
+
+        //*******************************************************************//
+        // Encoder
+        //*******************************************************************//
+        std::vector<uint8_t> encodeConnect(const ConnectOptions& options) {
+            // The password flag requires the username flag (MQTT-3.1.2-22)
+            if(!options.password.empty() && options.username.empty()) {
+                return {};
+            }
+            auto body = std::vector<uint8_t>{};
+            appendString(body, "MQTT");
+            body.push_back(4);          // Protocol level 3.1.1
+
+            auto flags = uint8_t{0};
+            if(options.cleanSession) {
+                flags |= 0x02;
+            }
+            if(!options.willTopic.empty()) {
+                flags |= 0x04;
+                flags |= static_cast<uint8_t>(static_cast<uint8_t>(options.willQoS) << 3);
+                if(options.willRetain) {
+                    flags |= 0x20;
+                }
+            }
+            if(!options.password.empty()) {
+                flags |= 0x40;
+            }
+            if(!options.username.empty()) {
+                flags |= 0x80;
+            }
+            body.push_back(flags);
+            appendUint16(body, options.keepAlive_s);
+
+            auto valid = appendString(body, options.clientID);
+            if(!options.willTopic.empty()) {
+                valid = valid && appendString(body, options.willTopic) && appendString(body, options.willPayload);
+            }
+            if(!options.username.empty()) {
+                valid = valid && appendString(body, options.username);
+            }
+            if(!options.password.empty()) {
+                valid = valid && appendString(body, options.password);
+            }
+            if(!valid) {
+                return {};
+            }
+            return packet(PacketType::connect, 0, body);
+        }
+
+
+        std::vector<uint8_t> encodeSubscribe(const uint16_t packetID, const std::vector<std::pair<std::string, QoS>>& topicFilters) {
+            auto body = std::vector<uint8_t>{};
+            appendUint16(body, packetID);
+            for(auto& topicFilter : topicFilters) {
+                if(!appendString(body, topicFilter.first)) {
+                    return {};
+                }
+                body.push_back(static_cast<uint8_t>(topicFilter.second));
+            }
+            return packet(PacketType::subscribe, 0x02, body);        // Reserved flags are 0010
+        }
+
+
+        std::vector<uint8_t> encodePublish(std::string_view topic, std::string_view payload, const QoS qos,
+            const bool retain, const uint16_t packetID)
+        {
+            auto batch = PublishBatch{};
+            auto buffer = std::vector<uint8_t>{};
+            if(!batch.append(topic, payload, qos, retain, packetID)) {
+                return buffer;
+            }
+            buffer.reserve(batch.bytes());
+            for(auto& vec : batch.iovecs()) {
+                auto data = static_cast<const uint8_t*>(vec.iov_base);
+                buffer.insert(buffer.end(), data, data + vec.iov_len);
+            }
+            return buffer;
+        }
+
+
+        std::vector<uint8_t> encodePuback(const uint16_t packetID) {
+            auto body = std::vector<uint8_t>{};
+            appendUint16(body, packetID);
+            return packet(PacketType::puback, 0, body);
+        }
+
+
+        std::vector<uint8_t> encodePingreq() {
+            return packet(PacketType::pingreq, 0, {});
+        }
+
+
+        std::vector<uint8_t> encodeDisconnect() {
+            return packet(PacketType::disconnect, 0, {});
+        }
+
+
+        std::vector<uint8_t> encodeConnack(const bool sessionPresent, const uint8_t returnCode) {
+            return packet(PacketType::connack, 0, {static_cast<uint8_t>(sessionPresent ? 1 : 0), returnCode});
+        }
+
+
+        std::vector<uint8_t> encodeSuback(const uint16_t packetID, const std::vector<uint8_t>& returnCodes) {
+            auto body = std::vector<uint8_t>{};
+            appendUint16(body, packetID);
+            body.insert(body.end(), returnCodes.begin(), returnCodes.end());
+            return packet(PacketType::suback, 0, body);
+        }
+
+
+        std::vector<uint8_t> encodePingresp() {
+            return packet(PacketType::pingresp, 0, {});
+        }
+
+
+        //*******************************************************************//
+        // PublishBatch
+        //*******************************************************************//
+        size_t PublishBatch::encode(const Homie::AttributeBuffer& buffer, const QoS qos, const bool retain, const uint16_t firstPacketID) {
+            m_headers.reserve(m_headers.size() + buffer.size());
+            auto packetID = firstPacketID;
+            auto appended = size_t{0};
+            for(size_t i = 0; i < buffer.size(); ++i) {
+                if(append(buffer.topic(i), buffer.payload(i), qos, retain && buffer.retained(i), packetID)) {
+                    packetID = nextPacketID(packetID);
+                    ++appended;
+                }
+            }
+            return appended;
+        }
+
+
+        size_t PublishBatch::encode(const std::vector<Homie::AttributeType>& attributes, const QoS qos, const bool retain, const uint16_t firstPacketID) {
+            m_headers.reserve(m_headers.size() + attributes.size());
+            auto packetID = firstPacketID;
+            auto appended = size_t{0};
+            for(auto& attribute : attributes) {
+                if(append(attribute.first.path(), attribute.second, qos, retain, packetID)) {
+                    packetID = nextPacketID(packetID);
+                    ++appended;
+                }
+            }
+            return appended;
+        }
+
+
+        bool PublishBatch::append(std::string_view topic, std::string_view payload, const QoS qos, const bool retain, const uint16_t packetID) {
+            auto hasPacketID = qos != QoS::atMostOnce;
+            auto remainingLength = 2 + topic.size() + (hasPacketID ? 2 : 0) + payload.size();
+            if(topic.size() > 0xFFFF || remainingLength > maxRemainingLength) {
+                return false;
+            }
+
+            auto header = Header{};
+            auto& data = header.data;
+            auto pos = size_t{0};
+            data[pos++] = static_cast<uint8_t>((static_cast<uint8_t>(PacketType::publish) << 4) |
+                (static_cast<uint8_t>(qos) << 1) | (retain ? 1 : 0));
+            pos += encodeRemainingLength(data.data() + pos, remainingLength);
+            data[pos++] = static_cast<uint8_t>(topic.size() >> 8);
+            data[pos++] = static_cast<uint8_t>(topic.size() & 0xFF);
+            header.length = static_cast<uint8_t>(pos);
+            // The packet identifier follows the topic. It is stored behind the header and gets its own iovec.
+            data[pos] = static_cast<uint8_t>(packetID >> 8);
+            data[pos + 1] = static_cast<uint8_t>(packetID & 0xFF);
+            header.hasPacketID = hasPacketID;
+            m_headers.push_back(header);
+
+            // Topic and payload are referenced in place, the header iovecs are resolved in iovecs()
+            m_iovecs.push_back(iovec{nullptr, 0});
+            m_iovecs.push_back(iovec{const_cast<char*>(topic.data()), topic.size()});
+            if(hasPacketID) {
+                m_iovecs.push_back(iovec{nullptr, 0});
+            }
+            m_iovecs.push_back(iovec{const_cast<char*>(payload.data()), payload.size()});
+            m_bytes += header.length + remainingLength - 2;
+            return true;
+        }
+
+
+        const std::vector<iovec>& PublishBatch::iovecs() {
+            auto i = size_t{0};
+            for(auto& header : m_headers) {
+                m_iovecs[i] = iovec{header.data.data(), header.length};
+                i += 2;             // Header and topic
+                if(header.hasPacketID) {
+                    m_iovecs[i++] = iovec{header.data.data() + header.length, 2};
+                }
+                ++i;                // Payload
+            }
+            return m_iovecs;
+        }
+
+
+        bool writeAll(const int fd, const iovec* iovecs, const size_t count) {
+            auto vecs = std::vector<iovec>(iovecs, iovecs + count);
+            auto current = vecs.data();
+            auto remaining = vecs.size();
+            while(remaining > 0) {
+                auto chunk = static_cast<int>(std::min<size_t>(remaining, IOV_MAX));
+                auto written = writev(fd, current, chunk);
+                if(written < 0) {
+                    if(errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                // Skip completely written iovecs and adjust a partially written one
+                auto bytes = static_cast<size_t>(written);
+                while(remaining > 0 && bytes >= current->iov_len) {
+                    bytes -= current->iov_len;
+                    ++current;
+                    --remaining;
+                }
+                if(remaining > 0) {
+                    current->iov_base = static_cast<char*>(current->iov_base) + bytes;
+                    current->iov_len -= bytes;
+                }
+            }
+            return true;
+        }
+
+
+        bool writeAll(const int fd, const std::vector<uint8_t>& packet) {
+            auto vec = iovec{const_cast<uint8_t*>(packet.data()), packet.size()};
+            return writeAll(fd, &vec, 1);
+        }
+
+
+        //*******************************************************************//
+        // Decoder
+        //*******************************************************************//
+        DecodeResult decodePacket(const uint8_t* data, const size_t size, PacketView& packet, size_t& consumed) {
+            if(size < 2) {
+                return DecodeResult::incomplete;
+            }
+            auto type = static_cast<uint8_t>(data[0] >> 4);
+            if(type == 0 || type == 15) {
+                return DecodeResult::malformed;
+            }
+
+            auto remainingLength = size_t{0};
+            auto multiplier = size_t{1};
+            auto pos = size_t{1};
+            while(true) {
+                if(pos >= size) {
+                    return DecodeResult::incomplete;
+                }
+                if(pos > 4) {
+                    return DecodeResult::malformed;
+                }
+                auto encodedByte = data[pos++];
+                remainingLength += (encodedByte & 0x7F) * multiplier;
+                multiplier *= 128;
+                if((encodedByte & 0x80) == 0) {
+                    break;
+                }
+            }
+            if(size - pos < remainingLength) {
+                return DecodeResult::incomplete;
+            }
+
+            packet.type = static_cast<PacketType>(type);
+            packet.flags = static_cast<uint8_t>(data[0] & 0x0F);
+            packet.body = std::string_view{reinterpret_cast<const char*>(data + pos), remainingLength};
+            consumed = pos + remainingLength;
+            return DecodeResult::complete;
+        }
+
+
+        bool decodePublish(const PacketView& packet, PublishView& publish) {
+            if(packet.type != PacketType::publish) {
+                return false;
+            }
+            auto qos = static_cast<uint8_t>((packet.flags >> 1) & 0x03);
+            if(qos > 2) {
+                return false;
+            }
+            auto reader = Reader{packet.body};
+            publish.topic = reader.string();
+            publish.qos = static_cast<QoS>(qos);
+            publish.retain = (packet.flags & 0x01) != 0;
+            publish.duplicate = (packet.flags & 0x08) != 0;
+            publish.packetID = qos > 0 ? reader.uint16() : 0;
+            publish.payload = reader.rest();
+            return reader.ok();
+        }
+
+
+        bool decodeConnect(const PacketView& packet, ConnectView& connect) {
+            if(packet.type != PacketType::connect) {
+                return false;
+            }
+            auto reader = Reader{packet.body};
+            connect.protocolName = reader.string();
+            connect.protocolLevel = reader.byte();
+            connect.flags = reader.byte();
+            connect.keepAlive_s = reader.uint16();
+            connect.clientID = reader.string();
+            return reader.ok();
+        }
+
+
+        bool decodeConnack(const PacketView& packet, bool& sessionPresent, uint8_t& returnCode) {
+            if(packet.type != PacketType::connack || packet.body.size() != 2) {
+                return false;
+            }
+            auto reader = Reader{packet.body};
+            sessionPresent = (reader.byte() & 0x01) != 0;
+            returnCode = reader.byte();
+            return reader.ok();
+        }
+
+
+        bool decodeSubscribe(const PacketView& packet, uint16_t& packetID, std::vector<std::pair<std::string_view, QoS>>& topicFilters) {
+            if(packet.type != PacketType::subscribe) {
+                return false;
+            }
+            auto reader = Reader{packet.body};
+            packetID = reader.uint16();
+            topicFilters.clear();
+            while(reader.ok() && !reader.atEnd()) {
+                auto topicFilter = reader.string();
+                auto qos = reader.byte();
+                if(qos > 2) {
+                    return false;
+                }
+                topicFilters.emplace_back(topicFilter, static_cast<QoS>(qos));
+            }
+            return reader.ok() && !topicFilters.empty();
+        }
+
+
+        bool decodeSuback(const PacketView& packet, uint16_t& packetID, std::vector<uint8_t>& returnCodes) {
+            if(packet.type != PacketType::suback) {
+                return false;
+            }
+            auto reader = Reader{packet.body};
+            packetID = reader.uint16();
+            auto codes = reader.rest();
+            returnCodes.assign(codes.begin(), codes.end());
+            return reader.ok();
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#ifndef __MQTT_PACKET_H__
+#define __MQTT_PACKET_H__
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+
+#include "HomieHelper.h"
+
+namespace Rovi {
+    namespace Mqtt {
+        // MQTT 3.1.1 (http://docs.oasis-open.org/mqtt/mqtt/v3.1.1/mqtt-v3.1.1.html)
+        enum class PacketType : uint8_t {
+            connect = 1,
+            connack = 2,
+            publish = 3,
+            puback = 4,
+            subscribe = 8,
+            suback = 9,
+            pingreq = 12,
+            pingresp = 13,
+            disconnect = 14
+        };
+
+        enum class QoS : uint8_t {
+            atMostOnce = 0,
+            atLeastOnce = 1,
+            exactlyOnce = 2
+        };
+
+        // Largest value of the variable length 'remaining length' field (4 bytes)
+        constexpr size_t maxRemainingLength = 268435455;
+        // Fixed header (1 byte) + remaining length (4 bytes) + topic length (2 bytes) + packet identifier (2 bytes)
+        constexpr size_t maxPublishHeaderLength = 9;
+
+        // True if 'topic' matches the subscription 'filter' including the wildcards '+' (single level) and '#' (multi level)
+        bool topicMatches(std::string_view filter, std::string_view topic);
+
+        // Write the remaining length into buffer (at least 4 bytes). Returns the number of bytes written.
+        size_t encodeRemainingLength(uint8_t* buffer, size_t length);
+
+
+        //*******************************************************************//
+        // Encoder
+        //*******************************************************************//
+        struct ConnectOptions {
+            std::string clientID;
+            uint16_t keepAlive_s = 60;
+            bool cleanSession = true;
+            std::string username;
+            std::string password;
+            // Last will, e.g. homie/<device-id>/$state -> lost
+            std::string willTopic;
+            std::string willPayload;
+            QoS willQoS = QoS::atLeastOnce;
+            bool willRetain = true;
+        };
+
+        // The encoders return an empty buffer, if a string exceeds 65535 bytes or the packet exceeds the maximum
+        // remaining length. encodeConnect() also fails, if a password is set without a username.
+        std::vector<uint8_t> encodeConnect(const ConnectOptions& options);
+        std::vector<uint8_t> encodeSubscribe(const uint16_t packetID, const std::vector<std::pair<std::string, QoS>>& topicFilters);
+        // Single PUBLISH packet in one buffer. Prefer PublishBatch for many messages.
+        std::vector<uint8_t> encodePublish(std::string_view topic, std::string_view payload, const QoS qos = QoS::atMostOnce,
+            const bool retain = false, const uint16_t packetID = 0);
+        std::vector<uint8_t> encodePuback(const uint16_t packetID);
+        std::vector<uint8_t> encodePingreq();
+        std::vector<uint8_t> encodeDisconnect();
+        // Packets sent by a broker. Only required for testing and fake brokers.
+        std::vector<uint8_t> encodeConnack(const bool sessionPresent, const uint8_t returnCode);
+        std::vector<uint8_t> encodeSuback(const uint16_t packetID, const std::vector<uint8_t>& returnCodes);
+        std::vector<uint8_t> encodePingresp();
+
+        // Scatter-gather PUBLISH encoder for a whole batch of attributes
+        // Only the packet headers (fixed header, remaining length and topic length) are written by the encoder.
+        // Topics and payloads are referenced in place, so each message consists of three iovecs
+        // (header, topic, payload; plus the packet identifier for QoS > 0) and a batch can be sent with a single writev().
+        // The referenced AttributeBuffer/attributes have to outlive the iovecs. QoS 1/2 packets get consecutive
+        // packet identifiers starting at 'firstPacketID'. Records of an AttributeBuffer that are not retained (values of
+        // properties with $retained = false) are sent without the retain flag, even if 'retain' is set.
+        class PublishBatch {
+            public:
+                void clear() { m_headers.clear(); m_iovecs.clear(); m_bytes = 0; }
+
+                // Returns the number of appended messages. Messages too large for a PUBLISH packet are left out and do
+                // not use up a packet identifier, i.e. the identifiers of the appended messages stay consecutive.
+                size_t encode(const Homie::AttributeBuffer& buffer, const QoS qos = QoS::atMostOnce, const bool retain = true,
+                    const uint16_t firstPacketID = 1);
+                size_t encode(const std::vector<Homie::AttributeType>& attributes, const QoS qos = QoS::atMostOnce, const bool retain = true,
+                    const uint16_t firstPacketID = 1);
+                // Append a single message. Returns false if the message is too large for a PUBLISH packet.
+                bool append(std::string_view topic, std::string_view payload, const QoS qos, const bool retain, const uint16_t packetID);
+
+                size_t size() const { return m_headers.size(); }
+                bool empty() const { return m_headers.empty(); }
+                // Total number of bytes of all packets
+                size_t bytes() const { return m_bytes; }
+                // Valid until the next call of a non-const method
+                const std::vector<iovec>& iovecs();
+
+            protected:
+                struct Header {
+                    std::array<uint8_t, maxPublishHeaderLength> data;
+                    uint8_t length;         // Without the packet identifier
+                    bool hasPacketID;
+                };
+
+                std::vector<Header> m_headers;
+                // Header iovecs are resolved lazily, because m_headers may be reallocated while appending
+                std::vector<iovec> m_iovecs;
+                size_t m_bytes = 0;
+        };
+
+        // Write all iovecs to a (blocking) file descriptor, handling partial writes and IOV_MAX.
+        // Returns false on error (errno is set by writev).
+        bool writeAll(const int fd, const iovec* iovecs, const size_t count);
+        bool writeAll(const int fd, const std::vector<uint8_t>& packet);
+
+
+        //*******************************************************************//
+        // Decoder
+        //*******************************************************************//
+        // View on a complete packet. 'body' points into the decoded data (variable header and payload).
+        struct PacketView {
+            PacketType type;
+            uint8_t flags;
+            std::string_view body;
+        };
+
+        enum class DecodeResult {
+            complete,
+            incomplete,
+            malformed
+        };
+
+        // Decode the next packet from [data, data + size). On DecodeResult::complete 'consumed' contains
+        // the size of the whole packet, so the caller can remove it from its receive buffer.
+        DecodeResult decodePacket(const uint8_t* data, const size_t size, PacketView& packet, size_t& consumed);
+
+        struct PublishView {
+            std::string_view topic;
+            std::string_view payload;
+            QoS qos;
+            bool retain;
+            bool duplicate;
+            uint16_t packetID;
+        };
+
+        struct ConnectView {
+            std::string_view protocolName;
+            uint8_t protocolLevel;
+            uint8_t flags;
+            uint16_t keepAlive_s;
+            std::string_view clientID;
+        };
+
+        bool decodePublish(const PacketView& packet, PublishView& publish);
+        bool decodeConnect(const PacketView& packet, ConnectView& connect);
+        bool decodeConnack(const PacketView& packet, bool& sessionPresent, uint8_t& returnCode);
+        bool decodeSubscribe(const PacketView& packet, uint16_t& packetID, std::vector<std::pair<std::string_view, QoS>>& topicFilters);
+        bool decodeSuback(const PacketView& packet, uint16_t& packetID, std::vector<uint8_t>& returnCodes);
+    }
+}
+
+#endif /* __MQTT_PACKET_H__ */
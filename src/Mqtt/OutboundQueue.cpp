@@ -0,0 +1,90 @@
+#include "OutboundQueue.h"
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <iostream>
+
+namespace Rovi {
+    namespace Mqtt {
+        OutboundQueue::OutboundQueue(EventLoop& loop, MqttClient& client, const size_t capacity, const size_t maxBatch)
+            : m_loop{loop}, m_client{client}, m_queue{capacity}, m_maxBatch{maxBatch},
+              m_eventFD{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}, m_wakeupPending{false}, m_batches{0}, m_buffer{}
+        {
+            if(m_eventFD < 0 || !m_loop.add(m_eventFD, EPOLLIN, this)) {
+                std::cerr << "Failed to create the eventfd of the outbound queue" << std::endl;
+            }
+        }
+
+        OutboundQueue::OutboundQueue(EventLoop& loop, MqttClient& client)
+            : OutboundQueue(loop, client, 4096, 256) {
+        }
+
+        OutboundQueue::~OutboundQueue() {
+            if(m_eventFD >= 0) {
+                m_loop.remove(m_eventFD, this);
+                ::close(m_eventFD);
+            }
+        }
+
+
+        bool OutboundQueue::push(std::string topic, std::string payload) {
+            if(!m_queue.emplace(Record{std::move(topic), std::move(payload), true})) {
+                return false;
+            }
+            wakeup();
+            return true;
+        }
+
+
+        size_t OutboundQueue::push(const Homie::AttributeBuffer& buffer) {
+            auto pushed = size_t{0};
+            for(size_t i = 0; i < buffer.size(); ++i) {
+                if(m_queue.emplace(Record{std::string{buffer.topic(i)}, std::string{buffer.payload(i)}, buffer.retained(i)})) {
+                    ++pushed;
+                }
+            }
+            if(pushed > 0) {
+                wakeup();
+            }
+            return pushed;
+        }
+
+
+        void OutboundQueue::handleEvents(const uint32_t) {
+            auto counter = uint64_t{0};
+            while(read(m_eventFD, &counter, sizeof(counter)) == sizeof(counter)) {
+            }
+            // Cleared before draining: Records pushed after the last drain below wake the loop again.
+            // Store-load ordering with wakeup(): Without the fences the drain could miss a record while the producer
+            // still reads m_wakeupPending == true, and the record would stay in the queue until the next push.
+            m_wakeupPending.store(false);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            while(true) {
+                m_buffer.clear();
+                auto count = m_queue.drain([this](Record& record) {
+                    m_buffer.appendPath(record.topic, record.payload, record.retained);
+                }, m_maxBatch);
+                if(count == 0) {
+                    break;
+                }
+                // Records are dropped, if the client is not connected
+                m_client.publish(m_buffer);
+                m_batches.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+
+        void OutboundQueue::wakeup() {
+            // Orders the enqueue before the check of m_wakeupPending (s. handleEvents())
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(!m_wakeupPending.exchange(true)) {
+                auto one = uint64_t{1};
+                if(write(m_eventFD, &one, sizeof(one)) != sizeof(one)) {
+                    std::cerr << "Failed to wake up the event loop" << std::endl;
+                }
+            }
+        }
+    }
+}
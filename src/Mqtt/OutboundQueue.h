@@ -0,0 +1,64 @@
+#ifndef __MQTT_OUTBOUNDQUEUE_H__
+#define __MQTT_OUTBOUNDQUEUE_H__
+
+#include <atomic>
+#include <string>
+
+#include "EventLoop.h"
+#include "MqttClient.h"
+#include "HomieHelper.h"
+#include "Utils/MpscQueue.h"
+
+namespace Rovi {
+    namespace Mqtt {
+        // Hands attributes from any thread to the MqttClient running in the event loop thread
+        // Producers (application threads setting property values, a stats scheduler, ...) push records into a
+        // lock-free MpscQueue without taking a mutex. The loop thread is the single consumer: It drains the queue
+        // in batches of up to 'maxBatch' records into one AttributeBuffer and publishes each batch with a single
+        // MqttClient::publish().
+        // The loop is woken up through an eventfd. Only the first push() after the loop started draining writes
+        // to it, so a burst of records costs one system call.
+        class OutboundQueue : public EventLoop::Handler {
+            public:
+                struct Record {
+                    std::string topic;
+                    std::string payload;
+                    bool retained;
+                };
+                using Statistics = MpscQueue<Record>::Statistics;
+
+                OutboundQueue(EventLoop& loop, MqttClient& client, const size_t capacity, const size_t maxBatch);
+                OutboundQueue(EventLoop& loop, MqttClient& client);
+                ~OutboundQueue();
+                OutboundQueue(const OutboundQueue&) = delete;
+                OutboundQueue& operator=(const OutboundQueue&) = delete;
+
+                // Any thread. Return false, if the queue is full (the record is dropped).
+                bool push(std::string topic, std::string payload);
+                // All records of a buffer, e.g. filled by Device::update(buffer) on a worker thread.
+                // Returns the number of pushed records.
+                size_t push(const Homie::AttributeBuffer& buffer);
+
+                Statistics statistics() const { return m_queue.statistics(); }
+                // Number of publish() calls of the loop thread
+                uint64_t batches() const { return m_batches.load(std::memory_order_relaxed); }
+
+                void handleEvents(const uint32_t events) override;
+
+            protected:
+                void wakeup();
+
+                EventLoop& m_loop;
+                MqttClient& m_client;
+                MpscQueue<Record> m_queue;
+                size_t m_maxBatch;
+                int m_eventFD;
+                std::atomic<bool> m_wakeupPending;
+                std::atomic<uint64_t> m_batches;
+                // Reused for every batch, only used by the loop thread
+                Homie::AttributeBuffer m_buffer;
+        };
+    }
+}
+
+#endif /* __MQTT_OUTBOUNDQUEUE_H__ */
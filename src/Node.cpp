@@ -1,11 +1,15 @@
 #include "Node.h"
 
+#include <array>
+
 #include "Utils/StringUtils.h"
 
 namespace Rovi {
     namespace Homie {
         Node::Node(const std::string& name, const std::string type, const size_t arraySize)
-            : m_nodeID{std::make_shared<TopicID>(nameToID(name))}, m_name(name), m_type(type), m_arraySize(arraySize) {
+            : m_nodeID{std::make_shared<TopicID>(nameToID(name))}, m_name(name), m_type(type), m_arraySize(arraySize),
+              m_properties{}, m_published{false}, m_propertiesChanged{false}, m_device{nullptr},
+              m_baseTopic{"undefinded-device"} {
             }
 
         Node::Node(const std::string& name, const std::string type)
@@ -13,19 +17,9 @@ namespace Rovi {
             }
 
 
-        void Node::setDevice(const std::shared_ptr<Device> device) {
-            std::cout << "Set device " << device->value(Device::Attributes::name) << " for node " << m_name << std::endl;
-            m_device = device;
-            // TODO: Test adding
-
-            if(m_device->node(m_nodeID->toString()) == nullptr) {
-                m_device->addNode(shared_from_this());
-            }
-        }
-
-
-        std::shared_ptr<Device> Node::device() const {
-            return m_device;
+        void Node::setDevice(Device& device) {
+            m_device = &device;
+            m_baseTopic = TopicType{m_device->baseTopic(), TopicType{m_nodeID->toString()}};
         }
 
 
@@ -34,60 +28,59 @@ namespace Rovi {
         }
 
 
-        TopicType Node::topic(const Attributes& attribute) const {
-            auto ret = TopicType{};
-            switch (attribute)
-            {
-                case Attributes::nodeID:
-                    ret.emplace_back("");       // TODO
-                    break;                                      
-                case Attributes::name:
-                    ret.emplace_back("$name");
-                    break;                    
-                case Attributes::type:
-                    ret.emplace_back("$type");
-                    break;                    
-                case Attributes::properties:
-                    ret.emplace_back("$properties");
-                    break;                    
-                case Attributes::array:
-                    ret.emplace_back("$array");
-                    break;                                     
-                default:
-                    break;
-            }
+        void Node::appendAttribute(AttributeBuffer& buffer, const Attributes& attribute) const {
+            buffer.appendPayload(m_baseTopic, topic(attribute), [this, &attribute](auto& data) {
+                writeValue(attribute, data);
+            });
+        }
+
 
-            return ret;
+        const TopicType& Node::topic(const Attributes& attribute) const {
+            // Indexed by Attributes
+            static const auto topics = std::array<TopicType, 5>{
+                TopicType{""},          // TODO: nodeID
+                TopicType{"$name"},
+                TopicType{"$type"},
+                TopicType{"$properties"},
+                TopicType{"$array"}
+            };
+            return topics[static_cast<size_t>(attribute)];
         }
 
 
         ValueType Node::value(const Attributes& attribute) const {
             auto str = ValueType{};
+            writeValue(attribute, str);
+            return str;
+        }
+
+
+        template<typename String>
+        void Node::writeValue(const Attributes& attribute, String& str) const {
             switch (attribute)
             {
                 case Attributes::nodeID:
-                    str = m_nodeID->toString();
+                    str += m_nodeID->toString();
                     break;                                  
                 case Attributes::name:
-                    str = m_name;
+                    str += m_name;
                     break;                    
                 case Attributes::type:
-                    str = m_type;
+                    str += m_type;
                     break;                    
                 case Attributes::properties:
-                    str = "Not implemented yet!";
+                    str += m_properties.ids();
                     break;                    
                 case Attributes::array:
-                    str = "0";
+                    str += '0';
                     if(isArray()) {
-                        str += "-" + StringUtils::toString(m_arraySize - 1);
+                        str += '-';
+                        StringUtils::appendNumber(str, m_arraySize - 1);
                     }
                     break;                
                 default:
                     break;
             }
-
-            return str;
         }
 
 
@@ -96,16 +89,62 @@ namespace Rovi {
         }
 
 
-        AttributeType Node::nodeAttribute(const TopicType& topic, const ValueType& value) const {
-            // TODO: Testen
-            auto deviceTopicPath = TopicType{};
+        PropertyTable::Index Node::addProperty(const PropertyDefinition& definition) {
+            auto property = m_properties.add(definition);
+            if(property == PropertyTable::invalidIndex) {
+                return property;
+            }
+            m_propertiesChanged = true;
             if(m_device != nullptr) {
-                deviceTopicPath = TopicType{std::string{"homie"}, m_device->deviceID()->toString(), m_nodeID->toString()};
-            } else {
-                deviceTopicPath = TopicType{"undefinded-device"};
+                // $properties changed
+                m_device->snapshotChanged();
             }
-            deviceTopicPath.insert(deviceTopicPath.end(), topic.begin(), topic.end());
-            return make_pair(deviceTopicPath, value);
+            return property;
+        }
+
+
+        bool Node::setProperty(std::string_view propertyID, std::string_view payload) {
+            auto property = m_properties.find(propertyID);
+            return property != PropertyTable::invalidIndex && m_properties.settable(property)
+                && m_properties.setPayload(property, payload);
+        }
+
+
+        void Node::connectionInitialized(AttributeBuffer& buffer) {
+            appendAttribute(buffer, Attributes::name);
+            appendAttribute(buffer, Attributes::type);
+            appendAttribute(buffer, Attributes::properties);
+            if(isArray()) {
+                appendAttribute(buffer, Attributes::array);
+            }
+            m_properties.appendAttributes(buffer, m_baseTopic);
+            m_properties.appendValues(buffer, m_baseTopic);
+            m_properties.clearChanged();
+            m_published = true;
+            m_propertiesChanged = false;
+        }
+
+
+        void Node::update(AttributeBuffer& buffer) {
+            if(!m_published) {
+                connectionInitialized(buffer);
+                return;
+            }
+            if(m_propertiesChanged) {
+                appendAttribute(buffer, Attributes::properties);
+                m_properties.appendAttributes(buffer, m_baseTopic);
+                m_properties.appendValues(buffer, m_baseTopic);
+                m_properties.clearChanged();
+                m_propertiesChanged = false;
+                return;
+            }
+            m_properties.appendChangedValues(buffer, m_baseTopic);
+        }
+
+
+        AttributeType Node::nodeAttribute(const TopicType& topic, const ValueType& value) const {
+            // TODO: Testen
+            return make_pair(TopicType{m_baseTopic, topic}, value);
         }
 
         std::string Node::nameToID(const std::string& topic) const {
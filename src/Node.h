@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include "HomieHelper.h"
+#include "Property.h"
 #include "Device.h"
 
 namespace Rovi {
@@ -16,7 +17,9 @@ namespace Rovi {
         class HWInfo;
         class Device;
 
-        class Node : public std::enable_shared_from_this<Node> {
+        // Nodes are usually created and owned by a device (s. Device::addNode()). A node created on its own is not
+        // attached to any device.
+        class Node {
             public:
                 enum class Attributes {
                     nodeID,
@@ -29,26 +32,60 @@ namespace Rovi {
                 Node(const std::string& name, const std::string type, const size_t arraySize);
                 Node(const std::string& name, const std::string type);
 
-                void setDevice(const std::shared_ptr<Device> device);
-                std::shared_ptr<Device> device() const;
+                // <node-id>
+                const std::string& id() const { return m_nodeID->toString(); }
+                // Owning device, nullptr if the node is not attached
+                Device* device() const { return m_device; }
+                // homie/<device-id>/<node-id>
+                const TopicType& baseTopic() const { return m_baseTopic; };
 
                 AttributeType attribute(const Attributes& attribute) const;
-                TopicType topic(const Attributes& attribute) const;
+                void appendAttribute(AttributeBuffer& buffer, const Attributes& attribute) const;
+                // Relative to the base topic, e.g. $name
+                const TopicType& topic(const Attributes& attribute) const;
                 ValueType value(const Attributes& attribute) const;
 
                 bool isArray() const;
+                size_t arraySize() const { return m_arraySize; }
+
+                // Returns PropertyTable::invalidIndex, if the property ID exists already or the format is invalid
+                PropertyTable::Index addProperty(const PropertyDefinition& definition);
+                PropertyTable& properties() { return m_properties; }
+                const PropertyTable& properties() const { return m_properties; }
+                // Stores the payload of <node>/<property>/set. Returns false, if the property is unknown, not
+                // settable or the payload is invalid.
+                bool setProperty(std::string_view propertyID, std::string_view payload);
+
+                // $name, $type, $properties, $array (array nodes only) and the attributes and values of all properties
+                void connectionInitialized(AttributeBuffer& buffer);
+                // Values of the properties changed since the last call. A node which has not been published yet (i.e.
+                // added to a connected device) publishes everything like connectionInitialized(). If properties have
+                // been added, $properties and all property attributes are published again.
+                void update(AttributeBuffer& buffer);
+                // True once connectionInitialized() or update() published the node
+                bool published() const { return m_published; }
 
             protected:
+                friend class Device;
+                // Called by Device::addNode(), the device outlives the node
+                void setDevice(Device& device);
+
                 AttributeType nodeAttribute(const TopicType& topic, const ValueType& value) const;
+                // Append the value to 'str' (std::string or std::pmr::string)
+                template<typename String>
+                void writeValue(const Attributes& attribute, String& str) const;
                 std::string nameToID(const std::string& topic) const;
 
                 std::shared_ptr<TopicID> m_nodeID;
                 std::string m_name;
                 std::string m_type;
-                // TODO: Properties
                 size_t m_arraySize;
+                PropertyTable m_properties;
+                bool m_published;
+                bool m_propertiesChanged;
 
-                std::shared_ptr<Device> m_device;
+                Device* m_device;
+                TopicType m_baseTopic;
         };
     }
 }
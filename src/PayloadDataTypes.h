@@ -3,11 +3,17 @@
 
 #include <stdlib.h>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <set>
+#include <vector>
+#include <limits>
+#include <ostream>
+#include <string.h>
 #include <algorithm>
 #include <type_traits>
 
+#include "PayloadFormats.h"
 #include "Utils/StringUtils.h"
 // #include "Log.h"
 
@@ -48,16 +54,20 @@ namespace Rovi {
                 return setValue(payload.value());
             }
             bool setValue(const std::string& value) {
-                auto isValid = validate(value);
+                return setValue(std::string_view{value});
+            }
+            bool setValue(std::string_view value) {
+                auto parsedValue = ValueType{};
+                auto isValid = parseValue(value, parsedValue);
                 if(isValid) {
-                    m_value = valueFromString(value);
+                    m_value = std::move(parsedValue);
                     m_valid = true;
                 }
                 return isValid;
             }
             // Required!!! Otherwise Boolean.setValue("some string") will call the Boolean.setValue(bool) which is not intendent!
             bool setValue(const char* value) {
-                return setValue(std::string{value});
+                return setValue(std::string_view{value});
             }
             // Delete all other overloadins to avoid implicit conversions
             // TODO: Find a better solution, current one deletes to much
@@ -76,12 +86,24 @@ namespace Rovi {
             }
 
         protected:
-            PayloadDatatype() : m_valid(false) {
+            PayloadDatatype() : m_value{}, m_valid(false) {
             }
 
             virtual PayloadDatatype::ValueType valueFromString(const std::string& payload) const = 0;
             virtual std::string valueToString(const PayloadDatatype::ValueType& value) const = 0;
 
+            // Validate the payload and convert it into 'value'. 'value' is only valid if true is returned.
+            // The default implementation validates first and converts afterwards. Types with a 
+            // single pass scanner (e.g. Integer, Float) override this method.
+            virtual bool parseValue(std::string_view payload, PayloadDatatype::ValueType& value) const {
+                auto payloadStr = std::string{payload};
+                auto isValid = validateValue(payloadStr);
+                if(isValid) {
+                    value = valueFromString(payloadStr);
+                }
+                return isValid;
+            }
+
             // s.o.
             template <typename = std::enable_if<std::is_same<T, std::string>::value == false>>
             bool validate(const T& value) const {
@@ -106,11 +128,16 @@ namespace Rovi {
             }
             virtual ~String(){};
 
+            // s. Format::String::parse()
             virtual bool validateValue(const std::string& value) const override {
-                return value.size() >= 0 && value.size() <= 268435456;;
+                return Format::String::isValid(value);
             }
 
         protected:
+            virtual bool parseValue(std::string_view payload, PayloadDatatype::ValueType& value) const override {
+                return Format::String::parse(payload.data(), payload.data() + payload.size(), value);
+            }
+
             virtual PayloadDatatype::ValueType valueFromString(const std::string& payload) const override {
                 return payload;
             }
@@ -132,23 +159,28 @@ namespace Rovi {
             virtual ~Integer(){};
 
             virtual bool validateValue(const std::string& value) const override {
-                bool isValid = true;
-                // isValid &= rangeCheck();                     // TODO: Is this possible at this point? What is returned by atoll?
-                isValid &= StringUtils::checkStringForAllowedCharacters(value, std::string("01234567890-"));    // The payload may only contain whole numbers and the negation character “-”. No other characters including spaces (” “) are permitted
-                isValid &= !(value == "-");                     // A string with just a negation sign (“-”) is not a m_valid payload
-                isValid &= !(value == "");                      // An empty string (“”) is not a m_valid payload
-                isValid &= (value.find_last_of("-") == 0 || value.find_last_of("-") == std::string::npos);
+                auto parsedValue = PayloadDatatype::ValueType{};
+                return parse(value.data(), value.data() + value.size(), parsedValue);
+            }
 
-                return isValid;
+            // s. Format::Integer::parse()
+            static bool parse(const char* begin, const char* end, PayloadDatatype::ValueType& value) {
+                return Format::Integer::parse(begin, end, value);
             }
 
          protected:
+            virtual bool parseValue(std::string_view payload, PayloadDatatype::ValueType& value) const override {
+                return parse(payload.data(), payload.data() + payload.size(), value);
+            }
+
            virtual PayloadDatatype::ValueType valueFromString(const std::string& payload) const override {
-                return atoll(payload.c_str());
+                auto value = PayloadDatatype::ValueType{0};
+                parse(payload.data(), payload.data() + payload.size(), value);
+                return value;
             }
 
             virtual std::string valueToString(const PayloadDatatype::ValueType& value) const override {
-                return StringUtils::toString(value);
+                return Format::Integer::toString(value);
             }       
         };
 
@@ -163,26 +195,28 @@ namespace Rovi {
             virtual ~Float(){};
 
             virtual bool validateValue(const std::string& value) const override {
-                bool isValid = true;
-                // isValid &= rangeCheck();                     // TODO: Is this possible at this point?
-                isValid &= StringUtils::checkStringForAllowedCharacters(value, std::string("01234567890-eE."));
-                isValid &= std::count(value.begin(), value.end(), '.') <= 1;                    // The dot character (“.”) is the decimal separator (used if necessary) and may only have a single instance present in the payload
-                isValid &= !(value == "-");                    // A string with just a negation sign (“-”) is not a m_valid payload
-                isValid &= !(value == "");                      // An empty string (“”) is not a m_valid payload
-                isValid &= !(value.find_last_of("E") == 0 || value.find_last_of("e") == 0 ||
-                            (value.find_last_of("-") ==  0 && (value.find_last_of("E") == 1 || value.find_last_of("e") == 1)));
+                auto parsedValue = PayloadDatatype::ValueType{};
+                return parse(value.data(), value.data() + value.size(), parsedValue);
+            }
 
-                return isValid;
+            // s. Format::Float::parse()
+            static bool parse(const char* begin, const char* end, PayloadDatatype::ValueType& value) {
+                return Format::Float::parse(begin, end, value);
             }
 
         protected:
+            virtual bool parseValue(std::string_view payload, PayloadDatatype::ValueType& value) const override {
+                return parse(payload.data(), payload.data() + payload.size(), value);
+            }
+
             virtual PayloadDatatype::ValueType valueFromString(const std::string& payload) const override {
-                return atof(payload.c_str());
+                auto value = PayloadDatatype::ValueType{0.0};
+                parse(payload.data(), payload.data() + payload.size(), value);
+                return value;
             }
 
             virtual std::string valueToString(const PayloadDatatype::ValueType& value) const override {
-                auto value_str = StringUtils::toString(value);
-                return StringUtils::removeCharsFromString(value_str, "+");
+                return Format::Float::toString(value);
             }       
         };
 
@@ -200,44 +234,156 @@ namespace Rovi {
             }
             virtual ~Boolean(){};
 
+            // s. Format::Boolean::parse()
             virtual bool validateValue(const std::string& value) const override {
-                bool isValid = true;
-                isValid &= (value == "true" || value == "false");           // Booleans must be converted to the string literals “true” or “false”
-                                                                            // Representation is case sensitive, e.g. “TRUE” or “FALSE” are not m_valid payloads.
-                                                                            // An empty string (“”) is not a m_valid payload
-                return isValid;
+                auto parsedValue = PayloadDatatype::ValueType{};
+                return Format::Boolean::parse(value.data(), value.data() + value.size(), parsedValue);
             }
 
          protected:
+            virtual bool parseValue(std::string_view payload, PayloadDatatype::ValueType& value) const override {
+                return Format::Boolean::parse(payload.data(), payload.data() + payload.size(), value);
+            }
+
            virtual PayloadDatatype::ValueType valueFromString(const std::string& payload) const override {
-                bool value;
-                if(payload == "true") {
-                    value = true;
-                } else {
-                    value = false;
-                }
+                auto value = PayloadDatatype::ValueType{false};
+                parseValue(payload, value);
                 return value;
             }
 
             virtual std::string valueToString(const PayloadDatatype::ValueType& value) const override {
-                std::string payload;
-                if(value == true) {
-                    payload = "true";
-                } else {
-                    payload = "false";
-                }
-                return payload;
+                return Format::Boolean::toString(value);
             }       
         };
 
-        class Enumeration : public PayloadDatatype<std::string> {
+        // Immutable lookup table for the values of an Enumeration
+        // All values are grouped by their length. Each group is stored as a flat array of fixed size records
+        // sorted by content, so a lookup is a length check followed by a binary search of memcmp()s without any allocation.
+        class EnumerationTable {
         public:
-            Enumeration(const std::set<std::string>& enumValues) : PayloadDatatype() {
+            using IndexType = uint32_t;
+            // Enum instead of a static constant, so it can be bound to references without an out of class definition
+            enum : IndexType { invalidIndex = std::numeric_limits<IndexType>::max() };
+
+            explicit EnumerationTable(const std::set<std::string>& enumValues) {
                 for(auto& value : enumValues) {
                     // Remove whitespace
-                    m_enumValues.insert(StringUtils::trim(value));
+                    m_values.emplace_back(StringUtils::trimView(value));
+                }
+                std::sort(m_values.begin(), m_values.end(), [](const std::string& lhs, const std::string& rhs) {
+                    return lhs.size() != rhs.size() ? lhs.size() < rhs.size() : lhs < rhs;
+                });
+                m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+
+                auto maxLength = m_values.empty() ? size_t{0} : m_values.back().size();
+                m_lengthOffsets.assign(maxLength + 2, 0);
+                m_charOffsets.assign(maxLength + 2, 0);
+                for(auto& value : m_values) {
+                    ++m_lengthOffsets[value.size() + 1];
+                    m_records += value;
+                }
+                for(size_t length = 1; length < m_lengthOffsets.size(); ++length) {
+                    m_charOffsets[length] = m_charOffsets[length - 1] + m_lengthOffsets[length] * (length - 1);
+                    m_lengthOffsets[length] += m_lengthOffsets[length - 1];
                 }
             }
+
+            // Index of the payload or invalidIndex if it is not part of the enumeration
+            IndexType find(std::string_view payload) const {
+                const auto length = payload.size();
+                if(length == 0 || length + 1 >= m_lengthOffsets.size()) {
+                    return invalidIndex;
+                }
+                auto first = m_lengthOffsets[length];
+                auto last = m_lengthOffsets[length + 1];
+                auto records = m_records.data() + m_charOffsets[length];
+                while(first < last) {
+                    auto mid = first + (last - first) / 2;
+                    auto cmp = memcmp(records + (mid - m_lengthOffsets[length]) * length, payload.data(), length);
+                    if(cmp == 0) {
+                        return mid;
+                    } else if(cmp < 0) {
+                        first = mid + 1;
+                    } else {
+                        last = mid;
+                    }
+                }
+                return invalidIndex;
+            }
+
+            // Value for an index. An empty string is returned for invalidIndex.
+            const std::string& value(const IndexType index) const {
+                return index < m_values.size() ? m_values[index] : emptyValue();
+            }
+
+            size_t size() const {
+                return m_values.size();
+            }
+
+            static const std::string& emptyValue() {
+                static const std::string empty{};
+                return empty;
+            }
+
+        protected:
+            std::vector<std::string> m_values;              // Sorted by length and content, the position is the index
+            std::vector<IndexType> m_lengthOffsets;         // Values with length l are [m_lengthOffsets[l], m_lengthOffsets[l + 1])
+            std::vector<size_t> m_charOffsets;              // Start of the records with length l in m_records
+            std::string m_records;                          // All values concatenated
+        };
+
+        // Compact enumeration value: Index into the EnumerationTable of its Enumeration. The string is resolved on demand.
+        // A value shares the table with its Enumeration, so it stays valid after the Enumeration is destroyed.
+        class EnumerationValue {
+        public:
+            using IndexType = EnumerationTable::IndexType;
+
+            EnumerationValue() : m_table{nullptr}, m_index{EnumerationTable::invalidIndex} {
+            }
+            EnumerationValue(std::shared_ptr<const EnumerationTable> table, const IndexType index) : m_table{std::move(table)}, m_index{index} {
+            }
+
+            IndexType index() const {
+                return m_index;
+            }
+            const std::string& toString() const {
+                return m_table != nullptr ? m_table->value(m_index) : EnumerationTable::emptyValue();
+            }
+            operator const std::string&() const {
+                return toString();
+            }
+
+            friend bool operator==(const EnumerationValue& lhs, const EnumerationValue& rhs) {
+                return (lhs.m_table == rhs.m_table && lhs.m_index == rhs.m_index) || lhs.toString() == rhs.toString();
+            }
+            friend bool operator!=(const EnumerationValue& lhs, const EnumerationValue& rhs) {
+                return !(lhs == rhs);
+            }
+            friend bool operator==(const EnumerationValue& lhs, const std::string& rhs) {
+                return lhs.toString() == rhs;
+            }
+            friend bool operator!=(const EnumerationValue& lhs, const std::string& rhs) {
+                return !(lhs == rhs);
+            }
+            friend bool operator==(const EnumerationValue& lhs, const char* rhs) {
+                return lhs.toString() == rhs;
+            }
+            friend bool operator!=(const EnumerationValue& lhs, const char* rhs) {
+                return !(lhs == rhs);
+            }
+            friend std::ostream& operator<<(std::ostream& os, const EnumerationValue& value) {
+                return os << value.toString();
+            }
+
+        protected:
+            std::shared_ptr<const EnumerationTable> m_table;
+            IndexType m_index;
+        };
+
+        class Enumeration : public PayloadDatatype<EnumerationValue> {
+        public:
+            Enumeration(const std::set<std::string>& enumValues) : PayloadDatatype(), m_table{std::make_shared<const EnumerationTable>(enumValues)} {
+            }
             virtual ~Enumeration(){};
 
             virtual bool validateValue(const std::string& payload) const override {
@@ -245,28 +391,36 @@ namespace Rovi {
                 // Enum payloads are case sensitive, e.g. “Car” will not match a format definition of “car”
                 // Payloads should have leading and trailing whitespace removed
                 // An empty string (“”) is not a m_valid payload
-                return payload.size() > 0 && m_enumValues.find(payload) != m_enumValues.end();
+                return m_table->find(payload) != EnumerationTable::invalidIndex;
+            }
+
+            const EnumerationTable& table() const {
+                return *m_table;
             }
 
         protected:
+            virtual bool parseValue(std::string_view payload, PayloadDatatype::ValueType& value) const override {
+                auto index = m_table->find(payload);
+                auto isValid = index != EnumerationTable::invalidIndex;
+                if(isValid) {
+                    value = EnumerationValue{m_table, index};
+                }
+                return isValid;
+            }
+
             virtual PayloadDatatype::ValueType valueFromString(const std::string& payload) const override {
-                return payload;
+                return EnumerationValue{m_table, m_table->find(payload)};
             }
 
             virtual std::string valueToString(const PayloadDatatype::ValueType& value) const override {
-                return value;
+                return value.toString();
             }   
 
-            std::set<std::string> m_enumValues; 
-        };
-
-        enum class ColorFormat {
-            RGB,
-            HSV
+            // Shared between copies, so values stay valid when an Enumeration is copied
+            std::shared_ptr<const EnumerationTable> m_table; 
         };
 
-        using ColorTuple = std::tuple<int64_t, int64_t, int64_t>;
-        class Color : public PayloadDatatype<std::tuple<int64_t, int64_t, int64_t>> {
+        class Color : public PayloadDatatype<ColorTuple> {
         public:
             Color(const ColorFormat format, const std::string& payload = "0,0,0") : PayloadDatatype(), m_format(format) {
                 setValue(payload); // TBD
@@ -276,58 +430,34 @@ namespace Rovi {
             }
             virtual ~Color(){};
 
+            // s. Format::Color::parse()
             virtual bool validateValue(const std::string& value) const override {
-                // Color payload validity varies depending on the property format definition of either “rgb” or “hsv”
-                // Both payload types contain comma separated whole numbers of differing restricted ranges
-                // The encoded string may only contain whole numbers and the comma character “,”, no other characters are permitted, including spaces (” “)
-                // Payloads for type “rgb” contains 3 comma separated values of numbers with a m_valid range between 0 and 255. e.g. 100,100,100
-                // Payloads for type “hsv” contains 3 comma separated values of numbers. The first number has a range of 0 to 360, the second and third numbers have a range of 0 to 100. e.g. 300,50,75
-                // An empty string (“”) is not a m_valid payload
-                bool isValid = true;
-                isValid &= (value.size() > 0 && value.size() <= 11);  // max "100,100,100" -> 11 chars
-                isValid &= StringUtils::checkStringForAllowedCharacters(value, std::string("01234567890,"));
-                isValid &= std::count(value.begin(), value.end(), ',') == 2;
-                isValid &= value.size() >= 5; // e.g. '1,2,3'
-                auto values = StringUtils::splitString(value, ',');
-                for(auto v : values) {
-                    isValid &= StringUtils::checkStringForAllowedCharacters(v, std::string("01234567890,"));
-                }
-                
-                // Return if string already is invalid. Otherwise, convertion will fail...
-                if(!isValid) {
-                    return isValid;
-                }
-                auto convValue = valueFromString(value);
+                auto parsedValue = PayloadDatatype::ValueType{};
+                return parseValue(value, parsedValue);
+            }
+
+        protected:
+            virtual bool parseValue(std::string_view payload, PayloadDatatype::ValueType& value) const override {
+                auto begin = payload.data();
+                auto end = payload.data() + payload.size();
                 switch(m_format) {
-                    case ColorFormat::RGB: {
-                        auto r = std::get<0>(convValue);
-                        auto g = std::get<1>(convValue);
-                        auto b = std::get<2>(convValue);
-                        isValid &= (r >= 0 && r <= 255);
-                        isValid &= (g >= 0 && g <= 255);
-                        isValid &= (b >= 0 && b <= 255); }
-                        break;
-                    case ColorFormat::HSV: {
-                        auto h = std::get<0>(convValue);
-                        auto s = std::get<1>(convValue);
-                        auto v = std::get<2>(convValue);
-                        isValid &= (h >= 0 && h <= 360);
-                        isValid &= (s >= 0 && s <= 100);
-                        isValid &= (v >= 0 && v <= 100); }
-                        break;
+                    case ColorFormat::RGB:
+                        return Format::Color<ColorFormat::RGB>::parse(begin, end, value);
+                    case ColorFormat::HSV:
+                        return Format::Color<ColorFormat::HSV>::parse(begin, end, value);
                 }
-
-                return isValid;
+                return false;
             }
 
-        protected:
            virtual PayloadDatatype::ValueType valueFromString(const std::string& payload) const override {
-                auto values = StringUtils::splitString(payload, ',');
-                return PayloadDatatype::ValueType{atoll(values[0].c_str()), atoll(values[1].c_str()), atoll(values[2].c_str())};
+                auto value = PayloadDatatype::ValueType{0, 0, 0};
+                parseValue(payload, value);
+                return value;
             }
 
             virtual std::string valueToString(const PayloadDatatype::ValueType& value) const override {
-                return StringUtils::toString(std::get<0>(value)) + "," + StringUtils::toString(std::get<1>(value)) + "," + StringUtils::toString(std::get<2>(value));
+                // Identical for all color formats
+                return Format::Color<ColorFormat::RGB>::toString(value);
             }    
 
             ColorFormat format() const {
@@ -0,0 +1,450 @@
+#ifndef ROVI_HOMIE_PAYLOAD_FORMATS_H
+#define ROVI_HOMIE_PAYLOAD_FORMATS_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+#include "Utils/StringUtils.h"
+
+namespace Rovi {
+    namespace  Homie {
+        enum class ColorFormat {
+            RGB,
+            HSV
+        };
+
+        using ColorTuple = std::tuple<int64_t, int64_t, int64_t>;
+
+        // Compile-time payload formats
+        // Every format is a stateless type providing
+        //   - ValueType
+        //   - static bool parse(const char* begin, const char* end, ValueType& value)  -> Validate and convert a payload
+        //   - static bool isValid(const ValueType& value)                               -> Check the range of a value
+        //   - static std::string toString(const ValueType& value)                       -> Convert a value into its payload
+        // All functions are static, so they can be inlined and no virtual call is involved.
+        // Formats with parameters (Color, Enumeration) carry them as template parameter.
+        namespace Format {
+            struct String {
+                using ValueType = std::string;
+
+                // String types are limited to 268,435,456 characters
+                // An empty string (“”) is a valid payload
+                static bool parse(const char* begin, const char* end, ValueType& value) {
+                    auto isValid = static_cast<size_t>(end - begin) <= maxLength;
+                    if(isValid) {
+                        value.assign(begin, end);
+                    }
+                    return isValid;
+                }
+
+                static bool isValid(const ValueType& value) {
+                    return value.size() <= maxLength;
+                }
+
+                static std::string toString(const ValueType& value) {
+                    return value;
+                }
+
+                static constexpr size_t maxLength = 268435456;
+            };
+
+            struct Integer {
+                using ValueType = int64_t;
+
+                // Validate and convert [begin, end) in a single pass
+                // The payload may only contain whole numbers and the negation character “-”. No other characters including spaces (” “) are permitted
+                // A string with just a negation sign (“-”) is not a valid payload
+                // An empty string (“”) is not a valid payload
+                // Integers range from -9,223,372,036,854,775,808 (-2^63) to 9,223,372,036,854,775,807 (2^63-1)
+                static bool parse(const char* begin, const char* end, ValueType& value) {
+                    auto it = begin;
+                    auto negative = (it != end && *it == '-');
+                    if(negative) {
+                        ++it;
+                    }
+                    if(it == end) {
+                        return false;
+                    }
+
+                    const auto limit = negative ? (uint64_t{1} << 63) : (uint64_t{1} << 63) - 1;
+                    auto magnitude = uint64_t{0};
+                    for(; it != end; ++it) {
+                        auto digit = static_cast<uint64_t>(static_cast<unsigned char>(*it)) - uint64_t{'0'};
+                        if(digit > 9) {
+                            return false;
+                        }
+                        if(magnitude > (limit - digit) / 10) {
+                            return false;           // Out of range
+                        }
+                        magnitude = magnitude * 10 + digit;
+                    }
+
+                    value = negative ? static_cast<ValueType>(uint64_t{0} - magnitude) : static_cast<ValueType>(magnitude);
+                    return true;
+                }
+
+                static bool isValid(const ValueType&) {
+                    return true;
+                }
+
+                static std::string toString(const ValueType& value) {
+                    return StringUtils::toString(value);
+                }
+            };
+
+            struct Float {
+                using ValueType = double;
+
+                // Validate and convert [begin, end) in a single pass
+                // Grammar: ["-"] (digits ["." [digits]] | "." digits) [("e" | "E") ["-"] digits]
+                // The dot character (“.”) is the decimal separator (used if necessary) and may only have a single instance present in the payload
+                // A string with just a negation sign (“-”) is not a valid payload
+                // An empty string (“”) is not a valid payload
+                // Values which overflow a 64-bit double are out of range
+                static bool parse(const char* begin, const char* end, ValueType& value) {
+                    auto toDigit = [](const char c) {
+                        return static_cast<uint32_t>(static_cast<unsigned char>(c)) - uint32_t{'0'};
+                    };
+                    // Up to 19 decimal digits always fit into the mantissa
+                    const auto maxMantissa = uint64_t{999999999999999999};
+                    auto mantissa = uint64_t{0};
+                    auto exponent = int64_t{0};
+                    auto hasDigits = false;
+                    auto isExact = true;
+                    auto accumulate = [&](const uint32_t digit) {
+                        hasDigits = true;
+                        if(mantissa <= maxMantissa) {
+                            mantissa = mantissa * 10 + digit;
+                            return true;
+                        }
+                        isExact = false;
+                        return false;
+                    };
+
+                    auto it = begin;
+                    auto negative = (it != end && *it == '-');
+                    if(negative) {
+                        ++it;
+                    }
+                    for(; it != end && toDigit(*it) <= 9; ++it) {
+                        if(!accumulate(toDigit(*it))) {
+                            ++exponent;             // Dropped integer digit
+                        }
+                    }
+                    if(it != end && *it == '.') {
+                        ++it;
+                        for(; it != end && toDigit(*it) <= 9; ++it) {
+                            if(accumulate(toDigit(*it))) {
+                                --exponent;
+                            }
+                        }
+                    }
+                    if(!hasDigits) {
+                        return false;
+                    }
+                    if(it != end && (*it == 'e' || *it == 'E')) {
+                        ++it;
+                        auto negativeExponent = (it != end && *it == '-');
+                        if(negativeExponent) {
+                            ++it;
+                        }
+                        if(it == end) {
+                            return false;
+                        }
+                        auto explicitExponent = int64_t{0};
+                        for(; it != end && toDigit(*it) <= 9; ++it) {
+                            if(explicitExponent < 100000) {
+                                explicitExponent = explicitExponent * 10 + toDigit(*it);
+                            }
+                        }
+                        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+                    }
+                    if(it != end) {
+                        return false;
+                    }
+
+                    // Fast path: Mantissa and power of ten are exactly representable, so a single
+                    // multiplication/division is correctly rounded (Clinger)
+                    static const double powersOf10[] = {
+                        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                    };
+                    if(isExact && mantissa <= (uint64_t{1} << 53) && exponent >= -22 && exponent <= 22) {
+                        auto result = static_cast<double>(mantissa);
+                        result = exponent < 0 ? result / powersOf10[-exponent] : result * powersOf10[exponent];
+                        value = negative ? -result : result;
+                        return true;
+                    }
+
+                    // Slow path: The payload has already been validated, so from_chars only has to do the conversion.
+                    // Unlike strtod it neither depends on the locale nor needs a null terminated copy.
+                    auto result = 0.0;
+                    auto conversion = std::from_chars(begin, end, result);
+                    if(conversion.ec == std::errc::result_out_of_range) {
+                        if(exponent > 0) {
+                            return false;       // Overflow
+                        }
+                        result = negative ? -0.0 : 0.0;     // Underflow
+                    } else if(conversion.ec != std::errc{} || conversion.ptr != end || std::isinf(result)) {
+                        return false;
+                    }
+                    value = result;
+                    return true;
+                }
+
+                // Representations of numeric concepts such as “NaN” (Not a Number) and “Infinity” are not a valid payload
+                static bool isValid(const ValueType& value) {
+                    return std::isfinite(value);
+                }
+
+                static std::string toString(const ValueType& value) {
+                    // Homie floats do not contain a '+', e.g. in the exponent ("2e+08" -> "2e08")
+                    char buffer[StringUtils::maxNumberLength];
+                    auto length = StringUtils::formatNumber(buffer, sizeof(buffer), value);
+                    auto end = std::remove(buffer, buffer + length, '+');
+                    return std::string(buffer, end);
+                }
+            };
+
+            struct Boolean {
+                using ValueType = bool;
+
+                // Booleans must be converted to the string literals “true” or “false”
+                // Representation is case sensitive, e.g. “TRUE” or “FALSE” are not valid payloads.
+                // An empty string (“”) is not a valid payload
+                static bool parse(const char* begin, const char* end, ValueType& value) {
+                    auto length = static_cast<size_t>(end - begin);
+                    if(length == 4 && memcmp(begin, "true", 4) == 0) {
+                        value = true;
+                        return true;
+                    }
+                    if(length == 5 && memcmp(begin, "false", 5) == 0) {
+                        value = false;
+                        return true;
+                    }
+                    return false;
+                }
+
+                static bool isValid(const ValueType&) {
+                    return true;
+                }
+
+                static std::string toString(const ValueType& value) {
+                    return value ? "true" : "false";
+                }
+            };
+
+            // 'Values' has to provide a static array 'values' of null terminated strings containing
+            // all allowed (trimmed) values, e.g.
+            //   struct CarColors { static const char* const values[]; };
+            //   const char* const CarColors::values[] = {"Red", "Green", "Blue"};
+            template<typename Values>
+            struct Enumeration {
+                using ValueType = std::string;
+
+                // Enum payloads must be one of the values specified in the format definition of the property
+                // Enum payloads are case sensitive, e.g. “Car” will not match a format definition of “car”
+                // An empty string (“”) is not a valid payload
+                static bool parse(const char* begin, const char* end, ValueType& value) {
+                    auto isValid = contains(begin, static_cast<size_t>(end - begin));
+                    if(isValid) {
+                        value.assign(begin, end);
+                    }
+                    return isValid;
+                }
+
+                static bool isValid(const ValueType& value) {
+                    return contains(value.data(), value.size());
+                }
+
+                static std::string toString(const ValueType& value) {
+                    return value;
+                }
+
+            private:
+                static bool contains(const char* payload, const size_t length) {
+                    if(length == 0) {
+                        return false;
+                    }
+                    for(auto& allowed : Values::values) {
+                        if(strlen(allowed) == length && memcmp(allowed, payload, length) == 0) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+            };
+
+            template<ColorFormat F>
+            struct Color {
+                using ValueType = ColorTuple;
+
+                // Color payload validity varies depending on the property format definition of either “rgb” or “hsv”
+                // Both payload types contain comma separated whole numbers of differing restricted ranges
+                // The encoded string may only contain whole numbers and the comma character “,”, no other characters are permitted, including spaces (” “)
+                // Payloads for type “rgb” contains 3 comma separated values of numbers with a valid range between 0 and 255. e.g. 100,100,100
+                // Payloads for type “hsv” contains 3 comma separated values of numbers. The first number has a range of 0 to 360, the second and third numbers have a range of 0 to 100. e.g. 300,50,75
+                // An empty string (“”) is not a valid payload
+                // Single pass without any allocation
+                static bool parse(const char* begin, const char* end, ValueType& value) {
+                    if(end - begin > static_cast<ptrdiff_t>(maxLength)) {
+                        return false;
+                    }
+                    int64_t components[3];
+                    auto it = begin;
+                    for(size_t i = 0; i < 3; ++i) {
+                        if(i > 0) {
+                            if(it == end || *it != ',') {
+                                return false;
+                            }
+                            ++it;
+                        }
+                        auto digitsBegin = it;
+                        auto component = int64_t{0};
+                        for(; it != end && static_cast<unsigned char>(*it - '0') <= 9; ++it) {
+                            component = component * 10 + (*it - '0');       // At most 11 digits, no overflow possible
+                        }
+                        if(it == digitsBegin || component > (i == 0 ? maxFirst : maxOthers)) {
+                            return false;
+                        }
+                        components[i] = component;
+                    }
+                    if(it != end) {
+                        return false;
+                    }
+                    value = ValueType{components[0], components[1], components[2]};
+                    return true;
+                }
+
+                static bool isValid(const ValueType& value) {
+                    bool isValid = true;
+                    isValid &= (std::get<0>(value) >= 0 && std::get<0>(value) <= maxFirst);
+                    isValid &= (std::get<1>(value) >= 0 && std::get<1>(value) <= maxOthers);
+                    isValid &= (std::get<2>(value) >= 0 && std::get<2>(value) <= maxOthers);
+                    return isValid;
+                }
+
+                // Write the payload into buffer, which has to provide at least maxLength bytes.
+                // Returns the number of characters written or 0 if a component has more than three digits
+                // or is negative (i.e. the value is out of range for all color formats).
+                static size_t format(char* buffer, const ValueType& value) {
+                    const int64_t components[3] = {std::get<0>(value), std::get<1>(value), std::get<2>(value)};
+                    auto pos = size_t{0};
+                    for(size_t i = 0; i < 3; ++i) {
+                        auto component = components[i];
+                        if(component < 0 || component > 999) {
+                            return 0;
+                        }
+                        if(i > 0) {
+                            buffer[pos++] = ',';
+                        }
+                        if(component >= 100) {
+                            buffer[pos++] = static_cast<char>('0' + component / 100);
+                        }
+                        if(component >= 10) {
+                            buffer[pos++] = static_cast<char>('0' + component / 10 % 10);
+                        }
+                        buffer[pos++] = static_cast<char>('0' + component % 10);
+                    }
+                    return pos;
+                }
+
+                static std::string toString(const ValueType& value) {
+                    char buffer[maxLength];
+                    auto length = format(buffer, value);
+                    if(length > 0) {
+                        return std::string(buffer, length);     // Fits into the small string buffer, no allocation
+                    }
+
+                    // Out of range values are still converted, but not on the fast path
+                    auto str = std::string{};
+                    StringUtils::appendNumber(str, std::get<0>(value));
+                    str += ',';
+                    StringUtils::appendNumber(str, std::get<1>(value));
+                    str += ',';
+                    StringUtils::appendNumber(str, std::get<2>(value));
+                    return str;
+                }
+
+                // Longest payload, e.g. "255,255,255" or "360,100,100"
+                static constexpr size_t maxLength = 11;
+                static constexpr int64_t maxFirst = (F == ColorFormat::RGB) ? 255 : 360;
+                static constexpr int64_t maxOthers = (F == ColorFormat::RGB) ? 255 : 100;
+            };
+        }
+
+        // Non-polymorphic payload holder for a compile-time format (see Format namespace)
+        // No vtable is involved, so hot parsing loops can be fully inlined, e.g.
+        //   auto temperature = StaticPayload<Format::Float>{};
+        //   temperature.setPayload("21.5");
+        template<typename F>
+        class StaticPayload {
+        public:
+            using FormatType = F;
+            using ValueType = typename F::ValueType;
+
+            StaticPayload() : m_value{}, m_valid{false} {
+            }
+
+            static bool validatePayload(std::string_view payload) {
+                auto value = ValueType{};
+                return F::parse(payload.data(), payload.data() + payload.size(), value);
+            }
+
+            bool isValid() const {
+                return m_valid;
+            }
+            const ValueType& value() const {
+                return m_value;
+            }
+            std::string toString() const {
+                return F::toString(m_value);
+            }
+
+            // Set the value from a payload. The old value is kept if the payload is invalid.
+            bool setPayload(const char* begin, const char* end) {
+                auto value = ValueType{};
+                auto isValid = F::parse(begin, end, value);
+                if(isValid) {
+                    m_value = std::move(value);
+                    m_valid = true;
+                }
+                return isValid;
+            }
+            bool setPayload(std::string_view payload) {
+                return setPayload(payload.data(), payload.data() + payload.size());
+            }
+
+            // Set the value directly. The old value is kept if the value is out of range.
+            bool setValue(const ValueType& value) {
+                auto isValid = F::isValid(value);
+                if(isValid) {
+                    m_value = value;
+                    m_valid = true;
+                }
+                return isValid;
+            }
+
+            bool operator==(const StaticPayload<F>& rhs) const {
+                return value() == rhs.value();
+            }
+            bool operator!=(const StaticPayload<F>& rhs) const {
+                return value() != rhs.value();
+            }
+
+        protected:
+            ValueType m_value;
+            bool m_valid;
+        };
+    }
+}
+
+#endif /* ROVI_HOMIE_PAYLOAD_FORMATS_H */
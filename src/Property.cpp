@@ -0,0 +1,431 @@
+#include "Property.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <type_traits>
+
+#include "Utils/CharacterClass.h"
+#include "Utils/StringUtils.h"
+
+namespace Rovi {
+    namespace Homie {
+        const char* datatypeToString(const Datatype datatype) {
+            switch(datatype) {
+                case Datatype::integer:
+                    return "integer";
+                case Datatype::floating:
+                    return "float";
+                case Datatype::boolean:
+                    return "boolean";
+                case Datatype::string:
+                    return "string";
+                case Datatype::enumeration:
+                    return "enum";
+                case Datatype::color:
+                    return "color";
+            }
+            return "";
+        }
+
+
+        //*******************************************************************//
+        // Payload formatting without allocation
+        //*******************************************************************//
+        static std::string_view formatInteger(char* characters, const int64_t value) {
+            return std::string_view{characters, StringUtils::formatNumber(characters, PropertyTable::maxPayloadLength, value)};
+        }
+
+        static std::string_view formatFloat(char* characters, const double value) {
+            // s. Format::Float::toString(): Homie floats do not contain a '+'
+            auto length = StringUtils::formatNumber(characters, PropertyTable::maxPayloadLength, value);
+            auto end = std::remove(characters, characters + length, '+');
+            return std::string_view{characters, static_cast<size_t>(end - characters)};
+        }
+
+        static std::string_view formatBoolean(const uint8_t value) {
+            return value != 0 ? std::string_view{"true"} : std::string_view{"false"};
+        }
+
+        static std::string_view formatColor(char* characters, const ColorTuple& value) {
+            // Identical for all color formats
+            return std::string_view{characters, Format::Color<ColorFormat::RGB>::format(characters, value)};
+        }
+
+
+        //*******************************************************************//
+        // PropertyTable
+        //*******************************************************************//
+        PropertyTable::PropertyTable()
+            : m_ids{}, m_names{}, m_formats{}, m_units{}, m_topics{}, m_slots{}, m_settable{}, m_retained{}, m_idList{},
+              m_integers{}, m_integerRanges{}, m_floats{}, m_floatRanges{}, m_booleans{}, m_strings{},
+              m_enumerations{}, m_enumerationTables{}, m_colors{}, m_colorFormats{}
+        {}
+
+
+        PropertyTable::Index PropertyTable::add(const PropertyDefinition& definition) {
+            auto id = nameToID(definition.name);
+            // The ID is a topic level: a-z, 0-9 and '-', but not at the start or the end (s. TopicID::isValid())
+            auto valid = !id.empty() && CharacterClass::topicID().matchesAll(id) && id.front() != '-' && id.back() != '-';
+            if(!valid || find(id) != invalidIndex) {
+                std::cerr << "Invalid or duplicate property ID '" << id << "'" << std::endl;
+                return invalidIndex;
+            }
+
+            auto property = static_cast<Index>(m_ids.size());
+            auto slot = Slot{definition.datatype, invalidIndex};
+            auto format = definition.format;
+            switch(definition.datatype) {
+                case Datatype::integer: {
+                    auto range = std::pair<int64_t, int64_t>{};
+                    if(!parseRange(definition.format, range)) {
+                        break;
+                    }
+                    m_integerRanges.push_back(range);
+                    slot.index = m_integers.append(property, std::clamp(int64_t{0}, range.first, range.second));
+                    break;
+                }
+                case Datatype::floating: {
+                    auto range = std::pair<double, double>{};
+                    if(!parseRange(definition.format, range)) {
+                        break;
+                    }
+                    m_floatRanges.push_back(range);
+                    slot.index = m_floats.append(property, std::clamp(0.0, range.first, range.second));
+                    break;
+                }
+                case Datatype::boolean:
+                    slot.index = m_booleans.append(property, 0);
+                    break;
+                case Datatype::string:
+                    slot.index = m_strings.append(property, std::string{});
+                    break;
+                case Datatype::enumeration: {
+                    // Enum formats list all values, the first one is the initial value. Whitespace around the
+                    // values is not part of them, e.g. "low, high".
+                    auto values = std::vector<std::string>{};
+                    for(auto value : StringUtils::tokenize(definition.format, ',')) {
+                        values.emplace_back(StringUtils::trimView(value));
+                    }
+                    auto isValid = !values.empty() && std::none_of(values.begin(), values.end(),
+                        [](const std::string& value) { return value.empty(); });
+                    if(!isValid) {
+                        break;
+                    }
+                    auto table = std::make_shared<const EnumerationTable>(std::set<std::string>(values.begin(), values.end()));
+                    m_enumerationTables.push_back(table);
+                    slot.index = m_enumerations.append(property, table->find(values.front()));
+                    // $format is published without the whitespace
+                    format = values.front();
+                    for(size_t i = 1; i < values.size(); ++i) {
+                        format += ',' + values[i];
+                    }
+                    break;
+                }
+                case Datatype::color:
+                    if(definition.format != "rgb" && definition.format != "hsv") {
+                        break;
+                    }
+                    m_colorFormats.push_back(definition.format == "rgb" ? ColorFormat::RGB : ColorFormat::HSV);
+                    slot.index = m_colors.append(property, ColorTuple{0, 0, 0});
+                    break;
+            }
+            if(slot.index == invalidIndex) {
+                std::cerr << "Invalid format '" << definition.format << "' for " << datatypeToString(definition.datatype)
+                          << " property '" << id << "'" << std::endl;
+                return invalidIndex;
+            }
+
+            m_topics.push_back(TopicType{id});
+            if(!m_idList.empty()) {
+                m_idList += ',';
+            }
+            m_idList += id;
+            m_ids.push_back(std::move(id));
+            m_names.push_back(definition.name);
+            m_formats.push_back(std::move(format));
+            m_units.push_back(definition.unit);
+            m_slots.push_back(slot);
+            m_settable.push_back(definition.settable ? 1 : 0);
+            m_retained.push_back(definition.retained ? 1 : 0);
+            return property;
+        }
+
+
+        PropertyTable::Index PropertyTable::find(std::string_view propertyID) const {
+            // Properties are only looked up by ID for inbound messages, a linear search over the IDs is sufficient
+            auto it = std::find(m_ids.begin(), m_ids.end(), propertyID);
+            return it != m_ids.end() ? static_cast<Index>(it - m_ids.begin()) : invalidIndex;
+        }
+
+
+        bool PropertyTable::setPayload(const Index property, std::string_view payload) {
+            auto begin = payload.data();
+            auto end = payload.data() + payload.size();
+            auto slot = m_slots[property];
+            switch(slot.datatype) {
+                case Datatype::integer: {
+                    auto value = int64_t{0};
+                    return Format::Integer::parse(begin, end, value) && setInteger(property, value);
+                }
+                case Datatype::floating: {
+                    auto value = 0.0;
+                    return Format::Float::parse(begin, end, value) && setFloat(property, value);
+                }
+                case Datatype::boolean: {
+                    auto value = false;
+                    return Format::Boolean::parse(begin, end, value) && setBoolean(property, value);
+                }
+                case Datatype::string:
+                    return setString(property, payload);
+                case Datatype::enumeration: {
+                    auto index = m_enumerationTables[slot.index]->find(payload);
+                    if(index == EnumerationTable::invalidIndex) {
+                        return false;
+                    }
+                    m_enumerations.values[slot.index] = index;
+                    m_enumerations.changed[slot.index] = 1;
+                    return true;
+                }
+                case Datatype::color: {
+                    auto value = ColorTuple{};
+                    auto isValid = m_colorFormats[slot.index] == ColorFormat::RGB
+                        ? Format::Color<ColorFormat::RGB>::parse(begin, end, value)
+                        : Format::Color<ColorFormat::HSV>::parse(begin, end, value);
+                    return isValid && setColor(property, value);
+                }
+            }
+            return false;
+        }
+
+
+        bool PropertyTable::setInteger(const Index property, const int64_t value) {
+            auto slot = m_slots[property];
+            if(slot.datatype != Datatype::integer
+                || value < m_integerRanges[slot.index].first || value > m_integerRanges[slot.index].second) {
+                return false;
+            }
+            m_integers.values[slot.index] = value;
+            m_integers.changed[slot.index] = 1;
+            return true;
+        }
+
+
+        bool PropertyTable::setFloat(const Index property, const double value) {
+            auto slot = m_slots[property];
+            if(slot.datatype != Datatype::floating || !Format::Float::isValid(value)
+                || value < m_floatRanges[slot.index].first || value > m_floatRanges[slot.index].second) {
+                return false;
+            }
+            m_floats.values[slot.index] = value;
+            m_floats.changed[slot.index] = 1;
+            return true;
+        }
+
+
+        bool PropertyTable::setBoolean(const Index property, const bool value) {
+            auto slot = m_slots[property];
+            if(slot.datatype != Datatype::boolean) {
+                return false;
+            }
+            m_booleans.values[slot.index] = value ? 1 : 0;
+            m_booleans.changed[slot.index] = 1;
+            return true;
+        }
+
+
+        bool PropertyTable::setString(const Index property, std::string_view value) {
+            auto slot = m_slots[property];
+            if(slot.datatype != Datatype::string || value.size() > Format::String::maxLength) {
+                return false;
+            }
+            // Reuses the capacity of the previous value
+            m_strings.values[slot.index].assign(value.data(), value.size());
+            m_strings.changed[slot.index] = 1;
+            return true;
+        }
+
+
+        bool PropertyTable::setColor(const Index property, const ColorTuple& value) {
+            auto slot = m_slots[property];
+            if(slot.datatype != Datatype::color) {
+                return false;
+            }
+            auto isValid = m_colorFormats[slot.index] == ColorFormat::RGB
+                ? Format::Color<ColorFormat::RGB>::isValid(value)
+                : Format::Color<ColorFormat::HSV>::isValid(value);
+            if(!isValid) {
+                return false;
+            }
+            m_colors.values[slot.index] = value;
+            m_colors.changed[slot.index] = 1;
+            return true;
+        }
+
+
+        int64_t PropertyTable::integer(const Index property) const {
+            return m_integers.values[m_slots[property].index];
+        }
+
+
+        double PropertyTable::floating(const Index property) const {
+            return m_floats.values[m_slots[property].index];
+        }
+
+
+        bool PropertyTable::boolean(const Index property) const {
+            return m_booleans.values[m_slots[property].index] != 0;
+        }
+
+
+        const std::string& PropertyTable::string(const Index property) const {
+            auto slot = m_slots[property];
+            if(slot.datatype == Datatype::enumeration) {
+                return m_enumerationTables[slot.index]->value(m_enumerations.values[slot.index]);
+            }
+            return m_strings.values[slot.index];
+        }
+
+
+        const ColorTuple& PropertyTable::color(const Index property) const {
+            return m_colors.values[m_slots[property].index];
+        }
+
+
+        std::string PropertyTable::payload(const Index property) const {
+            char characters[maxPayloadLength];
+            return std::string{formatValue(property, characters)};
+        }
+
+
+        void PropertyTable::appendAttributes(AttributeBuffer& buffer, const TopicType& nodeTopic) const {
+            static const auto nameTopic = TopicType{"$name"};
+            static const auto datatypeTopic = TopicType{"$datatype"};
+            static const auto formatTopic = TopicType{"$format"};
+            static const auto settableTopic = TopicType{"$settable"};
+            static const auto retainedTopic = TopicType{"$retained"};
+            static const auto unitTopic = TopicType{"$unit"};
+            for(Index property = 0; property < m_ids.size(); ++property) {
+                auto& topic = m_topics[property];
+                buffer.append(nodeTopic, topic, nameTopic, m_names[property]);
+                buffer.append(nodeTopic, topic, datatypeTopic, datatypeToString(m_slots[property].datatype));
+                if(!m_formats[property].empty()) {
+                    buffer.append(nodeTopic, topic, formatTopic, m_formats[property]);
+                }
+                buffer.append(nodeTopic, topic, settableTopic, formatBoolean(m_settable[property]));
+                buffer.append(nodeTopic, topic, retainedTopic, formatBoolean(m_retained[property]));
+                if(!m_units[property].empty()) {
+                    buffer.append(nodeTopic, topic, unitTopic, m_units[property]);
+                }
+            }
+        }
+
+
+        void PropertyTable::appendValues(AttributeBuffer& buffer, const TopicType& nodeTopic) const {
+            appendColumns(buffer, nodeTopic, false);
+        }
+
+
+        void PropertyTable::appendChangedValues(AttributeBuffer& buffer, const TopicType& nodeTopic) {
+            appendColumns(buffer, nodeTopic, true);
+            clearChanged();
+        }
+
+
+        void PropertyTable::clearChanged() {
+            std::fill(m_integers.changed.begin(), m_integers.changed.end(), 0);
+            std::fill(m_floats.changed.begin(), m_floats.changed.end(), 0);
+            std::fill(m_booleans.changed.begin(), m_booleans.changed.end(), 0);
+            std::fill(m_strings.changed.begin(), m_strings.changed.end(), 0);
+            std::fill(m_enumerations.changed.begin(), m_enumerations.changed.end(), 0);
+            std::fill(m_colors.changed.begin(), m_colors.changed.end(), 0);
+        }
+
+
+        template<typename T>
+        bool PropertyTable::parseRange(const std::string& format, std::pair<T, T>& range) {
+            if(format.empty()) {
+                range = std::make_pair(std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max());
+                return true;
+            }
+            auto separator = format.find(':');
+            if(separator == std::string::npos) {
+                return false;
+            }
+            auto parse = [](const char* begin, const char* end, T& value) {
+                if constexpr(std::is_same<T, int64_t>::value) {
+                    return Format::Integer::parse(begin, end, value);
+                } else {
+                    return Format::Float::parse(begin, end, value);
+                }
+            };
+            return parse(format.data(), format.data() + separator, range.first)
+                && parse(format.data() + separator + 1, format.data() + format.size(), range.second)
+                && range.first <= range.second;
+        }
+
+
+        template<typename T, typename Formatter>
+        void PropertyTable::appendColumn(AttributeBuffer& buffer, const TopicType& nodeTopic, const Column<T>& column,
+            const bool changedOnly, Formatter formatSlot) const {
+            char characters[maxPayloadLength];
+            for(Index slot = 0; slot < column.values.size(); ++slot) {
+                if(changedOnly && column.changed[slot] == 0) {
+                    continue;
+                }
+                auto property = column.properties[slot];
+                buffer.append(nodeTopic, m_topics[property], formatSlot(slot, characters), m_retained[property] != 0);
+            }
+        }
+
+
+        void PropertyTable::appendColumns(AttributeBuffer& buffer, const TopicType& nodeTopic, const bool changedOnly) const {
+            appendColumn(buffer, nodeTopic, m_integers, changedOnly, [this](const Index slot, char* characters) {
+                return formatInteger(characters, m_integers.values[slot]);
+            });
+            appendColumn(buffer, nodeTopic, m_floats, changedOnly, [this](const Index slot, char* characters) {
+                return formatFloat(characters, m_floats.values[slot]);
+            });
+            appendColumn(buffer, nodeTopic, m_booleans, changedOnly, [this](const Index slot, char*) {
+                return formatBoolean(m_booleans.values[slot]);
+            });
+            appendColumn(buffer, nodeTopic, m_strings, changedOnly, [this](const Index slot, char*) {
+                return std::string_view{m_strings.values[slot]};
+            });
+            appendColumn(buffer, nodeTopic, m_enumerations, changedOnly, [this](const Index slot, char*) {
+                return std::string_view{m_enumerationTables[slot]->value(m_enumerations.values[slot])};
+            });
+            appendColumn(buffer, nodeTopic, m_colors, changedOnly, [this](const Index slot, char* characters) {
+                return formatColor(characters, m_colors.values[slot]);
+            });
+        }
+
+
+        std::string_view PropertyTable::formatValue(const Index property, char* characters) const {
+            auto slot = m_slots[property];
+            switch(slot.datatype) {
+                case Datatype::integer:
+                    return formatInteger(characters, m_integers.values[slot.index]);
+                case Datatype::floating:
+                    return formatFloat(characters, m_floats.values[slot.index]);
+                case Datatype::boolean:
+                    return formatBoolean(m_booleans.values[slot.index]);
+                case Datatype::string:
+                case Datatype::enumeration:
+                    return string(property);
+                case Datatype::color:
+                    return formatColor(characters, m_colors.values[slot.index]);
+            }
+            return {};
+        }
+
+
+        std::string PropertyTable::nameToID(const std::string& name) const {
+            // s. Node::nameToID()
+            auto id = StringUtils::toLower(name);
+            std::replace(id.begin(), id.end(), ' ', '-');
+            return id;
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef __HOMIE_PROPERTY_H__
+#define __HOMIE_PROPERTY_H__
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#include "HomieHelper.h"
+#include "PayloadDataTypes.h"
+
+namespace Rovi {
+    namespace Homie {
+        // Datatypes of the Homie convention ($datatype)
+        enum class Datatype {
+            integer,
+            floating,
+            boolean,
+            string,
+            enumeration,
+            color
+        };
+
+        // $datatype payload, e.g. "float" for Datatype::floating
+        const char* datatypeToString(const Datatype datatype);
+
+        // Description of a property as passed to Node::addProperty(). The property ID is derived from the name.
+        // 'format' ($format) depends on the datatype:
+        //   integer, float: Optional range "<min>:<max>", e.g. "0:100"
+        //   enum:           Comma separated list of all values, e.g. "low,medium,high"
+        //   color:          "rgb" or "hsv"
+        struct PropertyDefinition {
+            std::string name;
+            Datatype datatype = Datatype::string;
+            std::string format = {};
+            std::string unit = {};
+            bool settable = false;
+            bool retained = true;
+        };
+
+        // All properties of a node, stored as structure of arrays
+        // Each datatype has its own value column, e.g. the values of all integer properties of a node are one
+        // contiguous std::vector<int64_t>. A property only references its slot in that column, so properties are
+        // no separate heap objects and the values of hundreds of numeric properties are scanned and serialized
+        // sequentially. The descriptive attributes ($name, $unit, ...) are only read on connection and are kept
+        // in separate columns, so they do not dilute the value columns.
+        // Payloads are validated by the Format:: types of the datatype (s. PayloadFormats.h).
+        class PropertyTable {
+            public:
+                using Index = uint32_t;
+                enum : Index { invalidIndex = 0xFFFFFFFF };
+                // Longest formatted number or color
+                static constexpr size_t maxPayloadLength = StringUtils::maxNumberLength;
+
+                PropertyTable();
+
+                // Returns invalidIndex, if the ID exists already or the format does not fit the datatype
+                Index add(const PropertyDefinition& definition);
+                Index find(std::string_view propertyID) const;
+                size_t size() const { return m_ids.size(); }
+
+                const std::string& id(const Index property) const { return m_ids[property]; }
+                const std::string& name(const Index property) const { return m_names[property]; }
+                Datatype datatype(const Index property) const { return m_slots[property].datatype; }
+                bool settable(const Index property) const { return m_settable[property] != 0; }
+                // Comma separated IDs of all properties ($properties of the node), extended by add()
+                const std::string& ids() const { return m_idList; }
+
+                // Validates and stores a payload, e.g. received via <property>/set. Returns false, if it is invalid.
+                bool setPayload(const Index property, std::string_view payload);
+                // Return false, if the property has an other datatype or the value is not valid for its format
+                bool setInteger(const Index property, const int64_t value);
+                bool setFloat(const Index property, const double value);
+                bool setBoolean(const Index property, const bool value);
+                bool setString(const Index property, std::string_view value);
+                bool setColor(const Index property, const ColorTuple& value);
+
+                // The property must have the respective datatype. string() also returns the value of an enum property.
+                int64_t integer(const Index property) const;
+                double floating(const Index property) const;
+                bool boolean(const Index property) const;
+                const std::string& string(const Index property) const;
+                const ColorTuple& color(const Index property) const;
+                // Current value as payload
+                std::string payload(const Index property) const;
+
+                // <property>/$name, $datatype, $format, $settable, $retained and $unit of all properties
+                // $format and $unit are omitted, if they are empty
+                void appendAttributes(AttributeBuffer& buffer, const TopicType& nodeTopic) const;
+                // <property> = value of all properties, column by column
+                void appendValues(AttributeBuffer& buffer, const TopicType& nodeTopic) const;
+                // Only the values which have been set since the last call
+                void appendChangedValues(AttributeBuffer& buffer, const TopicType& nodeTopic);
+                // Marks all values as published, e.g. after appendValues()
+                void clearChanged();
+
+            protected:
+                // Position of the value of a property in the column of its datatype
+                struct Slot {
+                    Datatype datatype;
+                    Index index;
+                };
+
+                template<typename T>
+                struct Column {
+                    std::vector<T> values;
+                    std::vector<Index> properties;      // Owner of each value
+                    std::vector<uint8_t> changed;
+
+                    Index append(const Index property, T value) {
+                        values.push_back(std::move(value));
+                        properties.push_back(property);
+                        changed.push_back(0);
+                        return static_cast<Index>(values.size() - 1);
+                    }
+                };
+
+                // Returns false, if the format is invalid. The range defaults to the whole value range.
+                template<typename T>
+                static bool parseRange(const std::string& format, std::pair<T, T>& range);
+                // 'formatSlot(slot, characters)' returns the payload of a slot, 'characters' has maxPayloadLength bytes
+                template<typename T, typename Formatter>
+                void appendColumn(AttributeBuffer& buffer, const TopicType& nodeTopic, const Column<T>& column,
+                    const bool changedOnly, Formatter formatSlot) const;
+                void appendColumns(AttributeBuffer& buffer, const TopicType& nodeTopic, const bool changedOnly) const;
+                std::string_view formatValue(const Index property, char* characters) const;
+                std::string nameToID(const std::string& name) const;
+
+                // Descriptive columns, indexed by property
+                std::vector<std::string> m_ids;
+                std::vector<std::string> m_names;
+                std::vector<std::string> m_formats;
+                std::vector<std::string> m_units;
+                std::vector<TopicType> m_topics;        // <property-id>
+                std::vector<Slot> m_slots;
+                std::vector<uint8_t> m_settable;
+                std::vector<uint8_t> m_retained;
+                std::string m_idList;
+
+                // Value columns, indexed by slot
+                Column<int64_t> m_integers;
+                std::vector<std::pair<int64_t, int64_t>> m_integerRanges;
+                Column<double> m_floats;
+                std::vector<std::pair<double, double>> m_floatRanges;
+                Column<uint8_t> m_booleans;
+                Column<std::string> m_strings;
+                Column<EnumerationTable::IndexType> m_enumerations;
+                std::vector<std::shared_ptr<const EnumerationTable>> m_enumerationTables;
+                Column<ColorTuple> m_colors;
+                std::vector<ColorFormat> m_colorFormats;
+        };
+    }
+}
+
+#endif /* __HOMIE_PROPERTY_H__ */
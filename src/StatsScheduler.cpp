@@ -0,0 +1,106 @@
+#include "StatsScheduler.h"
+
+#include <algorithm>
+
+namespace Rovi {
+    namespace Homie {
+        StatsScheduler::StatsScheduler(PublishFunction publish, const std::chrono::milliseconds resolution, NowFunction now)
+            : m_publish{std::move(publish)}, m_resolution{std::max(resolution, std::chrono::milliseconds{1})}, m_now{std::move(now)},
+              m_start{m_now()}, m_wheel{}, m_entries{}, m_buffer{}, m_lateness{}
+        {}
+
+
+        bool StatsScheduler::addDevice(const std::shared_ptr<Device>& device) {
+            auto interval = std::chrono::duration_cast<Clock::duration>(device->statsInterval_s());
+            if(interval <= Clock::duration::zero() || m_entries.count(device.get()) > 0) {
+                return false;
+            }
+            auto intervalTicks = std::max<uint64_t>(1, static_cast<uint64_t>(interval / m_resolution));
+            // The wheel may not have processed the current tick yet, so the first update is due one tick later at the earliest
+            auto first = std::max(toTick(m_now()), m_wheel.currentTick()) + 1 + phase(*device, intervalTicks);
+            auto timer = m_wheel.schedule(first, device.get());
+            m_entries.emplace(device.get(), Entry{device, timer, intervalTicks});
+            return true;
+        }
+
+
+        bool StatsScheduler::removeDevice(const Device& device) {
+            auto it = m_entries.find(&device);
+            if(it == m_entries.end()) {
+                return false;
+            }
+            m_wheel.cancel(it->second.timer);
+            m_entries.erase(it);
+            return true;
+        }
+
+
+        size_t StatsScheduler::poll() {
+            auto now = m_now();
+            auto currentTick = toTick(now);
+            return m_wheel.advance(currentTick, [this, currentTick, now](Wheel::TimerID, Device* device, uint64_t dueTick) {
+                fire(device, dueTick, currentTick, now);
+            });
+        }
+
+
+        StatsScheduler::Clock::time_point StatsScheduler::nextPoll() const {
+            return toTime(m_wheel.currentTick());
+        }
+
+
+        uint64_t StatsScheduler::toTick(const Clock::time_point time) const {
+            if(time <= m_start) {
+                return 0;
+            }
+            return static_cast<uint64_t>((time - m_start) / m_resolution);
+        }
+
+
+        StatsScheduler::Clock::time_point StatsScheduler::toTime(const uint64_t tick) const {
+            return m_start + m_resolution * static_cast<Clock::rep>(tick);
+        }
+
+
+        uint64_t StatsScheduler::phase(const Device& device, const uint64_t intervalTicks) const {
+            // FNV-1a of the device ID: Stable across restarts and evenly spread
+            auto hash = uint64_t{14695981039346656037ull};
+            for(auto c : device.deviceID()->id()) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            return hash % intervalTicks;
+        }
+
+
+        void StatsScheduler::fire(Device* device, const uint64_t dueTick, const uint64_t currentTick, const Clock::time_point now) {
+            auto it = m_entries.find(device);
+            if(it == m_entries.end()) {
+                return;
+            }
+            auto& entry = it->second;
+
+            auto lateness = now - toTime(dueTick);
+            ++m_lateness.updates;
+            m_lateness.total += lateness;
+            m_lateness.max = std::max(m_lateness.max, lateness);
+
+            // Fixed rate. Intervals which are completely in the past are skipped instead of being caught up.
+            auto next = dueTick + entry.intervalTicks;
+            if(next <= currentTick) {
+                auto missed = (currentTick - next) / entry.intervalTicks + 1;
+                m_lateness.skipped += missed;
+                next += missed * entry.intervalTicks;
+            }
+            entry.timer = m_wheel.schedule(next, device);
+
+            // The entry may be removed by the publish function
+            auto keepAlive = entry.device;
+            m_buffer.clear();
+            keepAlive->update(m_buffer);
+            if(m_publish) {
+                m_publish(*keepAlive, m_buffer);
+            }
+        }
+    }
+}
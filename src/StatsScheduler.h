@@ -0,0 +1,83 @@
+#ifndef __HOMIE_STATSSCHEDULER_H__
+#define __HOMIE_STATSSCHEDULER_H__
+
+#include <chrono>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+
+#include "Device.h"
+#include "HomieHelper.h"
+#include "Utils/TimingWheel.h"
+
+namespace Rovi {
+    namespace Homie {
+        // Calls Device::update() of many devices according to their statsInterval
+        // The due updates are kept in a hierarchical timing wheel, so adding a device and firing an update is O(1)
+        // independent of the number of devices. Every device gets a stable phase within its interval (derived from
+        // the device ID), so a fleet with the same interval does not publish all stats at the same time.
+        // Updates are scheduled at a fixed rate (previous due time + interval), so late polls do not add up to a drift.
+        // poll() has to be called regularly, e.g. from the event loop of the transport, at least every 'resolution'.
+        class StatsScheduler {
+            public:
+                using Clock = std::chrono::steady_clock;
+                // Injectable time source, e.g. a fake clock for testing
+                using NowFunction = std::function<Clock::time_point()>;
+                // Called with the stats of a device, e.g. forwards the buffer to Mqtt::MqttClient::publish()
+                using PublishFunction = std::function<void(Device& device, AttributeBuffer& buffer)>;
+
+                // Time between the due time and the actual update
+                struct Lateness {
+                    uint64_t updates = 0;
+                    // Intervals skipped because the scheduler was polled too late
+                    uint64_t skipped = 0;
+                    Clock::duration max = Clock::duration::zero();
+                    Clock::duration total = Clock::duration::zero();
+
+                    Clock::duration mean() const { return updates > 0 ? total / static_cast<Clock::rep>(updates) : Clock::duration::zero(); }
+                };
+
+                explicit StatsScheduler(PublishFunction publish, const std::chrono::milliseconds resolution = std::chrono::milliseconds{100},
+                    NowFunction now = &Clock::now);
+
+                // Devices with a statsInterval of 0 are not scheduled
+                bool addDevice(const std::shared_ptr<Device>& device);
+                bool removeDevice(const Device& device);
+                size_t deviceCount() const { return m_entries.size(); }
+
+                // Update all devices which are due. Returns the number of updated devices.
+                size_t poll();
+                // Time of the next tick of the timing wheel
+                Clock::time_point nextPoll() const;
+
+                const Lateness& lateness() const { return m_lateness; }
+                void resetLateness() { m_lateness = Lateness{}; }
+
+            protected:
+                using Wheel = TimingWheel<Device*>;
+
+                struct Entry {
+                    std::shared_ptr<Device> device;
+                    Wheel::TimerID timer;
+                    uint64_t intervalTicks;
+                };
+
+                uint64_t toTick(const Clock::time_point time) const;
+                Clock::time_point toTime(const uint64_t tick) const;
+                uint64_t phase(const Device& device, const uint64_t intervalTicks) const;
+                void fire(Device* device, const uint64_t dueTick, const uint64_t currentTick, const Clock::time_point now);
+
+                PublishFunction m_publish;
+                Clock::duration m_resolution;
+                NowFunction m_now;
+                Clock::time_point m_start;
+                Wheel m_wheel;
+                std::unordered_map<const Device*, Entry> m_entries;
+                // Reused for every update
+                AttributeBuffer m_buffer;
+                Lateness m_lateness;
+        };
+    }
+}
+
+#endif /* __HOMIE_STATSSCHEDULER_H__ */
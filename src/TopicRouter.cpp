@@ -0,0 +1,229 @@
+#include "TopicRouter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rovi {
+    namespace Homie {
+        TopicRouter::TopicRouter()
+            : m_nodes{TrieNode{}}, m_edges{}, m_edgeCount{0}, m_levels{}, m_levelOffsets{}, m_handlers{}, m_routeCount{0}
+        {}
+
+
+        bool TopicRouter::add(std::string_view route, Handler handler) {
+            if(route.empty() || !handler) {
+                return false;
+            }
+            // Validate first, so an invalid route does not leave levels behind
+            for(size_t position = 0; position <= route.size();) {
+                auto end = std::min(route.find('/', position), route.size());
+                auto level = route.substr(position, end - position);
+                auto wildcard = level.find_first_of("+#") != std::string_view::npos;
+                if(wildcard && (level.size() != 1 || (level == "#" && end != route.size()))) {
+                    return false;
+                }
+                position = end + 1;
+            }
+
+            auto node = uint32_t{0};
+            for(size_t position = 0; position <= route.size();) {
+                auto end = std::min(route.find('/', position), route.size());
+                auto level = route.substr(position, end - position);
+                if(level == "+" || level == "#") {
+                    auto& wildcard = level == "+" ? m_nodes[node].singleLevel : m_nodes[node].multiLevel;
+                    if(wildcard == none) {
+                        auto child = static_cast<uint32_t>(m_nodes.size());
+                        m_nodes.push_back(TrieNode{});
+                        // m_nodes may have been reallocated
+                        (level == "+" ? m_nodes[node].singleLevel : m_nodes[node].multiLevel) = child;
+                        node = child;
+                    } else {
+                        node = wildcard;
+                    }
+                } else {
+                    auto child = findChild(node, level);
+                    node = child != none ? child : addChild(node, level);
+                }
+                position = end + 1;
+            }
+
+            auto& target = m_nodes[node];
+            if(target.handler == none) {
+                target.handler = static_cast<uint32_t>(m_handlers.size());
+                m_handlers.push_back(std::move(handler));
+                ++m_routeCount;
+            } else {
+                m_handlers[target.handler] = std::move(handler);
+            }
+            return true;
+        }
+
+
+        bool TopicRouter::remove(std::string_view route) {
+            auto node = findRoute(route);
+            if(node == none || m_nodes[node].handler == none) {
+                return false;
+            }
+            m_handlers[m_nodes[node].handler] = nullptr;
+            m_nodes[node].handler = none;
+            --m_routeCount;
+            return true;
+        }
+
+
+        void TopicRouter::reserve(const size_t levels) {
+            m_nodes.reserve(levels + 1);
+            while(m_edges.size() < levels * 2) {
+                grow();
+            }
+        }
+
+
+        bool TopicRouter::dispatch(std::string_view topic, std::string_view payload) const {
+            return match(0, topic, 0, payload);
+        }
+
+
+        uint32_t TopicRouter::hash(const uint32_t parent, std::string_view level) {
+            // Eight characters per multiplication, followed by the MurmurHash3 finalizer. Levels are short, so a
+            // per-character hash like FNV-1a would dominate the dispatch.
+            auto hash = (parent * 0x9E3779B97F4A7C15ull) ^ level.size();
+            auto data = level.data();
+            auto remaining = level.size();
+            for(; remaining >= 8; data += 8, remaining -= 8) {
+                auto word = uint64_t{0};
+                std::memcpy(&word, data, 8);
+                hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+                hash ^= hash >> 29;
+            }
+            if(remaining > 0) {
+                auto word = uint64_t{0};
+                std::memcpy(&word, data, remaining);
+                hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+            }
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ull;
+            hash ^= hash >> 33;
+            return static_cast<uint32_t>(hash);
+        }
+
+
+        bool TopicRouter::equals(const Edge& edge, std::string_view level) const {
+            // Topics can not contain the null character, so the terminator marks the end of the interned level
+            return m_levels.compare(edge.offset, level.size(), level) == 0 && m_levels[edge.offset + level.size()] == '\0';
+        }
+
+
+        uint32_t TopicRouter::findChild(const uint32_t parent, std::string_view level) const {
+            if(m_edges.empty()) {
+                return none;
+            }
+            auto key = hash(parent, level);
+            auto mask = m_edges.size() - 1;
+            for(auto index = key & mask; m_edges[index].child != none; index = (index + 1) & mask) {
+                auto& edge = m_edges[index];
+                if(edge.hash == key && edge.parent == parent && equals(edge, level)) {
+                    return edge.child;
+                }
+            }
+            return none;
+        }
+
+
+        uint32_t TopicRouter::addChild(const uint32_t parent, std::string_view level) {
+            // Load factor <= 0.5
+            if((m_edgeCount + 1) * 2 > m_edges.size()) {
+                grow();
+            }
+            auto child = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.push_back(TrieNode{});
+            insertEdge(Edge{hash(parent, level), parent, child, intern(level)});
+            ++m_edgeCount;
+            return child;
+        }
+
+
+        uint32_t TopicRouter::intern(std::string_view level) {
+            auto offset = static_cast<uint32_t>(m_levels.size());
+            auto inserted = m_levelOffsets.emplace(std::string{level}, offset);
+            if(inserted.second) {
+                m_levels.append(level);
+                m_levels.push_back('\0');
+            }
+            return inserted.first->second;
+        }
+
+
+        void TopicRouter::insertEdge(const Edge& edge) {
+            auto mask = m_edges.size() - 1;
+            auto index = edge.hash & mask;
+            while(m_edges[index].child != none) {
+                index = (index + 1) & mask;
+            }
+            m_edges[index] = edge;
+        }
+
+
+        void TopicRouter::grow() {
+            auto edges = std::vector<Edge>(m_edges.empty() ? 64 : m_edges.size() * 2);
+            std::swap(edges, m_edges);
+            for(auto& edge : edges) {
+                if(edge.child != none) {
+                    insertEdge(edge);
+                }
+            }
+        }
+
+
+        uint32_t TopicRouter::findRoute(std::string_view route) const {
+            auto node = uint32_t{0};
+            for(size_t position = 0; position <= route.size() && node != none;) {
+                auto end = std::min(route.find('/', position), route.size());
+                auto level = route.substr(position, end - position);
+                if(level == "+") {
+                    node = m_nodes[node].singleLevel;
+                } else if(level == "#") {
+                    node = m_nodes[node].multiLevel;
+                } else {
+                    node = findChild(node, level);
+                }
+                position = end + 1;
+            }
+            return node;
+        }
+
+
+        bool TopicRouter::match(const uint32_t node, std::string_view topic, const size_t position, std::string_view payload) const {
+            auto& trieNode = m_nodes[node];
+            // All levels consumed. "a/#" also matches "a".
+            if(position > topic.size()) {
+                return call(trieNode.handler, topic, payload)
+                    || (trieNode.multiLevel != none && call(m_nodes[trieNode.multiLevel].handler, topic, payload));
+            }
+
+            auto end = std::min(topic.find('/', position), topic.size());
+            auto level = topic.substr(position, end - position);
+            auto child = findChild(node, level);
+            if(child != none && match(child, topic, end + 1, payload)) {
+                return true;
+            }
+            // Wildcards in the first level do not match topics starting with '$'
+            if(node == 0 && !level.empty() && level.front() == '$') {
+                return false;
+            }
+            if(trieNode.singleLevel != none && match(trieNode.singleLevel, topic, end + 1, payload)) {
+                return true;
+            }
+            return trieNode.multiLevel != none && call(m_nodes[trieNode.multiLevel].handler, topic, payload);
+        }
+
+
+        bool TopicRouter::call(const uint32_t handler, std::string_view topic, std::string_view payload) const {
+            if(handler == none || !m_handlers[handler]) {
+                return false;
+            }
+            m_handlers[handler](topic, payload);
+            return true;
+        }
+    }
+}
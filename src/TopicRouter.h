@@ -0,0 +1,79 @@
+#ifndef __HOMIE_TOPICROUTER_H__
+#define __HOMIE_TOPICROUTER_H__
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Rovi {
+    namespace Homie {
+        // Dispatches inbound topics, e.g. homie/<device>/<node>/<property>/set, to the handler registered for them
+        // All routes are compiled into a trie over the topic levels. The children of all trie nodes are kept in one
+        // open addressing table keyed by (parent, level). Level names are interned as null terminated strings in one
+        // buffer, so levels repeated for every device (e.g. "set" or the property IDs) are stored once and stay cached.
+        // dispatch() therefore takes O(levels) lookups and does not allocate, so it can be called with the topic and
+        // payload views of a received packet (s. Mqtt::PublishView).
+        // Routes may contain the MQTT wildcards '+' (one level) and '#' (any number of levels, last level only).
+        // Exact levels take precedence over '+', which takes precedence over '#'.
+        class TopicRouter {
+            public:
+                using Handler = std::function<void(std::string_view topic, std::string_view payload)>;
+
+                TopicRouter();
+
+                // Returns false, if the route is invalid. An existing handler for the same route is replaced.
+                bool add(std::string_view route, Handler handler);
+                // The levels stay in the trie, only the handler is removed
+                bool remove(std::string_view route);
+                size_t size() const { return m_routeCount; }
+                // Number of trie levels, e.g. devices * (1 + nodes * (1 + properties * 2)) for .../<property>/set
+                void reserve(const size_t levels);
+
+                // Calls the handler of the most specific matching route. Returns false, if no route matches.
+                bool dispatch(std::string_view topic, std::string_view payload) const;
+
+            protected:
+                static constexpr uint32_t none = 0xFFFFFFFF;
+
+                struct TrieNode {
+                    uint32_t handler = none;
+                    uint32_t singleLevel = none;
+                    uint32_t multiLevel = none;
+                };
+
+                // 16 bytes. The level name (in m_levels) is referenced by the edge, so a lookup does not touch the child.
+                struct Edge {
+                    uint32_t hash = 0;
+                    uint32_t parent = none;
+                    uint32_t child = none;
+                    uint32_t offset = 0;
+                };
+
+                static uint32_t hash(const uint32_t parent, std::string_view level);
+                bool equals(const Edge& edge, std::string_view level) const;
+                uint32_t findChild(const uint32_t parent, std::string_view level) const;
+                uint32_t addChild(const uint32_t parent, std::string_view level);
+                uint32_t intern(std::string_view level);
+                void insertEdge(const Edge& edge);
+                void grow();
+                // Finds the node of a route without creating it
+                uint32_t findRoute(std::string_view route) const;
+                // 'position' is the start of the next level in topic, topic.size() + 1 if all levels are consumed
+                bool match(const uint32_t node, std::string_view topic, const size_t position, std::string_view payload) const;
+                bool call(const uint32_t handler, std::string_view topic, std::string_view payload) const;
+
+                std::vector<TrieNode> m_nodes;
+                std::vector<Edge> m_edges;
+                size_t m_edgeCount;
+                std::string m_levels;
+                // Offsets of the interned level names, only used while adding routes
+                std::unordered_map<std::string, uint32_t> m_levelOffsets;
+                std::vector<Handler> m_handlers;
+                size_t m_routeCount;
+        };
+    }
+}
+
+#endif /* __HOMIE_TOPICROUTER_H__ */
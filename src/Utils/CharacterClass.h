@@ -0,0 +1,159 @@
+#ifndef __CHARACTERCLASS_H__
+#define __CHARACTERCLASS_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <array>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Rovi {
+    // Set of allowed characters backed by a precomputed 256 entry lookup table.
+    // Membership tests are a single table access, independent of the number of allowed characters.
+    // If the class consists of only a few contiguous ranges (e.g. "a-z0-9-"), long inputs are checked
+    // 16 (SSE2) or 32 (AVX2) bytes at a time.
+    class CharacterClass {
+        public:
+        explicit CharacterClass(const char* allowedChars) : CharacterClass(allowedChars, strlen(allowedChars)) {
+        }
+
+        explicit CharacterClass(const std::string& allowedChars) : CharacterClass(allowedChars.data(), allowedChars.size()) {
+        }
+
+        CharacterClass(const char* allowedChars, const size_t length) : m_table{}, m_ranges{}, m_rangeCount{0} {
+            for(size_t i = 0; i < length; ++i) {
+                m_table[static_cast<unsigned char>(allowedChars[i])] = true;
+            }
+            buildRanges();
+        }
+
+        bool contains(const char c) const {
+            return m_table[static_cast<unsigned char>(c)];
+        }
+
+        // True if every character of [begin, end) is part of the class. An empty input matches.
+        bool matchesAll(const char* begin, const char* end) const {
+            auto it = begin;
+#if defined(__AVX2__) || defined(__SSE2__)
+            if(m_rangeCount > 0 && static_cast<size_t>(end - it) >= simdWidth) {
+                if(!matchesAllSimd(it, end)) {
+                    return false;
+                }
+            }
+#endif
+            for(; it != end; ++it) {
+                if(!contains(*it)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool matchesAll(const std::string& str) const {
+            return matchesAll(str.data(), str.data() + str.size());
+        }
+
+        // Homie topic IDs: Lowercase letters from a to z, numbers from 0 to 9 and the hyphen character (-)
+        static const CharacterClass& topicID() {
+            static const CharacterClass characterClass{"abcdefghijklmnopqrstuvwxyz0123456789-"};
+            return characterClass;
+        }
+
+        static const CharacterClass& digits() {
+            static const CharacterClass characterClass{"0123456789"};
+            return characterClass;
+        }
+
+        protected:
+        // Maximum number of contiguous ranges checked by the SIMD path. Classes with more ranges use the lookup table only.
+        static constexpr size_t maxRanges = 4;
+        struct Range {
+            uint8_t first;
+            uint8_t size;       // last - first
+        };
+
+        void buildRanges() {
+            auto count = size_t{0};
+            auto c = 0;
+            while(c < 256) {
+                if(!m_table[c]) {
+                    ++c;
+                    continue;
+                }
+                auto first = c;
+                while(c < 256 && m_table[c]) {
+                    ++c;
+                }
+                if(count == maxRanges) {
+                    m_rangeCount = 0;      // Too fragmented for the SIMD path
+                    return;
+                }
+                m_ranges[count++] = Range{static_cast<uint8_t>(first), static_cast<uint8_t>(c - 1 - first)};
+            }
+            m_rangeCount = count;
+        }
+
+#if defined(__AVX2__)
+        static constexpr size_t simdWidth = 32;
+
+        // Checks all complete blocks and advances 'it' to the remaining tail
+        bool matchesAllSimd(const char*& it, const char* end) const {
+            // c in [first, first + size] <=> (uint8_t)(c - first) <= size
+            __m256i firsts[maxRanges];
+            __m256i sizes[maxRanges];
+            for(size_t r = 0; r < m_rangeCount; ++r) {
+                firsts[r] = _mm256_set1_epi8(static_cast<char>(m_ranges[r].first));
+                sizes[r] = _mm256_set1_epi8(static_cast<char>(m_ranges[r].size));
+            }
+            for(; static_cast<size_t>(end - it) >= simdWidth; it += simdWidth) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+                auto matches = _mm256_setzero_si256();
+                for(size_t r = 0; r < m_rangeCount; ++r) {
+                    auto offset = _mm256_sub_epi8(block, firsts[r]);
+                    matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(offset, _mm256_min_epu8(offset, sizes[r])));
+                }
+                if(static_cast<uint32_t>(_mm256_movemask_epi8(matches)) != 0xFFFFFFFFu) {
+                    return false;
+                }
+            }
+            return true;
+        }
+#elif defined(__SSE2__)
+        static constexpr size_t simdWidth = 16;
+
+        // Checks all complete blocks and advances 'it' to the remaining tail
+        bool matchesAllSimd(const char*& it, const char* end) const {
+            // c in [first, first + size] <=> (uint8_t)(c - first) <= size
+            __m128i firsts[maxRanges];
+            __m128i sizes[maxRanges];
+            for(size_t r = 0; r < m_rangeCount; ++r) {
+                firsts[r] = _mm_set1_epi8(static_cast<char>(m_ranges[r].first));
+                sizes[r] = _mm_set1_epi8(static_cast<char>(m_ranges[r].size));
+            }
+            for(; static_cast<size_t>(end - it) >= simdWidth; it += simdWidth) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                auto matches = _mm_setzero_si128();
+                for(size_t r = 0; r < m_rangeCount; ++r) {
+                    auto offset = _mm_sub_epi8(block, firsts[r]);
+                    matches = _mm_or_si128(matches, _mm_cmpeq_epi8(offset, _mm_min_epu8(offset, sizes[r])));
+                }
+                if(_mm_movemask_epi8(matches) != 0xFFFF) {
+                    return false;
+                }
+            }
+            return true;
+        }
+#endif
+
+        std::array<bool, 256> m_table;
+        std::array<Range, maxRanges> m_ranges;
+        size_t m_rangeCount;
+    };
+}
+
+#endif /* __CHARACTERCLASS_H__ */
@@ -0,0 +1,184 @@
+#ifndef __FLATHASHMAP_H__
+#define __FLATHASHMAP_H__
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Rovi {
+    // Open addressing hash map from std::string to T with linear probing
+    // The slot array only holds the lower 32 bits of the hash and the index of the entry, i.e. 8 bytes per slot,
+    // so a probe sequence stays within one or two cache lines and keys are only compared if the hashes match.
+    // The entries (key, value and the precomputed hash) are stored densely in a separate vector, growing the
+    // table rehashes without hashing the keys again. Erasing moves the last entry into the gap and shifts the
+    // following slots of the probe sequence back, so there are no tombstones.
+    // Lookups take a std::string_view, e.g. a level of an inbound topic, without creating a std::string.
+    // The iteration order of the entries is not stable across erase().
+    template<typename T>
+    class FlatHashMap {
+        public:
+            struct Entry {
+                std::string key;
+                T value;
+                uint64_t hash;
+            };
+
+            FlatHashMap() : m_slots{}, m_entries{} {}
+
+            // FNV-1a followed by the MurmurHash3 finalizer, which spreads the last characters over the lower bits
+            static uint64_t hash(std::string_view key) {
+                auto hash = uint64_t{14695981039346656037ull};
+                for(auto c : key) {
+                    hash ^= static_cast<unsigned char>(c);
+                    hash *= 1099511628211ull;
+                }
+                hash ^= hash >> 33;
+                hash *= 0xff51afd7ed558ccdull;
+                hash ^= hash >> 33;
+                hash *= 0xc4ceb9fe1a85ec53ull;
+                hash ^= hash >> 33;
+                return hash;
+            }
+
+            // Returns false, if the key exists already
+            bool insert(std::string key, T value) {
+                auto keyHash = hash(key);
+                if(findSlot(key, keyHash) != npos) {
+                    return false;
+                }
+                if((m_entries.size() + 1) * 2 > m_slots.size()) {
+                    rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+                }
+                m_entries.push_back(Entry{std::move(key), std::move(value), keyHash});
+                placeSlot(keyHash, static_cast<uint32_t>(m_entries.size() - 1));
+                return true;
+            }
+
+            // nullptr, if the key does not exist
+            T* find(std::string_view key) {
+                auto slot = findSlot(key, hash(key));
+                return slot != npos ? &m_entries[m_slots[slot].entry].value : nullptr;
+            }
+            const T* find(std::string_view key) const {
+                auto slot = findSlot(key, hash(key));
+                return slot != npos ? &m_entries[m_slots[slot].entry].value : nullptr;
+            }
+            bool contains(std::string_view key) const { return find(key) != nullptr; }
+
+            // Returns false, if the key does not exist
+            bool erase(std::string_view key) {
+                auto slot = findSlot(key, hash(key));
+                if(slot == npos) {
+                    return false;
+                }
+                auto entry = m_slots[slot].entry;
+                removeSlot(slot);
+
+                // Move the last entry into the gap and redirect its slot
+                auto last = static_cast<uint32_t>(m_entries.size() - 1);
+                if(entry != last) {
+                    m_slots[findEntrySlot(m_entries[last].hash, last)].entry = entry;
+                    m_entries[entry] = std::move(m_entries[last]);
+                }
+                m_entries.pop_back();
+                return true;
+            }
+
+            void clear() {
+                m_slots.clear();
+                m_entries.clear();
+            }
+
+            // Avoids rehashing while 'count' entries are inserted
+            void reserve(const size_t count) {
+                auto capacity = size_t{16};
+                while(capacity < count * 2) {
+                    capacity *= 2;
+                }
+                if(capacity > m_slots.size()) {
+                    rehash(capacity);
+                }
+                m_entries.reserve(count);
+            }
+
+            size_t size() const { return m_entries.size(); }
+            bool empty() const { return m_entries.empty(); }
+
+            // Entries in insertion order, as long as nothing has been erased
+            typename std::vector<Entry>::const_iterator begin() const { return m_entries.begin(); }
+            typename std::vector<Entry>::const_iterator end() const { return m_entries.end(); }
+
+        protected:
+            static constexpr uint32_t emptySlot = 0xFFFFFFFF;
+            static constexpr size_t npos = static_cast<size_t>(-1);
+
+            struct Slot {
+                uint32_t hash = 0;          // Lower 32 bits of the hash, the slot capacity is below 2^32
+                uint32_t entry = emptySlot;
+            };
+
+            size_t mask() const { return m_slots.size() - 1; }
+
+            size_t findSlot(std::string_view key, const uint64_t keyHash) const {
+                if(m_slots.empty()) {
+                    return npos;
+                }
+                auto shortHash = static_cast<uint32_t>(keyHash);
+                for(auto slot = keyHash & mask(); m_slots[slot].entry != emptySlot; slot = (slot + 1) & mask()) {
+                    if(m_slots[slot].hash == shortHash && m_entries[m_slots[slot].entry].key == key) {
+                        return slot;
+                    }
+                }
+                return npos;
+            }
+
+            // The entry has to be in the table
+            size_t findEntrySlot(const uint64_t keyHash, const uint32_t entry) const {
+                auto slot = keyHash & mask();
+                while(m_slots[slot].entry != entry) {
+                    slot = (slot + 1) & mask();
+                }
+                return slot;
+            }
+
+            void placeSlot(const uint64_t keyHash, const uint32_t entry) {
+                auto slot = keyHash & mask();
+                while(m_slots[slot].entry != emptySlot) {
+                    slot = (slot + 1) & mask();
+                }
+                m_slots[slot] = Slot{static_cast<uint32_t>(keyHash), entry};
+            }
+
+            // Backward shift deletion: Slots after the gap move into it, unless their home slot lies behind the gap
+            void removeSlot(size_t gap) {
+                auto slot = gap;
+                while(true) {
+                    slot = (slot + 1) & mask();
+                    if(m_slots[slot].entry == emptySlot) {
+                        break;
+                    }
+                    auto home = m_slots[slot].hash & mask();
+                    auto stays = gap <= slot ? (gap < home && home <= slot) : (gap < home || home <= slot);
+                    if(!stays) {
+                        m_slots[gap] = m_slots[slot];
+                        gap = slot;
+                    }
+                }
+                m_slots[gap] = Slot{};
+            }
+
+            void rehash(const size_t capacity) {
+                m_slots.assign(capacity, Slot{});
+                for(size_t entry = 0; entry < m_entries.size(); ++entry) {
+                    placeSlot(m_entries[entry].hash, static_cast<uint32_t>(entry));
+                }
+            }
+
+            std::vector<Slot> m_slots;
+            std::vector<Entry> m_entries;
+    };
+}
+
+#endif /* __FLATHASHMAP_H__ */
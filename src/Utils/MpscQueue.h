@@ -0,0 +1,170 @@
+#ifndef __MPSCQUEUE_H__
+#define __MPSCQUEUE_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Rovi {
+    // Bounded lock-free multi-producer/single-consumer ring (after D. Vyukov's bounded MPMC queue)
+    // Every slot carries a sequence number: It is free for the producer of position p if sequence == p and holds
+    // the value of position p for the consumer if sequence == p + 1. Producers claim a position by a CAS on the
+    // enqueue position. The dequeue position is only advanced by the single consumer, so pop() and drain() need
+    // no atomic read-modify-write at all.
+    // push() does not block, it fails if the ring is full. The capacity is rounded up to a power of two.
+    // Statistics: pushed/popped are derived from the positions, rejected and contended are only counted on the
+    // slow paths, so the metrics do not add shared writes to an uncontended push().
+    template<typename T>
+    class MpscQueue {
+        public:
+            struct Statistics {
+                uint64_t pushed;        // Successful push()es
+                uint64_t popped;
+                uint64_t rejected;      // push() on a full ring
+                uint64_t contended;     // Retries of producers which lost the race for a position
+                size_t occupancy;       // Values currently in the ring
+                size_t highWatermark;   // Largest occupancy seen by the consumer
+            };
+
+            explicit MpscQueue(const size_t capacity)
+                : m_mask{roundUp(capacity) - 1}, m_cells{new Cell[m_mask + 1]},
+                  m_enqueuePosition{0}, m_rejected{0}, m_contended{0},
+                  m_dequeuePosition{0}, m_popped{0}, m_highWatermark{0} {
+                for(size_t i = 0; i <= m_mask; ++i) {
+                    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            ~MpscQueue() {
+                while(discard()) {
+                }
+            }
+
+            MpscQueue(const MpscQueue&) = delete;
+            MpscQueue& operator=(const MpscQueue&) = delete;
+
+            // Any thread. Returns false, if the ring is full.
+            template<typename... Args>
+            bool emplace(Args&&... args) {
+                auto position = m_enqueuePosition.load(std::memory_order_relaxed);
+                while(true) {
+                    auto& cell = m_cells[position & m_mask];
+                    auto sequence = cell.sequence.load(std::memory_order_acquire);
+                    auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                    if(difference == 0) {
+                        if(m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            new (&cell.storage) T(std::forward<Args>(args)...);
+                            cell.sequence.store(position + 1, std::memory_order_release);
+                            return true;
+                        }
+                        // 'position' has been reloaded by the failed CAS
+                        m_contended.fetch_add(1, std::memory_order_relaxed);
+                    } else if(difference < 0) {
+                        // The slot still holds the value of the previous round
+                        m_rejected.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    } else {
+                        // An other producer has claimed the position
+                        m_contended.fetch_add(1, std::memory_order_relaxed);
+                        position = m_enqueuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+            bool push(T value) {
+                return emplace(std::move(value));
+            }
+
+            // Consumer thread only. Returns false, if the ring is empty or the next value is not completely written yet.
+            bool pop(T& value) {
+                return drain([&value](T& next) { value = std::move(next); }, 1) == 1;
+            }
+
+            // Consumer thread only. Calls consumer(T&) for up to 'maxCount' values in FIFO order and returns the count.
+            template<typename Consumer>
+            size_t drain(Consumer&& consumer, const size_t maxCount = std::numeric_limits<size_t>::max()) {
+                auto position = m_dequeuePosition;
+                auto occupancy = m_enqueuePosition.load(std::memory_order_relaxed) - position;
+                if(occupancy > m_highWatermark.load(std::memory_order_relaxed)) {
+                    m_highWatermark.store(occupancy, std::memory_order_relaxed);
+                }
+
+                auto count = size_t{0};
+                for(; count < maxCount; ++count, ++position) {
+                    auto& cell = m_cells[position & m_mask];
+                    if(cell.sequence.load(std::memory_order_acquire) != position + 1) {
+                        break;
+                    }
+                    auto value = std::launder(reinterpret_cast<T*>(&cell.storage));
+                    consumer(*value);
+                    value->~T();
+                    // Free for the producer of the next round
+                    cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+                }
+                m_dequeuePosition = position;
+                m_popped.store(position, std::memory_order_relaxed);
+                return count;
+            }
+
+            size_t capacity() const {
+                return m_mask + 1;
+            }
+
+            // Approximation, if producers or the consumer are active
+            size_t size() const {
+                auto popped = m_popped.load(std::memory_order_relaxed);
+                auto pushed = m_enqueuePosition.load(std::memory_order_relaxed);
+                return pushed > popped ? pushed - popped : 0;
+            }
+            bool empty() const {
+                return size() == 0;
+            }
+
+            Statistics statistics() const {
+                auto statistics = Statistics{};
+                statistics.pushed = m_enqueuePosition.load(std::memory_order_relaxed);
+                statistics.popped = m_popped.load(std::memory_order_relaxed);
+                statistics.rejected = m_rejected.load(std::memory_order_relaxed);
+                statistics.contended = m_contended.load(std::memory_order_relaxed);
+                statistics.occupancy = size();
+                statistics.highWatermark = m_highWatermark.load(std::memory_order_relaxed);
+                return statistics;
+            }
+
+        protected:
+            struct Cell {
+                std::atomic<size_t> sequence;
+                typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+            };
+
+            static size_t roundUp(const size_t capacity) {
+                auto size = size_t{2};
+                while(size < capacity) {
+                    size *= 2;
+                }
+                return size;
+            }
+
+            bool discard() {
+                return drain([](T&) {}, 1) == 1;
+            }
+
+            const size_t m_mask;
+            const std::unique_ptr<Cell[]> m_cells;
+
+            // Written by the producers
+            alignas(64) std::atomic<size_t> m_enqueuePosition;
+            alignas(64) std::atomic<uint64_t> m_rejected;
+            std::atomic<uint64_t> m_contended;
+
+            // Written by the consumer. m_popped mirrors the position for statistics() and size() on other threads.
+            alignas(64) size_t m_dequeuePosition;
+            std::atomic<size_t> m_popped;
+            std::atomic<size_t> m_highWatermark;
+    };
+}
+
+#endif /* __MPSCQUEUE_H__ */
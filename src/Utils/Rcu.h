@@ -0,0 +1,190 @@
+#ifndef __RCU_H__
+#define __RCU_H__
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Rovi {
+    // Epoch based read-copy-update for data which is read by many threads and rarely changed
+    // Every reader thread owns a slot (one cache line) in which it announces the global epoch while it is inside
+    // a read-side critical section. Readers therefore only write their own cache line: No lock, no shared
+    // reference count. A writer swaps in a new version, advances the epoch and retires the old version. It is
+    // freed as soon as no reader announces an epoch from before the swap.
+    // The number of concurrent reader threads is limited to maxReaders, a thread keeps its slot until it exits.
+    class RcuDomain {
+        public:
+            static constexpr size_t maxReaders = 256;
+
+            // Never destroyed, so RcuValues with static storage duration and exiting threads can still use it
+            static RcuDomain& instance() {
+                static auto domain = new RcuDomain{};
+                return *domain;
+            }
+
+            // Read-side critical section, may be nested
+            void enter() {
+                auto& state = threadState();
+                if(state.depth++ == 0) {
+                    if(state.slot == nullptr) {
+                        state.slot = acquireSlot();
+                    }
+                    state.slot->epoch.store(m_epoch.load());
+                }
+            }
+            void leave() {
+                auto& state = threadState();
+                if(--state.depth == 0) {
+                    state.slot->epoch.store(0, std::memory_order_release);
+                }
+            }
+
+            // Writer side: 'deleter(pointer)' is called once all readers which might still see it have left.
+            // The pointer has to be unreachable for new readers, i.e. already replaced.
+            void retire(void* pointer, void (*deleter)(void*)) {
+                auto lock = std::lock_guard<std::mutex>{m_mutex};
+                auto epoch = m_epoch.fetch_add(1) + 1;
+                m_retired.push_back(Retired{pointer, deleter, epoch});
+                reclaim();
+            }
+
+            // Number of retired versions which are not freed yet
+            size_t pending() const {
+                auto lock = std::lock_guard<std::mutex>{m_mutex};
+                return m_retired.size();
+            }
+
+        protected:
+            struct alignas(64) Slot {
+                std::atomic<uint64_t> epoch{0};     // 0: Not inside a critical section
+                std::atomic<bool> used{false};
+            };
+
+            struct Retired {
+                void* pointer;
+                void (*deleter)(void*);
+                uint64_t epoch;                     // First epoch in which the pointer is unreachable
+            };
+
+            struct ThreadState {
+                Slot* slot = nullptr;
+                uint32_t depth = 0;
+
+                ~ThreadState() {
+                    if(slot != nullptr) {
+                        slot->epoch.store(0);
+                        slot->used.store(false, std::memory_order_release);
+                    }
+                }
+            };
+
+            RcuDomain() : m_slots{}, m_epoch{1}, m_mutex{}, m_retired{} {}
+
+            static ThreadState& threadState() {
+                thread_local ThreadState state;
+                return state;
+            }
+
+            Slot* acquireSlot() {
+                while(true) {
+                    for(auto& slot : m_slots) {
+                        auto used = false;
+                        if(!slot.used.load(std::memory_order_relaxed) && slot.used.compare_exchange_strong(used, true)) {
+                            return &slot;
+                        }
+                    }
+                    // All slots are taken by running threads
+                    std::this_thread::yield();
+                }
+            }
+
+            // Called with m_mutex held
+            void reclaim() {
+                auto oldestReader = std::numeric_limits<uint64_t>::max();
+                for(auto& slot : m_slots) {
+                    auto epoch = slot.epoch.load();
+                    if(epoch != 0) {
+                        oldestReader = std::min(oldestReader, epoch);
+                    }
+                }
+                auto freed = std::partition(m_retired.begin(), m_retired.end(),
+                    [oldestReader](const Retired& retired) { return retired.epoch > oldestReader; });
+                for(auto it = freed; it != m_retired.end(); ++it) {
+                    it->deleter(it->pointer);
+                }
+                m_retired.erase(freed, m_retired.end());
+            }
+
+            std::array<Slot, maxReaders> m_slots;
+            alignas(64) std::atomic<uint64_t> m_epoch;
+            mutable std::mutex m_mutex;
+            std::vector<Retired> m_retired;
+    };
+
+
+    // Immutable value of type T published via RCU
+    // read() returns a guard giving access to the current version. The version stays valid until the guard is
+    // destroyed, even if a writer publishes a new one in the meantime. Readers should not keep guards for long,
+    // as every version published meanwhile cannot be freed.
+    template<typename T>
+    class RcuValue {
+        public:
+            class ReadGuard {
+                public:
+                    explicit ReadGuard(const T* value) : m_value{value}, m_active{true} {}
+                    ReadGuard(ReadGuard&& other) : m_value{other.m_value}, m_active{other.m_active} { other.m_active = false; }
+                    ReadGuard(const ReadGuard&) = delete;
+                    ReadGuard& operator=(const ReadGuard&) = delete;
+                    ReadGuard& operator=(ReadGuard&&) = delete;
+                    ~ReadGuard() {
+                        if(m_active) {
+                            RcuDomain::instance().leave();
+                        }
+                    }
+
+                    const T& operator*() const { return *m_value; }
+                    const T* operator->() const { return m_value; }
+                    const T* get() const { return m_value; }
+
+                protected:
+                    const T* m_value;
+                    bool m_active;
+            };
+
+            RcuValue() : m_value{nullptr} {}
+            explicit RcuValue(std::unique_ptr<const T> value) : m_value{value.release()} {}
+            ~RcuValue() {
+                retire(m_value.load());
+            }
+            RcuValue(const RcuValue&) = delete;
+            RcuValue& operator=(const RcuValue&) = delete;
+
+            ReadGuard read() const {
+                RcuDomain::instance().enter();
+                return ReadGuard{m_value.load()};
+            }
+
+            // Replace the current version. Readers holding a guard keep seeing the previous one.
+            void publish(std::unique_ptr<const T> value) {
+                retire(m_value.exchange(value.release()));
+            }
+
+        protected:
+            static void retire(const T* value) {
+                if(value != nullptr) {
+                    RcuDomain::instance().retire(const_cast<T*>(value), [](void* pointer) { delete static_cast<T*>(pointer); });
+                }
+            }
+
+            std::atomic<const T*> m_value;
+    };
+}
+
+#endif /* __RCU_H__ */
@@ -2,15 +2,32 @@
 #define __STRINGUTILS_H__
 
 #include <stdio.h>
+#include <stdint.h>
+#include <charconv>
 #include <string>
+#include <string_view>
+#include <iterator>
+#include <limits>
+#include <type_traits>
 #include <iostream>
 #include <sstream>
 #include <vector>
 #include <algorithm>
 
+#include "CharacterClass.h"
+
 namespace Rovi {
     class StringUtils {
         public:
+        // Character types and bool are written as characters/flags by std::ostream and are therefore excluded
+        template<typename T>
+        struct isFormattableInteger : std::integral_constant<bool, 
+            std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value && 
+            !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value> {};
+        template<typename T>
+        struct isFormattableNumber : std::integral_constant<bool, 
+            isFormattableInteger<T>::value || std::is_floating_point<T>::value> {};
+
         static std::string fullfile(const std::string& baseDirectory, const std::string& additionDirectoryOrFile) {
             auto addSlashIfRequired = [](const std::string& s) {
                 std::string ret = s;
@@ -23,19 +40,159 @@ namespace Rovi {
             return addSlashIfRequired(baseDirectory) + addSlashIfRequired(additionDirectoryOrFile);
         }
 
+        // Lazy, non-allocating tokenizer. The tokens are views into the tokenized string, which has to outlive the tokenizer, e.g.
+        //   for(auto token : StringUtils::tokenize("123,456,789", ',')) { ... }
+        // Behaves like repeated std::getline() calls: A leading delimiter results in an empty first token,
+        // a tailing delimiter does not result in an empty last token and an empty string has no tokens.
+        class Tokenizer {
+            public:
+            class Iterator {
+                public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = std::string_view;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const std::string_view*;
+                using reference = const std::string_view&;
+
+                Iterator() : m_str{}, m_delimiter{'\0'}, m_pos{std::string_view::npos}, m_token{} {
+                }
+                Iterator(std::string_view str, const char delimiter) : m_str{str}, m_delimiter{delimiter}, m_pos{0}, m_token{} {
+                    if(m_str.empty()) {
+                        m_pos = std::string_view::npos;
+                    } else {
+                        findToken();
+                    }
+                }
+
+                reference operator*() const { return m_token; }
+                pointer operator->() const { return &m_token; }
+
+                Iterator& operator++() {
+                    m_pos += m_token.size() + 1;        // Skip token and delimiter
+                    if(m_pos >= m_str.size()) {
+                        m_pos = std::string_view::npos;
+                    } else {
+                        findToken();
+                    }
+                    return *this;
+                }
+                Iterator operator++(int) {
+                    auto it = *this;
+                    ++(*this);
+                    return it;
+                }
+
+                bool operator==(const Iterator& rhs) const { return m_pos == rhs.m_pos; }
+                bool operator!=(const Iterator& rhs) const { return m_pos != rhs.m_pos; }
+
+                private:
+                void findToken() {
+                    auto next = m_str.find(m_delimiter, m_pos);
+                    m_token = m_str.substr(m_pos, next == std::string_view::npos ? std::string_view::npos : next - m_pos);
+                }
+
+                std::string_view m_str;
+                char m_delimiter;
+                size_t m_pos;
+                std::string_view m_token;
+            };
+
+            Tokenizer(std::string_view str, const char delimiter) : m_str{str}, m_delimiter{delimiter} {
+            }
+
+            Iterator begin() const { return Iterator{m_str, m_delimiter}; }
+            Iterator end() const { return Iterator{}; }
+
+            private:
+            std::string_view m_str;
+            char m_delimiter;
+        };
+
+        static Tokenizer tokenize(std::string_view str, const char delimiter) {
+            return Tokenizer{str, delimiter};
+        }
+
         static std::vector<std::string> splitString(const std::string& s, char delimiter) {
-        std::vector<std::string> tokens;
-        std::string token;
-        std::istringstream tokenStream(s);
-        while (std::getline(tokenStream, token, delimiter))
-        {
-            tokens.push_back(token);
+            std::vector<std::string> tokens;
+            for(auto token : tokenize(s, delimiter)) {
+                tokens.emplace_back(token);
+            }
+            return tokens;
         }
-        return tokens;
+
+        // Buffer size sufficient for every number written by formatNumber()
+        static constexpr size_t maxNumberLength = 32;
+
+        // Write the decimal representation of an integer into buffer (no stream, no heap).
+        // Returns the number of characters written or 0 if the buffer is too small. The buffer is NOT null terminated.
+        template<typename T, typename std::enable_if<isFormattableInteger<T>::value, int>::type = 0>
+        static size_t formatNumber(char* buffer, const size_t size, T value) {
+            using UnsignedT = typename std::make_unsigned<T>::type;
+            static const char digitPairs[] = 
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+
+            char reversed[maxNumberLength];
+            auto pos = maxNumberLength;
+            auto negative = value < 0;
+            // Negate in the unsigned domain, so that the minimum value does not overflow
+            auto magnitude = negative ? static_cast<UnsignedT>(UnsignedT{0} - static_cast<UnsignedT>(value)) : static_cast<UnsignedT>(value);
+            while(magnitude >= 100) {
+                auto idx = static_cast<size_t>(magnitude % 100) * 2;
+                magnitude /= 100;
+                reversed[--pos] = digitPairs[idx + 1];
+                reversed[--pos] = digitPairs[idx];
+            }
+            if(magnitude >= 10) {
+                auto idx = static_cast<size_t>(magnitude) * 2;
+                reversed[--pos] = digitPairs[idx + 1];
+                reversed[--pos] = digitPairs[idx];
+            } else {
+                reversed[--pos] = static_cast<char>('0' + magnitude);
+            }
+            if(negative) {
+                reversed[--pos] = '-';
+            }
+
+            auto length = maxNumberLength - pos;
+            if(length > size) {
+                return 0;
+            }
+            std::copy(reversed + pos, reversed + maxNumberLength, buffer);
+            return length;
         }
 
-        template<typename T>
+        // Write a floating point number into buffer using the same representation as the default
+        // std::ostream formatting (i.e. "%g" with 6 significant digits), but without a stream or heap allocation.
+        // std::to_chars does not depend on the locale, so the decimal separator is always '.' (unlike snprintf).
+        // Returns the number of characters written or 0 if the buffer is too small. The buffer is NOT null terminated.
+        template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+        static size_t formatNumber(char* buffer, const size_t size, T value) {
+            auto result = std::to_chars(buffer, buffer + size, static_cast<double>(value), std::chars_format::general, 6);
+            if(result.ec != std::errc{}) {
+                return 0;
+            }
+            return static_cast<size_t>(result.ptr - buffer);
+        }
+
+        // Append the representation of formatNumber() to an existing string, e.g. std::string or std::pmr::string
+        template<typename String, typename T>
+        static void appendNumber(String& str, T value) {
+            char buffer[maxNumberLength];
+            auto length = formatNumber(buffer, sizeof(buffer), value);
+            str.append(buffer, length);
+        }
+
+        // Numbers are formatted by formatNumber(), all other types are written using a std::stringstream
+        template<typename T, typename std::enable_if<isFormattableNumber<T>::value, int>::type = 0>
         static std::string toString(T value) {
+            char buffer[maxNumberLength];
+            auto length = formatNumber(buffer, sizeof(buffer), value);
+            return std::string(buffer, length);
+        }
+        template<typename T, typename std::enable_if<!isFormattableNumber<T>::value, int>::type = 0>
+        static std::string toString(const T& value) {
             std::stringstream ss;
             ss << value;
             return ss.str();
@@ -50,23 +207,17 @@ namespace Rovi {
         }
 
 
+        // Prefer a precomputed CharacterClass, if the same set of characters is checked repeatedly
         static bool checkStringForAllowedCharacters(const std::string& inputString, const std::string& allowedChars) {
-            bool ok = true;
-            for(auto& character : inputString) {
-                ok = allowedChars.find(character) != std::string::npos;
-                if(!ok) {
-                    break;
-                }
-            }
-
-            return ok;
+            return CharacterClass{allowedChars}.matchesAll(inputString);
         }
 
-        static std::string trim(const std::string& str, const std::string& whitespace = " \t")
+        // Non-allocating version of trim(). The result is a view into str.
+        static std::string_view trimView(std::string_view str, std::string_view whitespace = " \t")
         {
             const auto strBegin = str.find_first_not_of(whitespace);
-            if (strBegin == std::string::npos)
-                return ""; // no content
+            if (strBegin == std::string_view::npos)
+                return {}; // no content
 
             const auto strEnd = str.find_last_not_of(whitespace);
             const auto strRange = strEnd - strBegin + 1;
@@ -74,11 +225,16 @@ namespace Rovi {
             return str.substr(strBegin, strRange);
         }
 
+        static std::string trim(const std::string& str, const std::string& whitespace = " \t")
+        {
+            return std::string{trimView(str, whitespace)};
+        }
+
         static std::string removeCharsFromString(const std::string& str, const std::string& charsToRemove) {
-            auto retStr = str;
-            for ( unsigned int i = 0; i < charsToRemove.size(); ++i ) {
-                retStr.erase( remove(retStr.begin(), retStr.end(), charsToRemove[i]), retStr.end() );
-            }
+            const auto removedChars = CharacterClass{charsToRemove};
+            auto retStr = std::string{};
+            retStr.reserve(str.size());
+            std::copy_if(str.begin(), str.end(), std::back_inserter(retStr), [&removedChars](const char c) { return !removedChars.contains(c); });
             return retStr;
         }
     };
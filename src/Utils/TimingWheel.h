@@ -0,0 +1,204 @@
+#ifndef __TIMINGWHEEL_H__
+#define __TIMINGWHEEL_H__
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include <utility>
+#include <limits>
+
+namespace Rovi {
+    // Hierarchical timing wheel (Varghese & Lauck, as used by the Linux kernel timers)
+    // Time is measured in integer ticks. There are 'levels' wheels with 64 slots each, level n covers
+    // 64^(n+1) ticks. schedule() and cancel() are O(1), advancing by one tick is O(1) amortized: A timer is
+    // moved down at most once per level ('cascading') before it expires from level 0.
+    // Timers further in the future than the range of the wheel are parked in the last level and re-inserted.
+    template<typename T, size_t levels = 4>
+    class TimingWheel {
+        public:
+            using TimerID = uint64_t;
+            static constexpr TimerID invalidTimer = std::numeric_limits<TimerID>::max();
+
+            explicit TimingWheel(const uint64_t startTick = 0) : m_current{startTick}, m_size{0} {
+                for(auto& level : m_slots) {
+                    level.fill(none);
+                }
+            }
+
+            // Fires in the first advance() reaching 'expiryTick'. Timers in the past fire in the next advance().
+            TimerID schedule(const uint64_t expiryTick, T value) {
+                auto index = allocate();
+                auto& timer = m_timers[index];
+                timer.expiry = expiryTick;
+                timer.value = std::move(value);
+                timer.active = true;
+                insert(index);
+                ++m_size;
+                return (static_cast<TimerID>(timer.generation) << 32) | index;
+            }
+
+            bool cancel(const TimerID id) {
+                auto index = static_cast<uint32_t>(id & 0xFFFFFFFF);
+                if(index >= m_timers.size() || !m_timers[index].active || m_timers[index].generation != (id >> 32)) {
+                    return false;
+                }
+                unlink(index);
+                release(index);
+                --m_size;
+                return true;
+            }
+
+            // Process all ticks up to and including 'tick'. callback(TimerID, T& value, uint64_t expiryTick)
+            // is called for every expired timer, tick by tick. The callback may schedule or cancel timers.
+            // Returns the number of expired timers.
+            template<typename Callback>
+            size_t advance(const uint64_t tick, Callback&& callback) {
+                auto expired = size_t{0};
+                while(m_current <= tick) {
+                    if(m_size == 0) {
+                        // Nothing to cascade or expire
+                        m_current = tick + 1;
+                        break;
+                    }
+                    auto slot = m_current & slotMask;
+                    if(slot == 0) {
+                        cascade();
+                    }
+                    // Detach the slot, so timers scheduled by the callback for the current tick end up in the next one
+                    auto index = m_slots[0][slot];
+                    m_slots[0][slot] = none;
+                    auto expiryTick = m_current;
+                    ++m_current;
+                    m_expired.clear();
+                    while(index != none) {
+                        auto next = m_timers[index].next;
+                        if(m_timers[index].expiry > expiryTick) {
+                            // Parked timer (beyond the range of the wheel)
+                            insert(index);
+                        } else {
+                            auto id = (static_cast<TimerID>(m_timers[index].generation) << 32) | index;
+                            m_expired.push_back(Expired{id, std::move(m_timers[index].value), m_timers[index].expiry});
+                            release(index);
+                            --m_size;
+                        }
+                        index = next;
+                    }
+                    // The slot is completely processed before the callbacks, which may modify the wheel
+                    for(auto& timer : m_expired) {
+                        callback(timer.id, timer.value, timer.expiry);
+                    }
+                    expired += m_expired.size();
+                }
+                return expired;
+            }
+
+            // All ticks before currentTick() have been processed
+            uint64_t currentTick() const { return m_current; }
+            size_t size() const { return m_size; }
+            bool empty() const { return m_size == 0; }
+
+        protected:
+            static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+            static constexpr uint64_t slotBits = 6;
+            static constexpr uint64_t slotsPerLevel = uint64_t{1} << slotBits;
+            static constexpr uint64_t slotMask = slotsPerLevel - 1;
+            static constexpr uint64_t maxDelta = (uint64_t{1} << (slotBits * levels)) - 1;
+
+            struct Timer {
+                uint64_t expiry = 0;
+                uint32_t prev = none;
+                uint32_t next = none;
+                uint32_t generation = 0;
+                uint8_t level = 0;
+                uint8_t slot = 0;
+                bool active = false;
+                T value{};
+            };
+
+            struct Expired {
+                TimerID id;
+                T value;
+                uint64_t expiry;
+            };
+
+            uint32_t allocate() {
+                if(m_free.empty()) {
+                    m_timers.emplace_back();
+                    return static_cast<uint32_t>(m_timers.size() - 1);
+                }
+                auto index = m_free.back();
+                m_free.pop_back();
+                return index;
+            }
+
+            void release(const uint32_t index) {
+                auto& timer = m_timers[index];
+                timer.active = false;
+                timer.value = T{};
+                ++timer.generation;
+                m_free.push_back(index);
+            }
+
+            // Put the timer into the slot matching its distance to the current tick
+            void insert(const uint32_t index) {
+                auto& timer = m_timers[index];
+                auto placement = timer.expiry < m_current ? m_current : timer.expiry;
+                if(placement - m_current > maxDelta) {
+                    placement = m_current + maxDelta;
+                }
+                auto delta = placement - m_current;
+                auto level = size_t{0};
+                while(level + 1 < levels && delta >= (uint64_t{1} << (slotBits * (level + 1)))) {
+                    ++level;
+                }
+                auto slot = (placement >> (slotBits * level)) & slotMask;
+
+                timer.level = static_cast<uint8_t>(level);
+                timer.slot = static_cast<uint8_t>(slot);
+                timer.prev = none;
+                timer.next = m_slots[level][slot];
+                if(timer.next != none) {
+                    m_timers[timer.next].prev = index;
+                }
+                m_slots[level][slot] = index;
+            }
+
+            void unlink(const uint32_t index) {
+                auto& timer = m_timers[index];
+                if(timer.prev != none) {
+                    m_timers[timer.prev].next = timer.next;
+                } else {
+                    m_slots[timer.level][timer.slot] = timer.next;
+                }
+                if(timer.next != none) {
+                    m_timers[timer.next].prev = timer.prev;
+                }
+            }
+
+            // Called when level 0 wraps around: Move the timers of the current slot of the next level(s) down
+            void cascade() {
+                for(size_t level = 1; level < levels; ++level) {
+                    auto slot = (m_current >> (slotBits * level)) & slotMask;
+                    auto index = m_slots[level][slot];
+                    m_slots[level][slot] = none;
+                    while(index != none) {
+                        auto next = m_timers[index].next;
+                        insert(index);
+                        index = next;
+                    }
+                    if(slot != 0) {
+                        break;
+                    }
+                }
+            }
+
+            uint64_t m_current;
+            size_t m_size;
+            std::array<std::array<uint32_t, slotsPerLevel>, levels> m_slots;
+            std::vector<Timer> m_timers;
+            std::vector<uint32_t> m_free;
+            std::vector<Expired> m_expired;
+    };
+}
+
+#endif /* __TIMINGWHEEL_H__ */
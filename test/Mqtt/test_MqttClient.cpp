@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include "Mqtt/MqttClient.h"
+#include "Mqtt/FakeBroker.h"
+#include "Mqtt/OutboundQueue.h"
+
+#include <sys/socket.h>
+#include <map>
+#include <thread>
+
+namespace Rovi {
+    namespace Mqtt {
+        template<typename Predicate>
+        static bool runUntil(EventLoop& loop, Predicate predicate, const std::chrono::milliseconds timeout = std::chrono::seconds{5}) {
+            auto deadline = Clock::now() + timeout;
+            while(!predicate()) {
+                if(Clock::now() > deadline) {
+                    return false;
+                }
+                loop.runOnce(std::chrono::milliseconds{10});
+            }
+            return true;
+        }
+
+        static std::shared_ptr<Homie::Device> createDevice(const std::string& name, const std::string& mac) {
+            auto hwInfo = std::make_shared<Homie::HWInfo>(mac, "192.168.0.10", "esp32");
+            return std::make_shared<Homie::Device>(name, hwInfo, "weatherstation-firmware",
+                std::make_shared<Homie::Version>(1, 0, 0), std::chrono::seconds{60});
+        }
+
+        class MqttClientTest : public ::testing::Test {
+            protected:
+                void SetUp() override {
+                    ASSERT_TRUE(broker.listen());
+                    broker.setPublishHandler([this](const PublishView& publish) {
+                        messages[std::string{publish.topic}] = std::string{publish.payload};
+                        ++received;
+                    });
+                    options.clientID = "gateway";
+                    options.keepAlive_s = 10;
+                }
+
+                EventLoop loop;
+                FakeBroker broker{loop};
+                ConnectOptions options;
+                std::map<std::string, std::string> messages;
+                size_t received = 0;
+        };
+
+        TEST_F(MqttClientTest, connect) {
+            auto device = createDevice("Super car", "DE:AD:BE:EF:FE:ED");
+            auto client = MqttClient{loop, options};
+            client.addDevice(device);
+            ASSERT_TRUE(client.connect("127.0.0.1", broker.port()));
+            EXPECT_EQ(client.state(), MqttClient::State::connecting);
+
+            auto expected = device->connectionInitialized().size();
+            ASSERT_TRUE(runUntil(loop, [&]() { return client.state() == MqttClient::State::connected && received == expected; }));
+            EXPECT_EQ(messages["homie/super-car-deadbeeffeed/$state"], "ready");
+            EXPECT_EQ(messages["homie/super-car-deadbeeffeed/$name"], "Super car");
+            EXPECT_EQ(client.statistics().publishedMessages, expected);
+            EXPECT_EQ(broker.sessionCount(), size_t(1));
+
+            // Stats
+            received = 0;
+            EXPECT_TRUE(client.publishUpdate(*device));
+            expected = device->update().size();
+            ASSERT_TRUE(runUntil(loop, [&]() { return received == expected; }));
+            EXPECT_EQ(messages.count("homie/super-car-deadbeeffeed/$stats/uptime"), size_t(1));
+
+            // Devices added later are initialized immediately
+            auto second = createDevice("Second", "DE:AD:BE:EF:FE:EE");
+            client.addDevice(second);
+            ASSERT_TRUE(runUntil(loop, [&]() { return messages.count("homie/second-deadbeeffeee/$state") == 1; }));
+            EXPECT_EQ(client.deviceCount(), size_t(2));
+            EXPECT_EQ(client.device("second-deadbeeffeee"), second);
+
+            client.disconnect();
+            ASSERT_TRUE(runUntil(loop, [&]() { return client.state() == MqttClient::State::disconnected && broker.sessionCount() == 0; }));
+            EXPECT_EQ(messages["homie/super-car-deadbeeffeed/$state"], "disconnected");
+            EXPECT_EQ(device->state(), Homie::Device::State::disconnected);
+        }
+
+        TEST_F(MqttClientTest, inbound) {
+            auto device = createDevice("Super car", "DE:AD:BE:EF:FE:ED");
+            auto topics = std::vector<std::pair<std::string, std::string>>{};
+            device->setMessageHandler([&topics](std::string_view topic, std::string_view payload) {
+                topics.emplace_back(topic, payload);
+            });
+            auto client = MqttClient{loop, options};
+            client.addDevice(device);
+            ASSERT_TRUE(client.connect("127.0.0.1", broker.port()));
+            ASSERT_TRUE(runUntil(loop, [&]() { return client.state() == MqttClient::State::connected && broker.subscriptionCount() == 1; }));
+
+            broker.publish("homie/super-car-deadbeeffeed/light/power/set", "true");
+            broker.publish("homie/super-car-deadbeeffeed/light/power", "false");        // Not subscribed
+            broker.publish("homie/other-device/light/power/set", "true");
+            ASSERT_TRUE(runUntil(loop, [&]() { return client.statistics().receivedMessages == 1; }));
+            ASSERT_EQ(topics.size(), size_t(1));
+            EXPECT_EQ(topics[0].first, "light/power/set");
+            EXPECT_EQ(topics[0].second, "true");
+
+            // A route for a single property takes precedence over the route of the device
+            auto color = std::string{};
+            client.router().add("homie/super-car-deadbeeffeed/light/color/set", [&color](std::string_view, std::string_view payload) {
+                color = std::string{payload};
+            });
+            broker.publish("homie/super-car-deadbeeffeed/light/color/set", "255,0,0");
+            ASSERT_TRUE(runUntil(loop, [&]() { return client.statistics().receivedMessages == 2; }));
+            EXPECT_EQ(color, "255,0,0");
+            EXPECT_EQ(topics.size(), size_t(1));
+        }
+
+        TEST_F(MqttClientTest, partialWrites) {
+            auto client = MqttClient{loop, options};
+            ASSERT_TRUE(client.connect("127.0.0.1", broker.port()));
+            ASSERT_TRUE(runUntil(loop, [&]() { return client.state() == MqttClient::State::connected; }));
+            auto sendBuffer = 65536;
+            setsockopt(client.fd(), SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+
+            auto buffer = Homie::AttributeBuffer{};
+            constexpr size_t count = 2000;
+            for(size_t i = 0; i < count; ++i) {
+                buffer.append(Homie::TopicType{"test", std::to_string(i)}, std::string(1000, static_cast<char>('a' + i % 26)));
+            }
+            auto order = std::vector<std::string>{};
+            broker.setPublishHandler([&](const PublishView& publish) {
+                order.emplace_back(publish.topic);
+                EXPECT_EQ(publish.payload.size(), size_t(1000));
+                EXPECT_EQ(publish.payload.back(), static_cast<char>('a' + std::stoul(std::string{publish.topic.substr(5)}) % 26));
+            });
+            EXPECT_TRUE(client.publish(buffer));
+            // The socket can not take 2MB at once
+            EXPECT_GT(client.pendingBytes(), size_t(0));
+            // The buffer is not referenced after publish()
+            buffer.clear();
+
+            ASSERT_TRUE(runUntil(loop, [&]() { return order.size() == count; }));
+            EXPECT_EQ(client.pendingBytes(), size_t(0));
+            for(size_t i = 0; i < count; ++i) {
+                EXPECT_EQ(order[i], "test/" + std::to_string(i));
+            }
+        }
+
+        TEST_F(MqttClientTest, outboundQueue) {
+            auto client = MqttClient{loop, options};
+            auto queue = OutboundQueue{loop, client, 1024, 64};
+            ASSERT_TRUE(client.connect("127.0.0.1", broker.port()));
+            ASSERT_TRUE(runUntil(loop, [&]() { return client.state() == MqttClient::State::connected; }));
+
+            // Producer threads push without touching the client, the loop thread publishes
+            constexpr auto producers = 4;
+            constexpr auto perProducer = 250;
+            auto threads = std::vector<std::thread>{};
+            for(auto producer = 0; producer < producers; ++producer) {
+                threads.emplace_back([&queue, producer]() {
+                    for(auto i = 0; i < perProducer; ++i) {
+                        while(!queue.push("test/" + std::to_string(producer) + "/" + std::to_string(i), std::to_string(i))) {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+            ASSERT_TRUE(runUntil(loop, [&]() { return received == producers * perProducer; }));
+            for(auto& thread : threads) {
+                thread.join();
+            }
+            EXPECT_EQ(messages["test/3/249"], "249");
+
+            auto buffer = Homie::AttributeBuffer{};
+            buffer.append(Homie::TopicType{"test", "buffer"}, "1");
+            buffer.append(Homie::TopicType{"test", "buffer", "second"}, "2");
+            EXPECT_EQ(queue.push(buffer), size_t(2));
+            ASSERT_TRUE(runUntil(loop, [&]() { return received == producers * perProducer + 2; }));
+            EXPECT_EQ(messages["test/buffer/second"], "2");
+
+            auto statistics = queue.statistics();
+            EXPECT_EQ(statistics.pushed, uint64_t(producers * perProducer + 2));
+            EXPECT_EQ(statistics.popped, statistics.pushed);
+            // Batches of up to 64 records
+            EXPECT_GE(queue.batches(), uint64_t(producers * perProducer / 64));
+            EXPECT_LT(queue.batches(), statistics.pushed);
+        }
+
+        TEST_F(MqttClientTest, keepAlive) {
+            auto device = createDevice("Super car", "DE:AD:BE:EF:FE:ED");
+            options.keepAlive_s = 1;
+            auto client = MqttClient{loop, options};
+            client.addDevice(device);
+            ASSERT_TRUE(client.connect("127.0.0.1", broker.port()));
+            ASSERT_TRUE(runUntil(loop, [&]() { return client.state() == MqttClient::State::connected; }));
+
+            // Nothing sent for more than the keepalive interval
+            auto now = Clock::now();
+            client.handleTick(now + std::chrono::seconds{2});
+            EXPECT_EQ(client.statistics().pingRequests, uint64_t(1));
+            EXPECT_LE(client.nextDeadline(), now + std::chrono::seconds{3});
+            ASSERT_TRUE(runUntil(loop, [&]() { return broker.pingRequests() == 1 && client.nextDeadline() < now + std::chrono::seconds{2}; }));
+
+            // No PINGRESP -> connection lost
+            broker.setRespondToPing(false);
+            now = Clock::now();
+            client.handleTick(now + std::chrono::seconds{2});
+            EXPECT_EQ(client.statistics().pingRequests, uint64_t(2));
+            client.handleTick(now + std::chrono::seconds{4});
+            EXPECT_EQ(client.state(), MqttClient::State::disconnected);
+            EXPECT_EQ(device->state(), Homie::Device::State::lost);
+        }
+
+        TEST(MqttPacket, topicMatches) {
+            EXPECT_TRUE(topicMatches("a/b", "a/b"));
+            EXPECT_FALSE(topicMatches("a/b", "a/c"));
+            EXPECT_FALSE(topicMatches("a", "a/b"));
+            EXPECT_FALSE(topicMatches("a/b", "a"));
+            EXPECT_TRUE(topicMatches("a/+", "a/b"));
+            EXPECT_FALSE(topicMatches("a/+", "a"));
+            EXPECT_FALSE(topicMatches("a/+", "a/b/c"));
+            EXPECT_TRUE(topicMatches("a/#", "a"));
+            EXPECT_TRUE(topicMatches("a/#", "a/b/c"));
+            EXPECT_TRUE(topicMatches("#", "a/b/c"));
+            EXPECT_FALSE(topicMatches("#", "$SYS/load"));
+            EXPECT_TRUE(topicMatches("homie/+/+/+/set", "homie/dev/node/prop/set"));
+            EXPECT_TRUE(topicMatches("a/", "a/"));
+            EXPECT_TRUE(topicMatches("a/+", "a/"));
+        }
+    }
+}
@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include "Mqtt/MqttPacket.h"
+#include "Device.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Rovi {
+    namespace Mqtt {
+        static std::vector<uint8_t> readAll(int fd, const size_t bytes) {
+            auto buffer = std::vector<uint8_t>(bytes);
+            auto received = size_t{0};
+            while(received < bytes) {
+                auto n = read(fd, buffer.data() + received, bytes - received);
+                if(n <= 0) {
+                    break;
+                }
+                received += static_cast<size_t>(n);
+            }
+            buffer.resize(received);
+            return buffer;
+        }
+
+        static std::vector<uint8_t> flatten(PublishBatch& batch) {
+            auto buffer = std::vector<uint8_t>{};
+            for(auto& vec : batch.iovecs()) {
+                auto data = static_cast<const uint8_t*>(vec.iov_base);
+                buffer.insert(buffer.end(), data, data + vec.iov_len);
+            }
+            return buffer;
+        }
+
+        TEST(MqttPacket, remainingLength) {
+            uint8_t buffer[4];
+            EXPECT_EQ(encodeRemainingLength(buffer, 0), size_t(1));
+            EXPECT_EQ(buffer[0], 0x00);
+            EXPECT_EQ(encodeRemainingLength(buffer, 127), size_t(1));
+            EXPECT_EQ(buffer[0], 0x7F);
+            EXPECT_EQ(encodeRemainingLength(buffer, 128), size_t(2));
+            EXPECT_EQ(buffer[0], 0x80);
+            EXPECT_EQ(buffer[1], 0x01);
+            EXPECT_EQ(encodeRemainingLength(buffer, 16383), size_t(2));
+            EXPECT_EQ(encodeRemainingLength(buffer, 16384), size_t(3));
+            EXPECT_EQ(encodeRemainingLength(buffer, maxRemainingLength), size_t(4));
+            EXPECT_EQ(buffer[3], 0x7F);
+        }
+
+        TEST(MqttPacket, publish) {
+            auto packet = encodePublish("a/b", "xyz", QoS::atMostOnce, true);
+            auto expected = std::vector<uint8_t>{0x31, 8, 0, 3, 'a', '/', 'b', 'x', 'y', 'z'};
+            EXPECT_EQ(packet, expected);
+
+            auto view = PacketView{};
+            auto consumed = size_t{0};
+            EXPECT_EQ(decodePacket(packet.data(), packet.size(), view, consumed), DecodeResult::complete);
+            EXPECT_EQ(consumed, packet.size());
+            auto publish = PublishView{};
+            EXPECT_TRUE(decodePublish(view, publish));
+            EXPECT_EQ(publish.topic, "a/b");
+            EXPECT_EQ(publish.payload, "xyz");
+            EXPECT_EQ(publish.qos, QoS::atMostOnce);
+            EXPECT_TRUE(publish.retain);
+
+            packet = encodePublish("a/b", "", QoS::atLeastOnce, false, 0x1234);
+            EXPECT_EQ(decodePacket(packet.data(), packet.size(), view, consumed), DecodeResult::complete);
+            EXPECT_TRUE(decodePublish(view, publish));
+            EXPECT_EQ(publish.qos, QoS::atLeastOnce);
+            EXPECT_FALSE(publish.retain);
+            EXPECT_EQ(publish.packetID, 0x1234);
+            EXPECT_EQ(publish.payload, "");
+
+            // Multi byte remaining length
+            auto payload = std::string(300, 'p');
+            packet = encodePublish("t", payload);
+            EXPECT_EQ(packet.size(), size_t(1 + 2 + 2 + 1 + 300));
+            EXPECT_EQ(decodePacket(packet.data(), packet.size(), view, consumed), DecodeResult::complete);
+            EXPECT_TRUE(decodePublish(view, publish));
+            EXPECT_EQ(publish.payload, payload);
+        }
+
+        TEST(MqttPacket, decodeIncomplete) {
+            auto packet = encodePublish("homie/device/$name", "My device");
+            auto view = PacketView{};
+            auto consumed = size_t{0};
+            for(size_t i = 0; i < packet.size(); ++i) {
+                EXPECT_EQ(decodePacket(packet.data(), i, view, consumed), DecodeResult::incomplete);
+            }
+            EXPECT_EQ(decodePacket(packet.data(), packet.size(), view, consumed), DecodeResult::complete);
+
+            auto malformed = std::vector<uint8_t>{0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+            EXPECT_EQ(decodePacket(malformed.data(), malformed.size(), view, consumed), DecodeResult::malformed);
+            malformed = std::vector<uint8_t>{0x00, 0x00};
+            EXPECT_EQ(decodePacket(malformed.data(), malformed.size(), view, consumed), DecodeResult::malformed);
+
+            // Topic length exceeds the packet
+            malformed = std::vector<uint8_t>{0x30, 0x03, 0x00, 0x05, 'a'};
+            EXPECT_EQ(decodePacket(malformed.data(), malformed.size(), view, consumed), DecodeResult::complete);
+            auto publish = PublishView{};
+            EXPECT_FALSE(decodePublish(view, publish));
+        }
+
+        TEST(MqttPacket, connectSubscribe) {
+            auto options = ConnectOptions{};
+            options.clientID = "my-device";
+            options.keepAlive_s = 15;
+            options.willTopic = "homie/my-device/$state";
+            options.willPayload = "lost";
+            auto packet = encodeConnect(options);
+
+            auto view = PacketView{};
+            auto consumed = size_t{0};
+            EXPECT_EQ(decodePacket(packet.data(), packet.size(), view, consumed), DecodeResult::complete);
+            auto connect = ConnectView{};
+            EXPECT_TRUE(decodeConnect(view, connect));
+            EXPECT_EQ(connect.protocolName, "MQTT");
+            EXPECT_EQ(connect.protocolLevel, 4);
+            EXPECT_EQ(connect.flags, 0x02 | 0x04 | 0x08 | 0x20);
+            EXPECT_EQ(connect.keepAlive_s, 15);
+            EXPECT_EQ(connect.clientID, "my-device");
+
+            // Username and password flags
+            options.username = "user";
+            options.password = "secret";
+            packet = encodeConnect(options);
+            EXPECT_EQ(decodePacket(packet.data(), packet.size(), view, consumed), DecodeResult::complete);
+            EXPECT_TRUE(decodeConnect(view, connect));
+            EXPECT_EQ(connect.flags & 0xC0, 0xC0);
+            // A password requires a username (MQTT-3.1.2-22)
+            options.username.clear();
+            EXPECT_TRUE(encodeConnect(options).empty());
+            // Strings longer than 65535 bytes are not truncated
+            options.password.clear();
+            options.clientID = std::string(0x10000, 'c');
+            EXPECT_TRUE(encodeConnect(options).empty());
+            EXPECT_TRUE(encodeSubscribe(1, {{std::string(0x10000, 't'), QoS::atMostOnce}}).empty());
+            options.clientID = "my-device";
+
+            packet = encodeSubscribe(7, {{"homie/my-device/+/+/set", QoS::atLeastOnce}, {"homie/$broadcast/#", QoS::atMostOnce}});
+            EXPECT_EQ(packet[0], 0x82);
+            EXPECT_EQ(decodePacket(packet.data(), packet.size(), view, consumed), DecodeResult::complete);
+            auto packetID = uint16_t{0};
+            auto topicFilters = std::vector<std::pair<std::string_view, QoS>>{};
+            EXPECT_TRUE(decodeSubscribe(view, packetID, topicFilters));
+            EXPECT_EQ(packetID, 7);
+            EXPECT_EQ(topicFilters.size(), size_t(2));
+            EXPECT_EQ(topicFilters[0].first, "homie/my-device/+/+/set");
+            EXPECT_EQ(topicFilters[0].second, QoS::atLeastOnce);
+            EXPECT_EQ(topicFilters[1].first, "homie/$broadcast/#");
+
+            packet = encodeSuback(7, {1, 0});
+            EXPECT_EQ(decodePacket(packet.data(), packet.size(), view, consumed), DecodeResult::complete);
+            auto returnCodes = std::vector<uint8_t>{};
+            EXPECT_TRUE(decodeSuback(view, packetID, returnCodes));
+            EXPECT_EQ(returnCodes, (std::vector<uint8_t>{1, 0}));
+
+            packet = encodeConnack(false, 0);
+            EXPECT_EQ(packet, (std::vector<uint8_t>{0x20, 2, 0, 0}));
+            EXPECT_EQ(encodePingreq(), (std::vector<uint8_t>{0xC0, 0}));
+            EXPECT_EQ(encodeDisconnect(), (std::vector<uint8_t>{0xE0, 0}));
+        }
+
+        TEST(MqttPacket, publishBatch) {
+            auto buffer = Homie::AttributeBuffer{};
+            buffer.append(Homie::TopicType{"homie", "device"}, Homie::TopicType{"$name"}, "My device");
+            buffer.append(Homie::TopicType{"homie", "device"}, Homie::TopicType{"$state"}, "ready");
+
+            auto batch = PublishBatch{};
+            batch.encode(buffer);
+            EXPECT_EQ(batch.size(), size_t(2));
+            EXPECT_EQ(batch.iovecs().size(), size_t(6));
+            auto expected = encodePublish("homie/device/$name", "My device", QoS::atMostOnce, true);
+            auto second = encodePublish("homie/device/$state", "ready", QoS::atMostOnce, true);
+            expected.insert(expected.end(), second.begin(), second.end());
+            EXPECT_EQ(flatten(batch), expected);
+            EXPECT_EQ(batch.bytes(), expected.size());
+
+            // QoS 1 with consecutive packet identifiers
+            batch.clear();
+            auto attributes = buffer.toAttributes();
+            batch.encode(attributes, QoS::atLeastOnce, false, 10);
+            EXPECT_EQ(batch.iovecs().size(), size_t(8));
+            expected = encodePublish("homie/device/$name", "My device", QoS::atLeastOnce, false, 10);
+            second = encodePublish("homie/device/$state", "ready", QoS::atLeastOnce, false, 11);
+            expected.insert(expected.end(), second.begin(), second.end());
+            EXPECT_EQ(flatten(batch), expected);
+            EXPECT_EQ(batch.bytes(), expected.size());
+
+            // An oversized message in the middle is left out and does not use up a packet identifier
+            batch.clear();
+            auto oversized = attributes;
+            oversized.insert(oversized.begin() + 1, {Homie::TopicType{"homie", std::string(0x10000, 't')}, "x"});
+            EXPECT_EQ(batch.encode(oversized, QoS::atLeastOnce, false, 10), size_t(2));
+            expected = encodePublish("homie/device/$name", "My device", QoS::atLeastOnce, false, 10);
+            second = encodePublish("homie/device/$state", "ready", QoS::atLeastOnce, false, 11);
+            expected.insert(expected.end(), second.begin(), second.end());
+            EXPECT_EQ(flatten(batch), expected);
+            auto oversizedBuffer = Homie::AttributeBuffer{};
+            oversizedBuffer.appendPath("homie/device/$name", "My device");
+            oversizedBuffer.appendPath(std::string(0x10000, 't'), "x");
+            oversizedBuffer.appendPath("homie/device/$state", "ready");
+            batch.clear();
+            EXPECT_EQ(batch.encode(oversizedBuffer, QoS::atLeastOnce, false, 10), size_t(2));
+            EXPECT_EQ(flatten(batch), expected);
+
+            // Packet identifiers skip 0 when they wrap around
+            batch.clear();
+            batch.encode(attributes, QoS::atLeastOnce, false, 0xFFFF);
+            expected = encodePublish("homie/device/$name", "My device", QoS::atLeastOnce, false, 0xFFFF);
+            second = encodePublish("homie/device/$state", "ready", QoS::atLeastOnce, false, 1);
+            expected.insert(expected.end(), second.begin(), second.end());
+            EXPECT_EQ(flatten(batch), expected);
+
+            // Records that are not retained keep their flag
+            buffer.clear();
+            buffer.append(Homie::TopicType{"homie", "device"}, Homie::TopicType{"node", "event"}, "pressed", false);
+            batch.clear();
+            batch.encode(buffer);
+            EXPECT_EQ(flatten(batch), encodePublish("homie/device/node/event", "pressed", QoS::atMostOnce, false));
+        }
+
+        TEST(MqttPacket, socketpair) {
+            int fds[2];
+            ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+            auto hwInfo = std::make_shared<Homie::HWInfo>("DE:AD:BE:EF:FE:ED", "192.168.0.10", "esp32");
+            auto device = std::make_shared<Homie::Device>("Super car", hwInfo, "weatherstation-firmware",
+                std::make_shared<Homie::Version>(1, 0, 0), std::chrono::seconds{60});
+            auto buffer = Homie::AttributeBuffer{};
+            device->connectionInitialized(buffer);
+
+            auto batch = PublishBatch{};
+            batch.encode(buffer);
+            auto& iovecs = batch.iovecs();
+            EXPECT_TRUE(writeAll(fds[0], iovecs.data(), iovecs.size()));
+
+            auto received = readAll(fds[1], batch.bytes());
+            ASSERT_EQ(received.size(), batch.bytes());
+            auto data = received.data();
+            auto size = received.size();
+            auto view = PacketView{};
+            auto consumed = size_t{0};
+            auto publish = PublishView{};
+            for(size_t i = 0; i < buffer.size(); ++i) {
+                ASSERT_EQ(decodePacket(data, size, view, consumed), DecodeResult::complete);
+                ASSERT_TRUE(decodePublish(view, publish));
+                EXPECT_EQ(publish.topic, buffer.topic(i));
+                EXPECT_EQ(publish.payload, buffer.payload(i));
+                EXPECT_TRUE(publish.retain);
+                data += consumed;
+                size -= consumed;
+            }
+            EXPECT_EQ(size, size_t(0));
+
+            close(fds[0]);
+            close(fds[1]);
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef __TEST_TESTDEVICES_H__
+#define __TEST_TESTDEVICES_H__
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "Device.h"
+
+namespace Rovi {
+    namespace Homie {
+        // Device number 'index' of a simulated fleet. Every index gets its own MAC and therefore its own device ID
+        // (up to 8100 devices).
+        inline std::shared_ptr<Device> createTestDevice(const size_t index, const std::chrono::seconds interval) {
+            auto mac = std::string{"DE:AD:BE:EF:"} + std::to_string(10 + index / 90) + ":" + std::to_string(10 + index % 90);
+            auto hwInfo = std::make_shared<HWInfo>(mac, "192.168.0.10", "esp32");
+            return std::make_shared<Device>("Device", hwInfo, "firmware", std::make_shared<Version>(1, 0, 0), interval);
+        }
+    }
+}
+
+#endif /* __TEST_TESTDEVICES_H__ */
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "Utils/CharacterClass.h"
+
+namespace Rovi {
+    TEST(CharacterClass, contains) {
+        auto characterClass = CharacterClass{"abc,"};
+        EXPECT_TRUE(characterClass.contains('a'));
+        EXPECT_TRUE(characterClass.contains(','));
+        EXPECT_FALSE(characterClass.contains('d'));
+        EXPECT_FALSE(characterClass.contains('\0'));
+        EXPECT_FALSE(characterClass.contains(static_cast<char>(0xE4)));
+    }
+
+    TEST(CharacterClass, matchesAll) {
+        auto& topicID = CharacterClass::topicID();
+        EXPECT_TRUE(topicID.matchesAll(""));
+        EXPECT_TRUE(topicID.matchesAll("super-car-deadbeeffeed"));
+        EXPECT_FALSE(topicID.matchesAll("Super-car"));
+        EXPECT_FALSE(topicID.matchesAll("super_car"));
+        EXPECT_FALSE(topicID.matchesAll("$name"));
+
+        EXPECT_TRUE(CharacterClass::digits().matchesAll("0123456789"));
+        EXPECT_FALSE(CharacterClass::digits().matchesAll("0123456789a"));
+    }
+
+    TEST(CharacterClass, matchesAllLongInput) {
+        // Long inputs are checked block wise. Test an invalid character at every position of the blocks and the tail
+        auto& topicID = CharacterClass::topicID();
+        auto valid = std::string{};
+        for(size_t i = 0; i < 100; ++i) {
+            valid += "abcdefghijklmnopqrstuvwxyz0123456789-"[i % 37];
+        }
+        EXPECT_TRUE(topicID.matchesAll(valid));
+        for(size_t i = 0; i < valid.size(); ++i) {
+            for(auto c : {'A', '_', '/', static_cast<char>(0xFF), static_cast<char>(0x80), '\0'}) {
+                auto invalid = valid;
+                invalid[i] = c;
+                EXPECT_FALSE(topicID.matchesAll(invalid)) << "position " << i;
+            }
+        }
+
+        // More ranges than supported by the SIMD path
+        auto fragmented = CharacterClass{"acegikmo"};
+        EXPECT_TRUE(fragmented.matchesAll(std::string(64, 'o')));
+        EXPECT_FALSE(fragmented.matchesAll(std::string(63, 'o') + "b"));
+    }
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "Utils/FlatHashMap.h"
+
+#include <map>
+#include <random>
+#include <string>
+
+namespace Rovi {
+    TEST(FlatHashMap, insertFindErase) {
+        auto map = FlatHashMap<int>{};
+        EXPECT_TRUE(map.empty());
+        EXPECT_EQ(map.find("engine"), nullptr);
+        EXPECT_FALSE(map.erase("engine"));
+
+        EXPECT_TRUE(map.insert("engine", 1));
+        EXPECT_TRUE(map.insert("wheels", 2));
+        EXPECT_FALSE(map.insert("engine", 3));
+        EXPECT_EQ(map.size(), size_t(2));
+
+        // Heterogeneous lookup, e.g. with a level of a topic
+        auto topic = std::string_view{"homie/car/wheels/$name"};
+        ASSERT_NE(map.find(topic.substr(10, 6)), nullptr);
+        EXPECT_EQ(*map.find(topic.substr(10, 6)), 2);
+        *map.find("engine") = 10;
+        EXPECT_EQ(*map.find("engine"), 10);
+
+        // Insertion order
+        auto keys = std::vector<std::string>{};
+        for(auto& entry : map) {
+            keys.push_back(entry.key);
+        }
+        EXPECT_EQ(keys, (std::vector<std::string>{"engine", "wheels"}));
+
+        EXPECT_TRUE(map.erase("engine"));
+        EXPECT_FALSE(map.contains("engine"));
+        EXPECT_EQ(*map.find("wheels"), 2);
+        map.clear();
+        EXPECT_TRUE(map.empty());
+        EXPECT_EQ(map.find("wheels"), nullptr);
+    }
+
+    TEST(FlatHashMap, randomOperations) {
+        // Same results as std::map over many inserts and erases, including growth and long probe sequences
+        auto map = FlatHashMap<uint32_t>{};
+        auto reference = std::map<std::string, uint32_t>{};
+        auto random = std::mt19937{42};
+        auto keys = std::uniform_int_distribution<uint32_t>{0, 2000};
+        for(uint32_t i = 0; i < 50000; ++i) {
+            auto key = "node-" + std::to_string(keys(random));
+            if(random() % 3 == 0) {
+                EXPECT_EQ(map.erase(key), reference.erase(key) == 1);
+            } else {
+                EXPECT_EQ(map.insert(key, i), reference.emplace(key, i).second);
+            }
+        }
+        EXPECT_EQ(map.size(), reference.size());
+        for(uint32_t key = 0; key <= 2000; ++key) {
+            auto id = "node-" + std::to_string(key);
+            auto it = reference.find(id);
+            auto value = map.find(id);
+            ASSERT_EQ(value != nullptr, it != reference.end()) << id;
+            if(value != nullptr) {
+                EXPECT_EQ(*value, it->second);
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "Utils/MpscQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Rovi {
+    TEST(MpscQueue, fifo) {
+        auto queue = MpscQueue<std::string>{3};
+        EXPECT_EQ(queue.capacity(), size_t(4));
+        EXPECT_TRUE(queue.empty());
+        auto value = std::string{};
+        EXPECT_FALSE(queue.pop(value));
+
+        for(auto i = 0; i < 4; ++i) {
+            EXPECT_TRUE(queue.push("value-" + std::to_string(i)));
+        }
+        EXPECT_FALSE(queue.push("full"));
+        EXPECT_EQ(queue.size(), size_t(4));
+
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, "value-0");
+        // Wraps around
+        EXPECT_TRUE(queue.emplace(5, 'x'));
+        auto values = std::vector<std::string>{};
+        EXPECT_EQ(queue.drain([&values](std::string& next) { values.push_back(next); }, 2), size_t(2));
+        EXPECT_EQ(queue.drain([&values](std::string& next) { values.push_back(next); }), size_t(2));
+        EXPECT_EQ(values, (std::vector<std::string>{"value-1", "value-2", "value-3", "xxxxx"}));
+        EXPECT_TRUE(queue.empty());
+
+        auto statistics = queue.statistics();
+        EXPECT_EQ(statistics.pushed, uint64_t(5));
+        EXPECT_EQ(statistics.popped, uint64_t(5));
+        EXPECT_EQ(statistics.rejected, uint64_t(1));
+        EXPECT_EQ(statistics.occupancy, size_t(0));
+        EXPECT_EQ(statistics.highWatermark, size_t(4));
+    }
+
+    TEST(MpscQueue, destruction) {
+        // Values left in the queue are destroyed with it
+        auto value = std::make_shared<int>(42);
+        {
+            auto queue = MpscQueue<std::shared_ptr<int>>{8};
+            queue.push(value);
+            queue.push(value);
+            EXPECT_EQ(value.use_count(), 3);
+        }
+        EXPECT_EQ(value.use_count(), 1);
+    }
+
+    TEST(MpscQueue, stress) {
+        // Producers push (producer, sequence number) pairs into a small ring, so they race for positions and
+        // hit the full ring. The consumer checks that nothing is lost or reordered per producer.
+        constexpr auto producers = 4;
+        constexpr auto perProducer = uint64_t{200000};
+        auto queue = MpscQueue<uint64_t>{64};
+        auto start = std::atomic<bool>{false};
+
+        auto threads = std::vector<std::thread>{};
+        for(auto producer = 0; producer < producers; ++producer) {
+            threads.emplace_back([&queue, &start, producer]() {
+                while(!start.load()) {
+                    std::this_thread::yield();
+                }
+                for(auto sequence = uint64_t{0}; sequence < perProducer; ++sequence) {
+                    while(!queue.push((static_cast<uint64_t>(producer) << 32) | sequence)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        auto next = std::vector<uint64_t>(producers, 0);
+        auto received = uint64_t{0};
+        auto ordered = true;
+        start = true;
+        while(received < producers * perProducer) {
+            auto count = queue.drain([&](uint64_t& value) {
+                auto producer = value >> 32;
+                ordered = ordered && (value & 0xFFFFFFFF) == next[producer];
+                ++next[producer];
+            }, 32);
+            received += count;
+            if(count == 0) {
+                std::this_thread::yield();
+            }
+        }
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_TRUE(ordered);
+        EXPECT_EQ(next, std::vector<uint64_t>(producers, perProducer));
+        auto statistics = queue.statistics();
+        EXPECT_EQ(statistics.pushed, producers * perProducer);
+        EXPECT_EQ(statistics.popped, producers * perProducer);
+        EXPECT_LE(statistics.highWatermark, queue.capacity());
+        EXPECT_TRUE(queue.empty());
+    }
+}
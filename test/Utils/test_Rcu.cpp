@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "Utils/Rcu.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Rovi {
+    // Counts the living versions
+    struct RcuVersion {
+        static std::atomic<int> instances;
+
+        explicit RcuVersion(const int value) : value{value}, text{std::to_string(value)} { ++instances; }
+        ~RcuVersion() { --instances; }
+
+        int value;
+        std::string text;
+    };
+    std::atomic<int> RcuVersion::instances{0};
+
+    TEST(Rcu, reclamation) {
+        {
+            auto rcu = RcuValue<RcuVersion>{std::make_unique<const RcuVersion>(1)};
+            EXPECT_EQ(RcuVersion::instances, 1);
+            {
+                auto first = rcu.read();
+                rcu.publish(std::make_unique<const RcuVersion>(2));
+                // The first version is still referenced by a reader
+                EXPECT_EQ(first->value, 1);
+                EXPECT_EQ(rcu.read()->value, 2);
+                EXPECT_EQ(RcuVersion::instances, 2);
+            }
+            // Freed by the next publication after the reader left
+            rcu.publish(std::make_unique<const RcuVersion>(3));
+            EXPECT_EQ(RcuVersion::instances, 1);
+            EXPECT_EQ(rcu.read()->value, 3);
+
+            // Nested read-side critical sections
+            {
+                auto outer = rcu.read();
+                {
+                    auto inner = rcu.read();
+                }
+                rcu.publish(std::make_unique<const RcuVersion>(4));
+                EXPECT_EQ(outer->value, 3);
+                EXPECT_EQ(RcuVersion::instances, 2);
+            }
+        }
+        EXPECT_EQ(RcuVersion::instances, 0);
+    }
+
+    TEST(Rcu, concurrentReaders) {
+        auto rcu = RcuValue<RcuVersion>{std::make_unique<const RcuVersion>(0)};
+        auto running = std::atomic<bool>{true};
+        auto consistent = std::atomic<bool>{true};
+        auto readers = std::vector<std::thread>{};
+        for(auto i = 0; i < 4; ++i) {
+            readers.emplace_back([&]() {
+                auto last = 0;
+                while(running) {
+                    auto version = rcu.read();
+                    // Versions are never torn and never go back
+                    if(version->text != std::to_string(version->value) || version->value < last) {
+                        consistent = false;
+                    }
+                    last = version->value;
+                }
+            });
+        }
+        for(auto value = 1; value <= 20000; ++value) {
+            rcu.publish(std::make_unique<const RcuVersion>(value));
+        }
+        running = false;
+        for(auto& reader : readers) {
+            reader.join();
+        }
+        EXPECT_TRUE(consistent);
+        EXPECT_EQ(rcu.read()->value, 20000);
+        // Without readers every replaced version is freed immediately
+        rcu.publish(std::make_unique<const RcuVersion>(0));
+        EXPECT_EQ(RcuDomain::instance().pending(), size_t(0));
+    }
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "Utils/StringUtils.h"
 
+#include <clocale>
+
 namespace Rovi {
     TEST(StringUtils, fullfile) { 
         EXPECT_EQ(StringUtils::fullfile("aaa", "bbb"), "aaa/bbb/");
@@ -47,6 +49,30 @@ namespace Rovi {
         }
     }
 
+    TEST(StringUtils, tokenize) {
+        auto tokens = [](std::string_view str, char delimiter) {
+            auto result = std::vector<std::string_view>{};
+            for(auto token : StringUtils::tokenize(str, delimiter)) {
+                result.push_back(token);
+            }
+            return result;
+        };
+        EXPECT_EQ(tokens("123,456,789", ','), (std::vector<std::string_view>{"123", "456", "789"}));
+        EXPECT_EQ(tokens(",123,456,789,", ','), (std::vector<std::string_view>{"", "123", "456", "789"}));
+        EXPECT_EQ(tokens("a,,b", ','), (std::vector<std::string_view>{"a", "", "b"}));
+        EXPECT_EQ(tokens(",", ','), (std::vector<std::string_view>{""}));
+        EXPECT_EQ(tokens("abc", ','), (std::vector<std::string_view>{"abc"}));
+        EXPECT_TRUE(tokens("", ',').empty());
+
+        // Tokens are views into the original string
+        const auto str = std::string{"abc_def"};
+        auto it = StringUtils::tokenize(str, '_').begin();
+        EXPECT_EQ(it->data(), str.data());
+        ++it;
+        EXPECT_EQ(it->data(), str.data() + 4);
+        EXPECT_EQ(++it, StringUtils::tokenize(str, '_').end());
+    }
+
     TEST(StringUtils, toString) {
         EXPECT_EQ(StringUtils::toString(1), "1");
         EXPECT_EQ(StringUtils::toString(1.0), "1");
@@ -56,6 +82,50 @@ namespace Rovi {
         EXPECT_EQ(StringUtils::toString(.1), "0.1");
         EXPECT_EQ(StringUtils::toString(1e2), "100");
         EXPECT_EQ(StringUtils::toString(1E2), "100");
+        EXPECT_EQ(StringUtils::toString(3.3f), "3.3");
+        EXPECT_EQ(StringUtils::toString(2e8), "2e+08");
+        EXPECT_EQ(StringUtils::toString(std::string{"abc"}), "abc");
+        EXPECT_EQ(StringUtils::toString('a'), "a");
+    }
+
+    TEST(StringUtils, formatNumber) {
+        char buffer[StringUtils::maxNumberLength];
+        auto format = [&buffer](size_t length) { return std::string(buffer, length); };
+
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), 0)), "0");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), 7)), "7");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), 42)), "42");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), -42)), "-42");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), 100)), "100");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), uint32_t{5242880})), "5242880");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), std::numeric_limits<int64_t>::max())), "9223372036854775807");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), std::numeric_limits<int64_t>::min())), "-9223372036854775808");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), std::numeric_limits<uint64_t>::max())), "18446744073709551615");
+
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), 1.2)), "1.2");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), -0.456)), "-0.456");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), 2e-8)), "2e-08");
+        EXPECT_EQ(format(StringUtils::formatNumber(buffer, sizeof(buffer), 123456789.0)), "1.23457e+08");
+
+        // Buffer too small
+        EXPECT_EQ(StringUtils::formatNumber(buffer, 2, 123), size_t(0));
+        EXPECT_EQ(StringUtils::formatNumber(buffer, 2, 1.25), size_t(0));
+
+        auto str = std::string{"0-"};
+        StringUtils::appendNumber(str, size_t{2});
+        EXPECT_EQ(str, "0-2");
+    }
+
+    TEST(StringUtils, formatNumberLocale) {
+        // Homie floats always use '.', regardless of the locale of the process
+        auto previous = std::string{setlocale(LC_NUMERIC, nullptr)};
+        if(setlocale(LC_NUMERIC, "de_DE.UTF-8") == nullptr) {
+            GTEST_SKIP() << "Locale de_DE.UTF-8 is not installed";
+        }
+        char buffer[StringUtils::maxNumberLength];
+        auto length = StringUtils::formatNumber(buffer, sizeof(buffer), 3.3);
+        setlocale(LC_NUMERIC, previous.c_str());
+        EXPECT_EQ(std::string(buffer, length), "3.3");
     }
 
     TEST(StringUtils, toLower) {
@@ -77,6 +147,10 @@ namespace Rovi {
 
     TEST(StringUtils, trim) {
         EXPECT_EQ(StringUtils::trim("   aaa bbbb  cc     "), "aaa bbbb  cc");
+        EXPECT_EQ(StringUtils::trim("   "), "");
+        EXPECT_EQ(StringUtils::trimView("\t aaa \t"), "aaa");
+        EXPECT_EQ(StringUtils::trimView("--aaa-", "-"), "aaa");
+        EXPECT_TRUE(StringUtils::trimView("").empty());
     }
 
     TEST(FfileIOUtils, removeCharsFromString) {
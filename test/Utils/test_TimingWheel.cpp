@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "Utils/TimingWheel.h"
+
+#include <random>
+#include <set>
+
+namespace Rovi {
+    TEST(TimingWheel, expiry) {
+        auto wheel = TimingWheel<int>{};
+        // Level 0, level 1, level 2, level 3 and parked beyond the range of the wheel
+        auto expiries = std::vector<uint64_t>{0, 1, 63, 64, 65, 127, 128, 4095, 4096, 4097, 300000, 16777215, 16777216, 20000000};
+        for(size_t i = 0; i < expiries.size(); ++i) {
+            wheel.schedule(expiries[i], static_cast<int>(i));
+        }
+        EXPECT_EQ(wheel.size(), expiries.size());
+
+        auto fired = std::vector<std::pair<uint64_t, int>>{};
+        auto check = [&](uint64_t tick) {
+            wheel.advance(tick, [&](TimingWheel<int>::TimerID, int& value, uint64_t expiry) {
+                EXPECT_EQ(expiry, wheel.currentTick() - 1);
+                fired.emplace_back(expiry, value);
+            });
+        };
+        // Advance in steps of different sizes
+        check(0);
+        ASSERT_EQ(fired.size(), size_t(1));
+        check(64);
+        check(5000);
+        check(16777215);
+        check(30000000);
+        ASSERT_EQ(fired.size(), expiries.size());
+        for(size_t i = 0; i < expiries.size(); ++i) {
+            EXPECT_EQ(fired[i].first, expiries[i]);
+            EXPECT_EQ(fired[i].second, static_cast<int>(i));
+        }
+        EXPECT_TRUE(wheel.empty());
+    }
+
+    TEST(TimingWheel, random) {
+        auto wheel = TimingWheel<uint64_t>{1000};
+        auto generator = std::mt19937_64{42};
+        auto distribution = std::uniform_int_distribution<uint64_t>{1000, 300000};
+        auto expected = std::multiset<uint64_t>{};
+        for(auto i = 0; i < 10000; ++i) {
+            auto expiry = distribution(generator);
+            wheel.schedule(expiry, expiry);
+            expected.insert(expiry);
+        }
+
+        auto tick = uint64_t{1000};
+        auto errors = 0;
+        while(!wheel.empty()) {
+            tick += 1 + tick % 97;
+            wheel.advance(tick, [&](TimingWheel<uint64_t>::TimerID, uint64_t& value, uint64_t expiry) {
+                // Never early, and exactly on time as long as the tick is processed
+                if(value != expiry || expiry + 1 != wheel.currentTick()) {
+                    ++errors;
+                }
+                expected.erase(expected.find(expiry));
+            });
+        }
+        EXPECT_EQ(errors, 0);
+        EXPECT_TRUE(expected.empty());
+    }
+
+    TEST(TimingWheel, cancelAndReschedule) {
+        auto wheel = TimingWheel<int>{};
+        auto first = wheel.schedule(10, 1);
+        auto second = wheel.schedule(10, 2);
+        wheel.schedule(10, 3);
+        EXPECT_TRUE(wheel.cancel(second));
+        EXPECT_FALSE(wheel.cancel(second));
+
+        auto fired = std::vector<std::pair<uint64_t, int>>{};
+        for(uint64_t tick = 0; tick <= 40; ++tick) {
+            wheel.advance(tick, [&](TimingWheel<int>::TimerID, int& value, uint64_t expiry) {
+                fired.emplace_back(expiry, value);
+                // Periodic timer
+                if(value == 1 && expiry < 30) {
+                    wheel.schedule(expiry + 10, value);
+                }
+            });
+        }
+        EXPECT_FALSE(wheel.cancel(first));        // Already expired
+        ASSERT_EQ(fired.size(), size_t(4));
+        EXPECT_EQ(fired[0].first, uint64_t(10));
+        EXPECT_EQ(fired[1].first, uint64_t(10));
+        EXPECT_EQ(fired[2], std::make_pair(uint64_t(20), 1));
+        EXPECT_EQ(fired[3], std::make_pair(uint64_t(30), 1));
+
+        // Timers in the past fire with the next tick
+        wheel.schedule(5, 7);
+        auto late = std::vector<uint64_t>{};
+        wheel.advance(41, [&](TimingWheel<int>::TimerID, int&, uint64_t expiry) { late.push_back(expiry); });
+        EXPECT_EQ(late, std::vector<uint64_t>{5});
+    }
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include "Device.h"
 
+#include <atomic>
+#include <map>
+#include <thread>
+
 namespace Rovi {
     namespace Homie {
         const auto deviceName = std::string{"Super car"};
@@ -16,6 +20,9 @@ namespace Rovi {
         const auto baseMqttPath = std::string{"homie/super-car-deadbeeffeed/"};
 
         TEST(Device, attributes) {         
+            {
+                EXPECT_TRUE(mqttPathToString(device->baseTopic()) == baseMqttPath);
+            }
             {
                 auto attribute = device->attribute(Device::Attributes::deviceID);
                 EXPECT_TRUE(attribute.second == std::string{"super-car-deadbeeffeed"});
@@ -131,6 +138,264 @@ namespace Rovi {
             }  
         }
 
+        TEST(Device, attributeBuffer) {
+            auto buffer = AttributeBuffer{};
+            device->update(buffer);
+            EXPECT_EQ(buffer.size(), size_t(7));
+            EXPECT_EQ(buffer.topic(1), "homie/super-car-deadbeeffeed/$stats/signal");
+            EXPECT_EQ(buffer.payload(1), "100");
+
+            auto attributes = device->update();
+            EXPECT_EQ(attributes.size(), buffer.size());
+            EXPECT_TRUE(mqttPathToString(attributes[6].first) == baseMqttPath + std::string{"$stats/supply/"});
+            EXPECT_TRUE(attributes[6].second == "3.3");
+
+            buffer.clear();
+            device->connectionInitialized(buffer);
+            EXPECT_EQ(buffer.size(), size_t(11));
+            EXPECT_EQ(buffer.topic(0), "homie/super-car-deadbeeffeed/$homie");
+            EXPECT_EQ(buffer.payload(0), "3.0.1");
+            EXPECT_EQ(buffer.topic(10), "homie/super-car-deadbeeffeed/$state");
+            EXPECT_EQ(buffer.payload(10), "ready");
+        }
+
+        TEST(Device, cycleArena) {
+            // Nothing may be allocated beyond the arena: The null resource throws std::bad_alloc
+            auto arena = CycleArena{8192, std::pmr::null_memory_resource()};
+            auto reference = AttributeBuffer{};
+            device->connectionInitialized(reference);
+            for(auto cycle = 0; cycle < 3; ++cycle) {
+                {
+                    auto buffer = AttributeBuffer{arena.resource()};
+                    device->connectionInitialized(buffer);
+                    ASSERT_EQ(buffer.size(), reference.size());
+                    EXPECT_EQ(std::string(buffer.data(), buffer.bytes()), std::string(reference.data(), reference.bytes()));
+                    device->update(buffer);
+                    EXPECT_EQ(buffer.size(), reference.size() + 7);
+                    EXPECT_EQ(buffer.topic(buffer.size() - 1), "homie/super-car-deadbeeffeed/$stats/supply");
+                    EXPECT_EQ(buffer.payload(buffer.size() - 1), "3.3");
+                }
+                arena.reset();
+            }
+        }
+
+        TEST(Device, nodes) {
+            auto nodesDevice = Device{"Nodes car", hwInfo, firmwareName, firmwareVersion, statsInterval_s};
+            auto engine = nodesDevice.addNode("Engine", "V8");
+            nodesDevice.addNode("Wheels", "tire", 4);
+            nodesDevice.addNode("Lights", "led");
+            EXPECT_EQ(nodesDevice.nodes(), "engine,wheels[],lights");
+            EXPECT_EQ(nodesDevice.value(Device::Attributes::nodes), nodesDevice.nodes());
+
+            auto publish = [&nodesDevice]() {
+                auto buffer = AttributeBuffer{};
+                nodesDevice.update(buffer);
+                auto attributes = std::map<std::string, std::string>{};
+                for(size_t i = 0; i < buffer.size(); ++i) {
+                    attributes[std::string{buffer.topic(i)}] = std::string{buffer.payload(i)};
+                }
+                return attributes;
+            };
+            const auto stats = size_t(7);
+            const auto base = std::string{"homie/nodes-car-deadbeeffeed/"};
+
+            // Nodes are published by connectionInitialized(), update() only publishes changes afterwards
+            EXPECT_EQ(publish().size(), stats);
+            auto buffer = AttributeBuffer{};
+            nodesDevice.connectionInitialized(buffer);
+            EXPECT_EQ(publish().size(), stats);
+
+            EXPECT_TRUE(nodesDevice.removeNode("wheels"));
+            EXPECT_FALSE(nodesDevice.removeNode("wheels"));
+            EXPECT_EQ(nodesDevice.node("wheels"), nullptr);
+            EXPECT_EQ(nodesDevice.node("lights")->value(Node::Attributes::nodeID), "lights");
+            EXPECT_EQ(nodesDevice.nodes(), "engine,lights");
+            EXPECT_TRUE(nodesDevice.removeNode("lights"));
+            EXPECT_EQ(nodesDevice.nodes(), "engine");
+            // The snapshot is published by the next update()
+            EXPECT_EQ(nodesDevice.snapshot()->nodeIDs, "engine,wheels[],lights");
+            nodesDevice.publishSnapshot();
+            EXPECT_EQ(nodesDevice.snapshot()->nodeIDs, "engine");
+            auto horn = nodesDevice.addNode("Horn", "klaxon");
+            horn->addProperty({"Volume", Datatype::integer, "0:100"});
+            EXPECT_EQ(nodesDevice.nodes(), "engine,horn");
+
+            // One publication of $nodes and the new node, the retained topics of the removed nodes are deleted
+            auto attributes = publish();
+            EXPECT_EQ(attributes[base + "$nodes"], "engine,horn");
+            EXPECT_EQ(attributes.count(base + "wheels/$name"), size_t(1));
+            EXPECT_EQ(attributes[base + "wheels/$name"], "");
+            EXPECT_EQ(attributes.count(base + "wheels/$array"), size_t(1));
+            EXPECT_EQ(attributes.count(base + "lights/$type"), size_t(1));
+            EXPECT_EQ(attributes[base + "horn/$name"], "Horn");
+            EXPECT_EQ(attributes[base + "horn/$properties"], "volume");
+            EXPECT_EQ(attributes[base + "horn/volume/$datatype"], "integer");
+            EXPECT_EQ(attributes[base + "horn/volume"], "0");
+            EXPECT_EQ(attributes.count(base + "engine/$name"), size_t(0));
+            EXPECT_EQ(publish().size(), stats);
+
+            // New property of a published node
+            auto speed = engine->addProperty({"Speed", Datatype::integer});
+            EXPECT_EQ(engine->value(Node::Attributes::properties), "speed");
+            attributes = publish();
+            EXPECT_EQ(attributes[base + "engine/$properties"], "speed");
+            EXPECT_EQ(attributes[base + "engine/speed/$datatype"], "integer");
+            EXPECT_EQ(attributes.count(base + "$nodes"), size_t(0));
+            EXPECT_EQ(publish().size(), stats);
+
+            EXPECT_TRUE(engine->properties().setInteger(speed, 120));
+            attributes = publish();
+            EXPECT_EQ(attributes.size(), stats + 1);
+            EXPECT_EQ(attributes[base + "engine/speed"], "120");
+
+            EXPECT_TRUE(nodesDevice.removeNode("engine"));
+            EXPECT_TRUE(nodesDevice.removeNode("horn"));
+            EXPECT_EQ(nodesDevice.nodes(), "");
+            attributes = publish();
+            EXPECT_EQ(attributes[base + "$nodes"], "");
+            EXPECT_EQ(attributes.count(base + "engine/speed/$datatype"), size_t(1));
+            EXPECT_EQ(attributes[base + "engine/speed"], "");
+            EXPECT_EQ(attributes.count(base + "horn/volume"), size_t(1));
+            EXPECT_EQ(publish().size(), stats);
+        }
+
+        class VariableHWInfo : public HWInfo {
+            public:
+                VariableHWInfo() : HWInfo(deviceMAC, deviceIP, Homie::implementation) {}
+
+                std::list<Stats> supportedStats() const override { return {Stats::cpuload, Stats::battery, Stats::supply}; }
+                uint32_t cpuLoad() const override { return load; }
+                uint32_t batteryLevel() const override { return battery; }
+                float supplyVoltage() const override { return supply; }
+
+                uint32_t load = 10;
+                uint32_t battery = 100;
+                float supply = 3.3f;
+        };
+
+        TEST(Device, deltaPublication) {
+            auto info = std::make_shared<VariableHWInfo>();
+            auto deltaDevice = std::make_shared<Device>(deviceName, info, firmwareName, firmwareVersion, statsInterval_s);
+            auto buffer = AttributeBuffer{};
+
+            // Disabled by default
+            deltaDevice->update(buffer);
+            deltaDevice->update(buffer);
+            EXPECT_EQ(buffer.size(), size_t(6));
+
+            deltaDevice->setDeltaPublication(true);
+            deltaDevice->setDeadband(Stats::cpuload, 5.0);
+            deltaDevice->setDeadband(Stats::supply, 0.1);
+            // Unchanged since the last (full) update
+            buffer.clear();
+            deltaDevice->update(buffer);
+            EXPECT_TRUE(buffer.empty());
+
+            // Within the deadband
+            info->load = 15;
+            info->supply = 3.35f;
+            buffer.clear();
+            deltaDevice->update(buffer);
+            EXPECT_TRUE(buffer.empty());
+
+            info->load = 16;
+            info->battery = 99;
+            buffer.clear();
+            deltaDevice->update(buffer);
+            ASSERT_EQ(buffer.size(), size_t(2));
+            EXPECT_EQ(buffer.topic(0), "homie/super-car-deadbeeffeed/$stats/cpuload");
+            EXPECT_EQ(buffer.payload(0), "16");
+            EXPECT_EQ(buffer.topic(1), "homie/super-car-deadbeeffeed/$stats/battery");
+            EXPECT_EQ(buffer.payload(1), "99");
+
+            // The deadband refers to the last published value
+            info->supply = 3.42f;
+            buffer.clear();
+            deltaDevice->update(buffer);
+            ASSERT_EQ(buffer.size(), size_t(1));
+            EXPECT_EQ(buffer.payload(0), "3.42");
+
+            // A new connection publishes everything again
+            buffer.clear();
+            deltaDevice->connectionInitialized(buffer);
+            buffer.clear();
+            deltaDevice->update(buffer);
+            EXPECT_EQ(buffer.size(), size_t(3));
+        }
+
+        TEST(Device, deltaPublicationFullRefresh) {
+            auto info = std::make_shared<VariableHWInfo>();
+            auto deltaDevice = std::make_shared<Device>(deviceName, info, firmwareName, firmwareVersion, statsInterval_s);
+            deltaDevice->setDeltaPublication(true, 3);
+
+            auto sizes = std::vector<size_t>{};
+            for(auto i = 0; i < 7; ++i) {
+                auto buffer = AttributeBuffer{};
+                deltaDevice->update(buffer);
+                sizes.push_back(buffer.size());
+            }
+            EXPECT_EQ(sizes, (std::vector<size_t>{3, 0, 0, 3, 0, 0, 3}));
+        }
+
+        TEST(Device, snapshot) {
+            auto snapshotDevice = std::make_shared<Device>("Snapshot car", hwInfo, firmwareName, firmwareVersion, statsInterval_s);
+            {
+                auto snapshot = snapshotDevice->snapshot();
+                EXPECT_EQ(snapshot->deviceID, "snapshot-car-deadbeeffeed");
+                EXPECT_EQ(snapshot->name, "Snapshot car");
+                EXPECT_EQ(snapshot->state, Device::State::init);
+                EXPECT_EQ(snapshot->mac, deviceMAC);
+                EXPECT_EQ(snapshot->firmwareVersion, "1.0.0");
+                EXPECT_TRUE(snapshot->nodes.empty());
+
+                // A snapshot is not affected by later changes
+                auto node = snapshotDevice->addNode("Engine", "V8");
+                node->addProperty({"Speed", Datatype::integer});
+                snapshotDevice->setState(Device::State::ready);
+                EXPECT_EQ(snapshot->state, Device::State::init);
+                EXPECT_TRUE(snapshot->nodes.empty());
+
+                // The changes are published once, state() is up to date before
+                EXPECT_EQ(snapshotDevice->snapshot()->state, Device::State::init);
+                EXPECT_EQ(snapshotDevice->state(), Device::State::ready);
+                snapshotDevice->publishSnapshot();
+            }
+            {
+                auto snapshot = snapshotDevice->snapshot();
+                EXPECT_EQ(snapshot->state, Device::State::ready);
+                EXPECT_EQ(snapshot->nodeIDs, "engine");
+                ASSERT_EQ(snapshot->nodes.size(), size_t(1));
+                EXPECT_EQ(snapshot->nodes[0].type, "V8");
+                EXPECT_EQ(snapshot->nodes[0].properties, "speed");
+            }
+
+            // Readers on other threads always see a consistent version while the state changes
+            auto running = std::atomic<bool>{true};
+            auto consistent = std::atomic<bool>{true};
+            auto readers = std::vector<std::thread>{};
+            for(auto i = 0; i < 4; ++i) {
+                readers.emplace_back([&]() {
+                    while(running) {
+                        auto snapshot = snapshotDevice->snapshot();
+                        if(snapshot->name != "Snapshot car" || snapshot->nodes.size() != 1
+                            || (snapshot->state != Device::State::ready && snapshot->state != Device::State::alert)) {
+                            consistent = false;
+                        }
+                    }
+                });
+            }
+            for(auto i = 0; i < 2000; ++i) {
+                snapshotDevice->setState(i % 2 == 0 ? Device::State::alert : Device::State::ready);
+                snapshotDevice->publishSnapshot();
+            }
+            running = false;
+            for(auto& reader : readers) {
+                reader.join();
+            }
+            EXPECT_TRUE(consistent);
+            EXPECT_EQ(snapshotDevice->state(), Device::State::ready);
+        }
+
         TEST(Device, update) {
             // sleep(2);
             auto mqttRawData = device->update();
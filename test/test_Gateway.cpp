@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "Gateway.h"
+#include "TestDevices.h"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace Rovi {
+    namespace Homie {
+        TEST(Gateway, sharding) {
+            auto mutex = std::mutex{};
+            auto threadsPerShard = std::map<size_t, std::set<std::thread::id>>{};
+            auto published = std::map<std::string, size_t>{};
+            auto options = Gateway::Options{};
+            options.shards = 4;
+            options.pinThreads = false;
+            auto gateway = Gateway{[&](size_t shard, Device& device, AttributeBuffer&) {
+                    auto lock = std::lock_guard<std::mutex>{mutex};
+                    threadsPerShard[shard].insert(std::this_thread::get_id());
+                    ++published[device.deviceID()->id()];
+                }, options};
+            EXPECT_EQ(gateway.shardCount(), size_t(4));
+
+            auto ids = std::vector<std::string>{};
+            for(size_t i = 0; i < 200; ++i) {
+                auto device = createTestDevice(i, std::chrono::seconds{0});
+                ids.push_back(device->deviceID()->id());
+                gateway.addDevice(device);
+            }
+            // Messages posted before the start are kept in the mailboxes
+            gateway.start();
+            gateway.flush();
+            EXPECT_EQ(gateway.deviceCount(), size_t(200));
+
+            // Stable and spread across all shards
+            auto devicesPerShard = std::map<size_t, size_t>{};
+            for(auto& id : ids) {
+                EXPECT_EQ(gateway.shardOf(id), gateway.shardOf(id));
+                ++devicesPerShard[gateway.shardOf(id)];
+            }
+            ASSERT_EQ(devicesPerShard.size(), size_t(4));
+            for(auto& shard : devicesPerShard) {
+                EXPECT_GT(shard.second, size_t(20));
+            }
+
+            // Every shard updates its devices on its own thread
+            EXPECT_EQ(gateway.updateAll(), size_t(200 * 7));
+            EXPECT_EQ(published.size(), size_t(200));
+            auto threads = std::set<std::thread::id>{};
+            for(auto& shard : threadsPerShard) {
+                EXPECT_EQ(shard.second.size(), size_t(1));
+                threads.insert(*shard.second.begin());
+            }
+            EXPECT_EQ(threads.size(), size_t(4));
+            EXPECT_EQ(threads.count(std::this_thread::get_id()), size_t(0));
+
+            gateway.removeDevice(ids.front());
+            gateway.flush();
+            EXPECT_EQ(gateway.deviceCount(), size_t(199));
+            gateway.stop();
+            EXPECT_FALSE(gateway.running());
+        }
+
+        TEST(Gateway, messages) {
+            auto options = Gateway::Options{};
+            options.shards = 3;
+            options.pinThreads = false;
+            auto gateway = Gateway{nullptr, options};
+            gateway.start();
+
+            auto device = createTestDevice(0, std::chrono::seconds{0});
+            auto id = device->deviceID()->id();
+            // Only accessed on the shard thread, read after flush()
+            auto received = std::vector<std::pair<std::string, std::string>>{};
+            auto shardThread = std::thread::id{};
+            device->setMessageHandler([&](std::string_view topic, std::string_view payload) {
+                received.emplace_back(topic, payload);
+                shardThread = std::this_thread::get_id();
+            });
+            gateway.addDevice(device);
+
+            gateway.messageReceived("homie/" + id + "/light/power/set", "true");
+            gateway.messageReceived("homie/unknown/light/power/set", "false");
+            gateway.messageReceived("invalid", "false");
+            auto state = Device::State::init;
+            gateway.post(id, [&state](Device& device) { state = device.state(); });
+            gateway.flush();
+
+            ASSERT_EQ(received.size(), size_t(1));
+            EXPECT_EQ(received[0].first, "light/power/set");
+            EXPECT_EQ(received[0].second, "true");
+            EXPECT_NE(shardThread, std::this_thread::get_id());
+            EXPECT_EQ(state, device->state());
+
+            // Waiting for all shards on a shard thread is rejected instead of deadlocking
+            auto attributes = size_t{1};
+            gateway.post(id, [&gateway, &attributes](Device&) {
+                gateway.flush();
+                attributes = gateway.updateAll();
+            });
+            gateway.flush();
+            EXPECT_EQ(attributes, size_t(0));
+        }
+
+        TEST(Gateway, scheduledUpdates) {
+            auto options = Gateway::Options{};
+            options.shards = 2;
+            options.pinThreads = false;
+            options.resolution = std::chrono::milliseconds{10};
+            auto mutex = std::mutex{};
+            auto updates = size_t{0};
+            auto gateway = Gateway{[&](size_t, Device&, AttributeBuffer& buffer) {
+                    auto lock = std::lock_guard<std::mutex>{mutex};
+                    updates += buffer.empty() ? 0 : 1;
+                }, options};
+            gateway.start();
+            for(size_t i = 0; i < 10; ++i) {
+                gateway.addDevice(createTestDevice(i, std::chrono::seconds{1}));
+            }
+
+            // Every device is due within its first interval
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+            while(std::chrono::steady_clock::now() < deadline) {
+                {
+                    auto lock = std::lock_guard<std::mutex>{mutex};
+                    if(updates >= 10) {
+                        break;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            }
+            auto lock = std::lock_guard<std::mutex>{mutex};
+            EXPECT_GE(updates, size_t(10));
+        }
+    }
+}
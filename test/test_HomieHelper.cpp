@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "HomieHelper.h"
+
+namespace Rovi {
+    namespace Homie {
+        TEST(TopicPath, construction) {
+            {
+                auto path = TopicPath{};
+                EXPECT_TRUE(path.empty());
+                EXPECT_EQ(path.size(), size_t(0));
+                EXPECT_EQ(path.toString(), "");
+            }
+            {
+                auto path = TopicPath{"homie", "super-car", "$name"};
+                EXPECT_EQ(path.size(), size_t(3));
+                EXPECT_EQ(path.path(), "homie/super-car/$name");
+                EXPECT_EQ(path.toString(), "homie/super-car/$name/");
+                EXPECT_EQ(path.front(), "homie");
+                EXPECT_EQ(path.back(), "$name");
+            }
+            {
+                // Empty levels are kept
+                auto path = TopicPath{"homie", "super-car", ""};
+                EXPECT_EQ(path.size(), size_t(3));
+                EXPECT_EQ(path.toString(), "homie/super-car//");
+            }
+        }
+
+        TEST(TopicPath, append) {
+            auto path = TopicPath{"homie", "super-car"};
+            path.append("$stats");
+            EXPECT_EQ(path.toString(), "homie/super-car/$stats/");
+            path.append(TopicPath{"interval"});
+            EXPECT_EQ(path.size(), size_t(4));
+            EXPECT_EQ(path.toString(), "homie/super-car/$stats/interval/");
+            path.append(TopicPath{});
+            EXPECT_EQ(path.size(), size_t(4));
+
+            auto joined = TopicPath{TopicPath{"homie", "super-car"}, TopicPath{"$fw", "name"}};
+            EXPECT_EQ(joined.size(), size_t(4));
+            EXPECT_EQ(joined.toString(), "homie/super-car/$fw/name/");
+
+            auto empty = TopicPath{};
+            empty.append(TopicPath{"$fw", "name"});
+            EXPECT_EQ(empty, (TopicPath{"$fw", "name"}));
+            EXPECT_NE(empty, (TopicPath{"$fw", "version"}));
+        }
+
+        TEST(TopicPath, listConversion) {
+            auto levels = TopicListType{"homie", "super-car", "$fw", "name"};
+            auto path = TopicPath{levels};
+            EXPECT_EQ(path.toString(), "homie/super-car/$fw/name/");
+            EXPECT_EQ(path.toList(), levels);
+            EXPECT_EQ(TopicPath{}.toList(), TopicListType{});
+            EXPECT_EQ((TopicPath{"a", ""}.toList()), (TopicListType{"a", ""}));
+        }
+
+        TEST(TopicPath, fromPath) {
+            EXPECT_EQ(TopicPath::fromPath("homie/super-car/$name"), (TopicPath{"homie", "super-car", "$name"}));
+            EXPECT_EQ(TopicPath::fromPath("homie/super-car/"), (TopicPath{"homie", "super-car", ""}));
+            EXPECT_EQ(TopicPath::fromPath("homie"), TopicPath{"homie"});
+            EXPECT_TRUE(TopicPath::fromPath("").empty());
+        }
+
+        TEST(AttributeBuffer, append) {
+            auto buffer = AttributeBuffer{};
+            EXPECT_TRUE(buffer.empty());
+
+            const auto base = TopicPath{"homie", "super-car"};
+            buffer.append(base, TopicPath{"$name"}, "Super car");
+            buffer.append(base, TopicPath{"$stats", "interval"}, "60");
+            buffer.append(TopicPath{"homie", "$broadcast"}, "");
+            EXPECT_EQ(buffer.size(), size_t(3));
+            EXPECT_EQ(buffer.topic(0), "homie/super-car/$name");
+            EXPECT_EQ(buffer.payload(0), "Super car");
+            EXPECT_EQ(buffer.topic(1), "homie/super-car/$stats/interval");
+            EXPECT_EQ(buffer.payload(1), "60");
+            EXPECT_EQ(buffer.topic(2), "homie/$broadcast");
+            EXPECT_EQ(buffer.payload(2), "");
+
+            // All records are serialized back to back
+            EXPECT_EQ(std::string(buffer.data(), buffer.bytes()), "homie/super-car/$nameSuper carhomie/super-car/$stats/interval60homie/$broadcast");
+            EXPECT_EQ(buffer.records()[1].topicOffset, buffer.records()[0].payloadOffset + buffer.records()[0].payloadLength);
+
+            auto attributes = buffer.toAttributes();
+            EXPECT_EQ(attributes.size(), size_t(3));
+            EXPECT_EQ(attributes[1].first, (TopicPath{"homie", "super-car", "$stats", "interval"}));
+            EXPECT_EQ(attributes[1].second, "60");
+
+            buffer.clear();
+            EXPECT_TRUE(buffer.empty());
+            EXPECT_EQ(buffer.bytes(), size_t(0));
+
+            buffer.append(base, TopicPath{"temperature"}, TopicPath{"$unit"}, "°C");
+            buffer.appendPayload(base, TopicPath{"$stats", "uptime"}, [](auto& data) { data += "120"; });
+            EXPECT_EQ(buffer.topic(0), "homie/super-car/temperature/$unit");
+            EXPECT_EQ(buffer.payload(0), "°C");
+            EXPECT_EQ(buffer.topic(1), "homie/super-car/$stats/uptime");
+            EXPECT_EQ(buffer.payload(1), "120");
+        }
+
+        TEST(AttributeBuffer, cycleArena) {
+            auto arena = CycleArena{1024, std::pmr::null_memory_resource()};
+            const auto base = TopicPath{"homie", "super-car"};
+            for(auto cycle = 0; cycle < 4; ++cycle) {
+                {
+                    auto buffer = AttributeBuffer{arena.resource()};
+                    EXPECT_EQ(buffer.resource(), arena.resource());
+                    buffer.append(base, TopicPath{"$name"}, "Super car");
+                    buffer.append(base, TopicPath{"$state"}, "ready");
+                    EXPECT_EQ(buffer.topic(1), "homie/super-car/$state");
+                    EXPECT_EQ(buffer.payload(1), "ready");
+                }
+                // Without reset() the arena would run out of memory after a few cycles
+                arena.reset();
+            }
+
+            // Exceeding the arena requests more memory from the upstream resource
+            auto buffer = AttributeBuffer{arena.resource()};
+            EXPECT_THROW(buffer.reserve(1, 2048), std::bad_alloc);
+        }
+    }
+}
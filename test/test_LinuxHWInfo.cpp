@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "LinuxHWInfo.h"
+#include "Device.h"
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <thread>
+#include <atomic>
+
+#include <stdlib.h>
+
+namespace Rovi {
+    namespace Homie {
+        // Copy of the relevant parts of /proc and /sys in a temporary directory
+        class LinuxHWInfoTest : public ::testing::Test {
+            protected:
+                void SetUp() override {
+                    char directory[] = "/tmp/homie-hwinfo-XXXXXX";
+                    ASSERT_NE(mkdtemp(directory), nullptr);
+                    root = directory;
+                    write("proc/stat", "cpu  100 0 100 700 100 0 0 0 0 0\ncpu0 100 0 100 700 100 0 0 0 0 0\nintr 12345\n");
+                    write("proc/meminfo", "MemTotal:        8000000 kB\nMemFree:          100000 kB\nMemAvailable:     204800 kB\n");
+                    write("proc/uptime", "12345.67 23456.78\n");
+                    write("sys/class/thermal/thermal_zone0/type", "acpitz\n");
+                    write("sys/class/thermal/thermal_zone0/temp", "27800\n");
+                    write("sys/class/thermal/thermal_zone1/type", "x86_pkg_temp\n");
+                    write("sys/class/thermal/thermal_zone1/temp", "54321\n");
+                    write("sys/class/power_supply/AC/type", "Mains\n");
+                    write("sys/class/power_supply/BAT0/type", "Battery\n");
+                    write("sys/class/power_supply/BAT0/capacity", "87\n");
+                    write("sys/class/power_supply/BAT0/voltage_now", "12450000\n");
+                }
+
+                void TearDown() override {
+                    std::filesystem::remove_all(root);
+                }
+
+                // Rewrites the file in place, so open file descriptors see the new content
+                void write(const std::string& path, const std::string& content) {
+                    auto file = std::filesystem::path{root} / path;
+                    std::filesystem::create_directories(file.parent_path());
+                    std::ofstream{file, std::ios::trunc} << content;
+                }
+
+                std::string root;
+        };
+
+        TEST_F(LinuxHWInfoTest, sample) {
+            auto hwInfo = LinuxHWInfo{"DE:AD:BE:EF:FE:ED", "192.168.0.10", "linux", root};
+            EXPECT_EQ(hwInfo.supportedStats(), (std::list<Stats>{Stats::uptime, Stats::cputemp, Stats::cpuload,
+                Stats::battery, Stats::freeheap, Stats::supply}));
+            EXPECT_EQ(hwInfo.uptime(), std::chrono::seconds{12345});
+            EXPECT_EQ(hwInfo.cpuTemperature(), uint32_t(54));
+            EXPECT_EQ(hwInfo.batteryLevel(), uint32_t(87));
+            EXPECT_EQ(hwInfo.freeheap(), uint32_t(204800 * 1024));
+            EXPECT_FLOAT_EQ(hwInfo.supplyVoltage(), 12.45f);
+            // No previous sample
+            EXPECT_EQ(hwInfo.cpuLoad(), uint32_t(0));
+
+            // 30 busy and 70 idle/iowait ticks since the last sample
+            write("proc/stat", "cpu  120 5 105 760 110 0 0 0 0 0\n");
+            write("proc/uptime", "12405.00 23456.78\n");
+            write("sys/class/thermal/thermal_zone1/temp", "60000\n");
+            write("proc/meminfo", "MemTotal:        8000000 kB\nMemAvailable:   80000000 kB\n");
+
+            // Within the minimum sample interval the previous values are kept
+            hwInfo.sample();
+            EXPECT_EQ(hwInfo.uptime(), std::chrono::seconds{12345});
+
+            hwInfo.setMinimumSampleInterval(std::chrono::milliseconds{0});
+            hwInfo.sample();
+            EXPECT_EQ(hwInfo.uptime(), std::chrono::seconds{12405});
+            EXPECT_EQ(hwInfo.cpuLoad(), uint32_t(30));
+            EXPECT_EQ(hwInfo.cpuTemperature(), uint32_t(60));
+            // Saturated
+            EXPECT_EQ(hwInfo.freeheap(), std::numeric_limits<uint32_t>::max());
+
+            // All values of one sample at once
+            auto values = hwInfo.values();
+            EXPECT_EQ(values.uptime, std::chrono::seconds{12405});
+            EXPECT_EQ(values.cpuLoad, uint32_t(30));
+            EXPECT_EQ(values.batteryLevel, uint32_t(87));
+        }
+
+        TEST_F(LinuxHWInfoTest, shared) {
+            // Devices on several threads sample and read the same instance
+            auto hwInfo = std::make_shared<LinuxHWInfo>("DE:AD:BE:EF:FE:ED", "192.168.0.10", "linux", root);
+            hwInfo->setMinimumSampleInterval(std::chrono::milliseconds{0});
+            auto threads = std::vector<std::thread>{};
+            auto consistent = std::atomic<bool>{true};
+            for(auto i = 0; i < 4; ++i) {
+                threads.emplace_back([&hwInfo, &consistent]() {
+                    for(auto j = 0; j < 200; ++j) {
+                        hwInfo->sample();
+                        auto values = hwInfo->values();
+                        if(values.uptime != std::chrono::seconds{12345} || values.batteryLevel != 87) {
+                            consistent = false;
+                        }
+                    }
+                });
+            }
+            for(auto& thread : threads) {
+                thread.join();
+            }
+            EXPECT_TRUE(consistent);
+        }
+
+        TEST_F(LinuxHWInfoTest, missingSources) {
+            std::filesystem::remove_all(std::filesystem::path{root} / "sys");
+            auto hwInfo = std::make_shared<LinuxHWInfo>("DE:AD:BE:EF:FE:ED", "192.168.0.10", "linux", root);
+            EXPECT_EQ(hwInfo->supportedStats(), (std::list<Stats>{Stats::uptime, Stats::cpuload, Stats::freeheap}));
+
+            // The device only publishes the available stats
+            auto device = std::make_shared<Device>("Gateway", hwInfo, "firmware", std::make_shared<Version>(1, 0, 0), std::chrono::seconds{60});
+            auto stats = std::map<std::string, std::string>{};
+            for(auto& attribute : device->update()) {
+                stats[mqttPathToString(attribute.first)] = attribute.second;
+            }
+            EXPECT_EQ(stats.size(), size_t(3));
+            EXPECT_EQ(stats["homie/gateway-deadbeeffeed/$stats/uptime/"], "12345");
+            EXPECT_EQ(stats["homie/gateway-deadbeeffeed/$stats/freeheap/"], "209715200");
+        }
+
+        TEST(LinuxHWInfo, host) {
+            auto hwInfo = LinuxHWInfo{"DE:AD:BE:EF:FE:ED", "192.168.0.10", "linux"};
+            EXPECT_GT(hwInfo.uptime().count(), 0);
+            EXPECT_GT(hwInfo.freeheap(), uint32_t(0));
+            EXPECT_LE(hwInfo.cpuLoad(), uint32_t(100));
+        }
+    }
+}
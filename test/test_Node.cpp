@@ -19,7 +19,6 @@ namespace Rovi {
         const auto nodeName = std::string{"Car engine"};
         const auto type = std::string{"V8"};
 
-        const auto node = std::make_shared<Node>(nodeName, type);
         const auto nodeArray = std::make_shared<Node>(nodeName, type, 3);
         
         // TODOs:
@@ -29,9 +28,10 @@ namespace Rovi {
         // - Device.attribute(node) (inkl. arrays)
 
         TEST(Node, attributes) {   
-            device2->addNode(node);
-
-            auto device2Node = device2->node(node->value(Node::Attributes::nodeID));
+            auto device2Node = device2->addNode(nodeName, type);
+            ASSERT_NE(device2Node, nullptr);
+            EXPECT_EQ(device2->node("car-engine"), device2Node);
+            EXPECT_EQ(device2Node->device(), device2.get());
 
             auto mqttRawData = device2->connectionInitialized();
             printMqttMessages(mqttRawData);
@@ -42,6 +42,7 @@ namespace Rovi {
             }
             {
                 auto attribute = device2Node->attribute(Node::Attributes::name);
+                EXPECT_TRUE(mqttPathToString(attribute.first) == std::string{"homie/super-car-deadbeeffeed/car-engine/$name/"});
                 EXPECT_TRUE(attribute.second == std::string{"Car engine"});              
             }
             {
@@ -49,14 +50,18 @@ namespace Rovi {
                 EXPECT_TRUE(attribute.second == std::string{"V8"});              
             }
             {
-                // TODO
+                // No properties
                 auto attribute = device2Node->attribute(Node::Attributes::properties);
-                EXPECT_TRUE(attribute.second == std::string{"Not implemented yet!"});              
+                EXPECT_TRUE(attribute.second == std::string{""});              
             }
             {
                 auto attribute = device2Node->attribute(Node::Attributes::array);
                 EXPECT_TRUE(attribute.second == std::string{"0"});              
             }
+            {
+                EXPECT_TRUE(mqttPathToString(device2Node->baseTopic()) == std::string{"homie/super-car-deadbeeffeed/car-engine/"});
+                EXPECT_TRUE(mqttPathToString(nodeArray->baseTopic()) == std::string{"undefinded-device/"});
+            }
             {
                 EXPECT_TRUE(nodeArray->isArray());
                 auto attribute = nodeArray->attribute(Node::Attributes::array);
@@ -65,5 +70,27 @@ namespace Rovi {
 
 
         }
+
+        TEST(Node, ownership) {
+            // The device does not have to be owned by a std::shared_ptr
+            auto device = Device{"Tractor", hwInfo, firmwareName, firmwareVersion, statsInterval_s};
+            auto engine = device.addNode("Engine", "diesel");
+            auto wheels = device.addNode("Wheels", "tire", 4);
+            ASSERT_NE(engine, nullptr);
+            ASSERT_NE(wheels, nullptr);
+            EXPECT_EQ(device.addNode("engine", "electric"), nullptr);
+            EXPECT_EQ(device.node("unknown"), nullptr);
+
+            // Nodes keep their address while more nodes are added
+            for(auto i = 0; i < 32; ++i) {
+                device.addNode("Sensor " + std::to_string(i), "temperature");
+            }
+            EXPECT_EQ(device.node("engine"), engine);
+            EXPECT_EQ(device.node("wheels"), wheels);
+            EXPECT_EQ(device.node(std::string_view{"homie/tractor-deadbeeffeed/engine/$name"}.substr(27, 6)), engine);
+            EXPECT_EQ(wheels->device(), &device);
+            EXPECT_TRUE(mqttPathToString(wheels->baseTopic()) == std::string{"homie/tractor-deadbeeffeed/wheels/"});
+            EXPECT_EQ(nodeArray->device(), nullptr);
+        }
     }
 }
\ No newline at end of file
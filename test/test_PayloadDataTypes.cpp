@@ -31,9 +31,16 @@ namespace Rovi {
             EXPECT_FALSE(value.validateValue(" "));
             EXPECT_FALSE(value.validateValue("123 456"));
             EXPECT_FALSE(value.validateValue("123,456"));
+            EXPECT_TRUE(value.validateValue("9223372036854775807"));
+            EXPECT_TRUE(value.validateValue("-9223372036854775808"));
+            EXPECT_FALSE(value.validateValue("9223372036854775808"));          // Out of range
+            EXPECT_FALSE(value.validateValue("-9223372036854775809"));
+            EXPECT_FALSE(value.validateValue("99999999999999999999"));
 
             EXPECT_EQ(Integer{"123"}, Integer{123});
             EXPECT_EQ(Integer{"-123"}, Integer{-123});
+            EXPECT_EQ(Integer{"9223372036854775807"}.value(), std::numeric_limits<int64_t>::max());
+            EXPECT_EQ(Integer{"-9223372036854775808"}.value(), std::numeric_limits<int64_t>::min());
             EXPECT_NE(Integer{"123"}, Integer{-123});
             EXPECT_NE(Integer{"123"}, Integer{456});
 
@@ -105,6 +112,21 @@ namespace Rovi {
             EXPECT_FALSE(value.validateValue("-"));
             EXPECT_FALSE(value.validateValue(""));
             EXPECT_FALSE(value.validateValue(" "));
+            EXPECT_FALSE(value.validateValue("1-2"));
+            EXPECT_FALSE(value.validateValue("2e"));
+            EXPECT_FALSE(value.validateValue("2e-"));
+            EXPECT_FALSE(value.validateValue("2e8.5"));
+            EXPECT_FALSE(value.validateValue("."));
+            EXPECT_FALSE(value.validateValue("-."));
+            EXPECT_TRUE(value.validateValue("1e308"));
+            EXPECT_FALSE(value.validateValue("1e309"));                        // Out of range
+            EXPECT_FALSE(value.validateValue("-1e309"));
+
+            EXPECT_EQ(Float{"0.1"}.value(), 0.1);
+            EXPECT_EQ(Float{"-1.5e-3"}.value(), -1.5e-3);
+            EXPECT_EQ(Float{"3.14159265358979323846264"}.value(), 3.14159265358979323846264);
+            EXPECT_EQ(Float{"123456789012345678901234567890"}.value(), 123456789012345678901234567890.0);
+            EXPECT_EQ(Float{"1.7976931348623157e308"}.value(), std::numeric_limits<double>::max());
 
             EXPECT_EQ(Float{"123"}, Float{123});
             EXPECT_EQ(Float{"123.456"}, Float{123.456});
@@ -242,6 +264,46 @@ namespace Rovi {
             EXPECT_EQ(value.value(), "blue and green");
             EXPECT_EQ(value.toString(), "blue and green");
             EXPECT_TRUE(value.isValid());
+
+            // Values are stored as index into the lookup table
+            EXPECT_EQ(value.table().size(), size_t(5));
+            EXPECT_EQ(value.value().index(), value.table().find("blue and green"));
+            EXPECT_EQ(value.table().value(value.value().index()), "blue and green");
+            EXPECT_EQ(value.table().find("White"), value.table().find(std::string{"White"}));
+            EXPECT_EQ(value.table().find(" White "), EnumerationTable::invalidIndex);
+            EXPECT_EQ(value.table().find("Blu"), EnumerationTable::invalidIndex);
+            EXPECT_EQ(value.table().find("blue and green and red"), EnumerationTable::invalidIndex);
+            EXPECT_EQ(value.table().value(EnumerationTable::invalidIndex), "");
+
+            auto copy = value;
+            EXPECT_EQ(copy, value);
+            EXPECT_EQ(copy.value(), "blue and green");
+
+            // A value outlives its Enumeration
+            auto detached = []() {
+                auto enumeration = Enumeration{{"Red", "Green"}};
+                enumeration.setValue("Green");
+                return enumeration.value();
+            }();
+            EXPECT_EQ(detached.toString(), "Green");
+        }
+
+        TEST(PayploadDataTypes, EnumerationLarge) {
+            auto enumValues = std::set<std::string>{};
+            for(auto i = 0; i < 500; ++i) {
+                enumValues.insert("scene-" + StringUtils::toString(i));
+            }
+            enumValues.insert(" scene-1 ");             // Duplicate after trimming
+            auto value = Enumeration{enumValues};
+            EXPECT_EQ(value.table().size(), size_t(500));
+            for(auto i = 0; i < 500; ++i) {
+                auto payload = "scene-" + StringUtils::toString(i);
+                EXPECT_TRUE(value.setValue(payload));
+                EXPECT_EQ(value.value(), payload);
+            }
+            EXPECT_FALSE(value.setValue("scene-500"));
+            EXPECT_FALSE(value.setValue("scene-"));
+            EXPECT_EQ(value.value(), "scene-499");
         }
 
         TEST(PayploadDataTypes, Color_RGB) {
@@ -269,6 +331,12 @@ namespace Rovi {
             EXPECT_FALSE(value.validateValue("256,0,0"));
             EXPECT_FALSE(value.validateValue("0,256,0"));
             EXPECT_FALSE(value.validateValue("0,0,256"));
+            EXPECT_FALSE(value.validateValue("0,,00"));
+            EXPECT_FALSE(value.validateValue(",0,0"));
+            EXPECT_FALSE(value.validateValue("0,0"));
+            EXPECT_FALSE(value.validateValue("0,0,"));
+            EXPECT_FALSE(value.validateValue("255,255,2550"));
+            EXPECT_TRUE(value.validateValue("007,0,0"));
 
             auto a = Color{ColorFormat::RGB, ColorTuple{1,0,3}};
             auto c = Color{ColorFormat::RGB, ColorTuple(4,5,6)};
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "PayloadFormats.h"
+
+namespace Rovi {
+    namespace Homie {
+        struct CarColors {
+            static const char* const values[];
+        };
+        const char* const CarColors::values[] = {"Red", "Green", "Blue", "blue and green"};
+
+        TEST(PayloadFormats, Integer) {
+            auto value = StaticPayload<Format::Integer>{};
+            EXPECT_FALSE(value.isValid());
+            EXPECT_TRUE(StaticPayload<Format::Integer>::validatePayload("-123"));
+            EXPECT_FALSE(StaticPayload<Format::Integer>::validatePayload("123-"));
+            EXPECT_FALSE(StaticPayload<Format::Integer>::validatePayload("9223372036854775808"));
+
+            EXPECT_TRUE(value.setPayload("123"));
+            EXPECT_TRUE(value.isValid());
+            EXPECT_EQ(value.value(), 123);
+            EXPECT_FALSE(value.setPayload("abc"));
+            EXPECT_EQ(value.value(), 123);              // Still the last valid value
+            EXPECT_TRUE(value.setValue(-456));
+            EXPECT_EQ(value.toString(), "-456");
+        }
+
+        TEST(PayloadFormats, Float) {
+            auto value = StaticPayload<Format::Float>{};
+            EXPECT_TRUE(value.setPayload("2E-8"));
+            EXPECT_EQ(value.value(), 2e-8);
+            EXPECT_EQ(value.toString(), "2e-08");
+            EXPECT_FALSE(value.setPayload("NaN"));
+            EXPECT_FALSE(value.setValue(std::numeric_limits<double>::infinity()));
+            EXPECT_FALSE(value.setValue(std::nan("")));
+            EXPECT_EQ(value.value(), 2e-8);             // Still the last valid value
+
+            // Slow path: Not exactly representable by the fast path
+            EXPECT_TRUE(value.setPayload("3.14159265358979323846"));
+            EXPECT_EQ(value.value(), 3.14159265358979323846);
+            EXPECT_TRUE(value.setPayload("-2.5e100"));
+            EXPECT_EQ(value.value(), -2.5e100);
+            EXPECT_TRUE(value.setPayload("1e-400"));
+            EXPECT_EQ(value.value(), 0.0);
+            EXPECT_FALSE(value.setPayload("1e400"));
+            EXPECT_EQ(value.value(), 0.0);
+        }
+
+        TEST(PayloadFormats, Boolean) {
+            auto value = StaticPayload<Format::Boolean>{};
+            EXPECT_TRUE(value.setPayload("true"));
+            EXPECT_TRUE(value.value());
+            EXPECT_FALSE(value.setPayload("TRUE"));
+            EXPECT_FALSE(value.setPayload("fals"));
+            EXPECT_FALSE(value.setPayload(""));
+            EXPECT_TRUE(value.setPayload("false"));
+            EXPECT_FALSE(value.value());
+            EXPECT_EQ(value.toString(), "false");
+        }
+
+        TEST(PayloadFormats, String) {
+            auto value = StaticPayload<Format::String>{};
+            EXPECT_TRUE(value.setPayload(""));
+            EXPECT_TRUE(value.setPayload("abc"));
+            EXPECT_EQ(value.value(), "abc");
+            EXPECT_EQ(value.toString(), "abc");
+        }
+
+        TEST(PayloadFormats, Enumeration) {
+            auto value = StaticPayload<Format::Enumeration<CarColors>>{};
+            EXPECT_TRUE(value.setPayload("Red"));
+            EXPECT_TRUE(value.setPayload("blue and green"));
+            EXPECT_FALSE(value.setPayload("red"));
+            EXPECT_FALSE(value.setPayload("Re"));
+            EXPECT_FALSE(value.setPayload(""));
+            EXPECT_EQ(value.value(), "blue and green");
+            EXPECT_FALSE(value.setValue("black"));
+            EXPECT_TRUE(value.setValue("Green"));
+        }
+
+        TEST(PayloadFormats, Color) {
+            auto rgb = StaticPayload<Format::Color<ColorFormat::RGB>>{};
+            EXPECT_TRUE(rgb.setPayload("255,255,255"));
+            EXPECT_FALSE(rgb.setPayload("256,0,0"));
+            EXPECT_FALSE(rgb.setValue(ColorTuple{0, 0, 256}));
+            EXPECT_EQ(rgb.toString(), "255,255,255");
+
+            auto hsv = StaticPayload<Format::Color<ColorFormat::HSV>>{};
+            EXPECT_TRUE(hsv.setPayload("360,100,100"));
+            EXPECT_FALSE(hsv.setPayload("0,101,0"));
+            EXPECT_TRUE(hsv.setValue(ColorTuple{300, 50, 75}));
+            EXPECT_EQ(hsv.toString(), "300,50,75");
+
+            char buffer[Format::Color<ColorFormat::RGB>::maxLength];
+            EXPECT_EQ(Format::Color<ColorFormat::RGB>::format(buffer, ColorTuple{255, 255, 255}), size_t(11));
+            EXPECT_EQ(std::string(buffer, 11), "255,255,255");
+            EXPECT_EQ(Format::Color<ColorFormat::RGB>::format(buffer, ColorTuple{1000, 0, 0}), size_t(0));
+            EXPECT_EQ(Format::Color<ColorFormat::RGB>::format(buffer, ColorTuple{0, -1, 0}), size_t(0));
+            EXPECT_EQ(Format::Color<ColorFormat::RGB>::toString(ColorTuple{1000, -1, 0}), "1000,-1,0");
+
+            EXPECT_EQ(sizeof(StaticPayload<Format::Color<ColorFormat::RGB>>), sizeof(StaticPayload<Format::Color<ColorFormat::HSV>>));
+        }
+    }
+}
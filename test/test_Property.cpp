@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "Node.h"
+#include "Property.h"
+
+#include <map>
+
+namespace Rovi {
+    namespace Homie {
+        TEST(Property, add) {
+            auto properties = PropertyTable{};
+            EXPECT_EQ(properties.add({"Temperature", Datatype::floating, "-40:85", "°C"}), PropertyTable::Index{0});
+            EXPECT_EQ(properties.add({"Power", Datatype::boolean, "", "", true}), PropertyTable::Index{1});
+            EXPECT_EQ(properties.add({"Brightness", Datatype::integer, "0:100", "%", true}), PropertyTable::Index{2});
+            EXPECT_EQ(properties.add({"Mode", Datatype::enumeration, "eco, comfort,off", "", true}), PropertyTable::Index{3});
+            EXPECT_EQ(properties.add({"Light color", Datatype::color, "rgb", "", true}), PropertyTable::Index{4});
+            EXPECT_EQ(properties.add({"Label", Datatype::string}), PropertyTable::Index{5});
+
+            // Duplicate IDs and invalid formats
+            EXPECT_EQ(properties.add({"power", Datatype::boolean}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({"Range", Datatype::integer, "10:0"}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({"Range", Datatype::floating, "0-10"}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({"Enum", Datatype::enumeration, "a,,b"}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({"Color", Datatype::color, "cmyk"}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({""}), PropertyTable::invalidIndex);
+            // IDs which are not a valid topic level
+            EXPECT_EQ(properties.add({"temp/ext", Datatype::floating}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({"_x", Datatype::integer}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({"level+", Datatype::integer}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({"$state", Datatype::string}), PropertyTable::invalidIndex);
+            EXPECT_EQ(properties.add({" Speed", Datatype::integer}), PropertyTable::invalidIndex);
+
+            EXPECT_EQ(properties.size(), size_t{6});
+            EXPECT_EQ(properties.ids(), "temperature,power,brightness,mode,light-color,label");
+            EXPECT_EQ(properties.find("light-color"), PropertyTable::Index{4});
+            EXPECT_EQ(properties.find("Light color"), PropertyTable::invalidIndex);
+
+            // Initial values are within the range, enums start with their first value
+            EXPECT_EQ(properties.payload(0), "0");
+            EXPECT_EQ(properties.payload(1), "false");
+            EXPECT_EQ(properties.payload(3), "eco");
+            EXPECT_EQ(properties.payload(4), "0,0,0");
+            EXPECT_EQ(properties.payload(5), "");
+            auto offset = PropertyTable{};
+            offset.add({"Offset", Datatype::integer, "5:10"});
+            EXPECT_EQ(offset.integer(0), 5);
+        }
+
+        TEST(Property, values) {
+            auto properties = PropertyTable{};
+            auto temperature = properties.add({"Temperature", Datatype::floating, "-40:85", "°C"});
+            auto power = properties.add({"Power", Datatype::boolean});
+            auto brightness = properties.add({"Brightness", Datatype::integer, "0:100"});
+            auto mode = properties.add({"Mode", Datatype::enumeration, "eco,comfort,off"});
+            auto color = properties.add({"Color", Datatype::color, "hsv"});
+            auto label = properties.add({"Label", Datatype::string});
+
+            EXPECT_TRUE(properties.setFloat(temperature, 21.5));
+            EXPECT_FALSE(properties.setFloat(temperature, 90.0));
+            EXPECT_FALSE(properties.setInteger(temperature, 20));
+            EXPECT_DOUBLE_EQ(properties.floating(temperature), 21.5);
+            EXPECT_EQ(properties.payload(temperature), "21.5");
+
+            EXPECT_TRUE(properties.setPayload(power, "true"));
+            EXPECT_FALSE(properties.setPayload(power, "1"));
+            EXPECT_TRUE(properties.boolean(power));
+
+            EXPECT_TRUE(properties.setPayload(brightness, "42"));
+            EXPECT_FALSE(properties.setPayload(brightness, "101"));
+            EXPECT_FALSE(properties.setPayload(brightness, "4.2"));
+            EXPECT_EQ(properties.integer(brightness), 42);
+
+            EXPECT_TRUE(properties.setPayload(mode, "comfort"));
+            EXPECT_FALSE(properties.setPayload(mode, "Comfort"));
+            EXPECT_FALSE(properties.setPayload(mode, ""));
+            EXPECT_EQ(properties.string(mode), "comfort");
+
+            // Whitespace around the values of the format is ignored
+            auto level = properties.add({"Level", Datatype::enumeration, " low, high "});
+            EXPECT_EQ(properties.string(level), "low");
+            EXPECT_TRUE(properties.setPayload(level, "high"));
+            EXPECT_FALSE(properties.setPayload(level, " high"));
+            EXPECT_EQ(properties.payload(level), "high");
+            auto buffer = AttributeBuffer{};
+            properties.appendAttributes(buffer, TopicType{"node"});
+            auto format = std::string{};
+            for(size_t i = 0; i < buffer.size(); ++i) {
+                if(buffer.topic(i) == "node/level/$format") {
+                    format = buffer.payload(i);
+                }
+            }
+            EXPECT_EQ(format, "low,high");
+
+            EXPECT_TRUE(properties.setPayload(color, "360,100,50"));
+            EXPECT_FALSE(properties.setPayload(color, "255,255,255"));
+            EXPECT_EQ(properties.color(color), (ColorTuple{360, 100, 50}));
+            EXPECT_EQ(properties.payload(color), "360,100,50");
+
+            EXPECT_TRUE(properties.setString(label, "Living room"));
+            EXPECT_FALSE(properties.setString(power, "Living room"));
+            EXPECT_EQ(properties.payload(label), "Living room");
+        }
+
+        TEST(Property, publication) {
+            auto hwInfo = std::make_shared<HWInfo>("DE:AD:BE:EF:FE:ED", "192.168.0.10", "esp32");
+            auto device = std::make_shared<Device>("Thermostat", hwInfo, "thermostat-firmware",
+                std::make_shared<Version>(1, 0, 0), std::chrono::seconds{60});
+            auto node = device->addNode("Heater", "radiator");
+            auto temperature = node->addProperty({"Temperature", Datatype::floating, "", "°C"});
+            auto target = node->addProperty({"Target", Datatype::integer, "5:30", "°C", true});
+            node->addProperty({"Mode", Datatype::enumeration, "eco,comfort", "", true, false});
+
+            auto buffer = AttributeBuffer{};
+            device->connectionInitialized(buffer);
+            auto attributes = std::map<std::string, std::string>{};
+            for(size_t i = 0; i < buffer.size(); ++i) {
+                attributes[std::string{buffer.topic(i)}] = std::string{buffer.payload(i)};
+            }
+            auto nodeTopic = std::string{"homie/thermostat-deadbeeffeed/heater/"};
+            EXPECT_EQ(attributes[nodeTopic + "$properties"], "temperature,target,mode");
+            EXPECT_EQ(attributes[nodeTopic + "temperature/$name"], "Temperature");
+            EXPECT_EQ(attributes[nodeTopic + "temperature/$datatype"], "float");
+            EXPECT_EQ(attributes.count(nodeTopic + "temperature/$format"), size_t{0});
+            EXPECT_EQ(attributes[nodeTopic + "temperature/$settable"], "false");
+            EXPECT_EQ(attributes[nodeTopic + "temperature/$unit"], "°C");
+            EXPECT_EQ(attributes[nodeTopic + "temperature"], "0");
+            EXPECT_EQ(attributes[nodeTopic + "target/$format"], "5:30");
+            EXPECT_EQ(attributes[nodeTopic + "target/$settable"], "true");
+            EXPECT_EQ(attributes[nodeTopic + "target"], "5");
+            EXPECT_EQ(attributes[nodeTopic + "mode/$datatype"], "enum");
+            EXPECT_EQ(attributes[nodeTopic + "mode/$retained"], "false");
+            EXPECT_EQ(attributes[nodeTopic + "mode"], "eco");
+            // Only the value of a non-retained property is sent without the retain flag
+            for(size_t i = 0; i < buffer.size(); ++i) {
+                EXPECT_EQ(buffer.retained(i), buffer.topic(i) != nodeTopic + "mode");
+            }
+            // $state is the last attribute
+            EXPECT_EQ(buffer.topic(buffer.size() - 1), "homie/thermostat-deadbeeffeed/$state");
+
+            // Only settable properties can be set via <property>/set
+            EXPECT_FALSE(node->setProperty("temperature", "20"));
+            EXPECT_FALSE(node->setProperty("unknown", "20"));
+            EXPECT_FALSE(node->setProperty("target", "31"));
+            EXPECT_TRUE(node->setProperty("target", "21"));
+            EXPECT_TRUE(node->properties().setFloat(temperature, 19.25));
+
+            // update() only publishes the changed values
+            buffer.clear();
+            node->update(buffer);
+            ASSERT_EQ(buffer.size(), size_t{2});
+            EXPECT_EQ(buffer.topic(0), nodeTopic + "target");
+            EXPECT_EQ(buffer.payload(0), "21");
+            EXPECT_EQ(buffer.topic(1), nodeTopic + "temperature");
+            EXPECT_EQ(buffer.payload(1), "19.25");
+            EXPECT_EQ(node->properties().integer(target), 21);
+            buffer.clear();
+            node->update(buffer);
+            EXPECT_TRUE(buffer.empty());
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "StatsScheduler.h"
+#include "TestDevices.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace Rovi {
+    namespace Homie {
+        class FakeClock {
+            public:
+                StatsScheduler::Clock::time_point now() const { return m_now; }
+                void advance(const StatsScheduler::Clock::duration duration) { m_now += duration; }
+
+            private:
+                StatsScheduler::Clock::time_point m_now{std::chrono::hours{1}};
+        };
+
+        TEST(StatsScheduler, intervals) {
+            auto clock = FakeClock{};
+            auto updates = std::map<const Device*, std::vector<StatsScheduler::Clock::time_point>>{};
+            auto scheduler = StatsScheduler{[&](Device& device, AttributeBuffer& buffer) {
+                    EXPECT_EQ(buffer.size(), size_t(7));
+                    updates[&device].push_back(clock.now());
+                }, std::chrono::milliseconds{100}, [&clock]() { return clock.now(); }};
+
+            auto devices = std::vector<std::shared_ptr<Device>>{};
+            for(size_t i = 0; i < 200; ++i) {
+                devices.push_back(createTestDevice(i, std::chrono::seconds{i % 2 == 0 ? 60 : 10}));
+                EXPECT_TRUE(scheduler.addDevice(devices.back()));
+            }
+            EXPECT_FALSE(scheduler.addDevice(devices.front()));
+            EXPECT_EQ(scheduler.deviceCount(), size_t(200));
+
+            // Two minutes in steps of the resolution
+            auto updatesPerSecond = std::map<int64_t, size_t>{};
+            for(auto i = 0; i < 1200; ++i) {
+                clock.advance(std::chrono::milliseconds{100});
+                auto count = scheduler.poll();
+                updatesPerSecond[i / 10] += count;
+            }
+
+            for(size_t i = 0; i < devices.size(); ++i) {
+                auto& times = updates[devices[i].get()];
+                auto interval = devices[i]->statsInterval_s();
+                ASSERT_EQ(times.size(), size_t(std::chrono::seconds{120} / interval)) << i;
+                for(size_t k = 1; k < times.size(); ++k) {
+                    EXPECT_EQ(times[k] - times[k - 1], interval);
+                }
+            }
+            // Phases are spread: 100 devices * 2 updates/min + 100 devices * 12 updates/min = 1400 updates in 120 s
+            auto maxPerSecond = size_t{0};
+            for(auto& second : updatesPerSecond) {
+                maxPerSecond = std::max(maxPerSecond, second.second);
+            }
+            EXPECT_LT(maxPerSecond, size_t(40));
+            EXPECT_EQ(scheduler.lateness().updates, uint64_t(1400));
+            EXPECT_EQ(scheduler.lateness().max, StatsScheduler::Clock::duration::zero());
+        }
+
+        TEST(StatsScheduler, lateness) {
+            auto clock = FakeClock{};
+            auto count = size_t{0};
+            auto scheduler = StatsScheduler{[&](Device&, AttributeBuffer&) { ++count; },
+                std::chrono::milliseconds{100}, [&clock]() { return clock.now(); }};
+            auto device = createTestDevice(0, std::chrono::seconds{10});
+            scheduler.addDevice(device);
+
+            // First update within the first interval
+            for(auto i = 0; i < 100 && count == 0; ++i) {
+                clock.advance(std::chrono::milliseconds{100});
+                scheduler.poll();
+            }
+            EXPECT_EQ(count, size_t(1));
+            EXPECT_EQ(scheduler.lateness().max, StatsScheduler::Clock::duration::zero());
+            scheduler.resetLateness();
+
+            // Polled 2.5 s late
+            clock.advance(std::chrono::milliseconds{12500});
+            EXPECT_EQ(scheduler.poll(), size_t(1));
+            EXPECT_GE(scheduler.lateness().max, std::chrono::milliseconds{2400});
+            EXPECT_LE(scheduler.lateness().max, std::chrono::milliseconds{2600});
+            EXPECT_EQ(scheduler.lateness().skipped, uint64_t(0));
+
+            // Polled 35 s late: One update, three intervals skipped, the phase is kept
+            scheduler.resetLateness();
+            clock.advance(std::chrono::seconds{45});
+            EXPECT_EQ(scheduler.poll(), size_t(1));
+            EXPECT_EQ(scheduler.lateness().skipped, uint64_t(3));
+            clock.advance(std::chrono::seconds{10});
+            EXPECT_EQ(scheduler.poll(), size_t(1));
+            EXPECT_EQ(count, size_t(4));
+
+            EXPECT_TRUE(scheduler.removeDevice(*device));
+            EXPECT_FALSE(scheduler.removeDevice(*device));
+            clock.advance(std::chrono::seconds{60});
+            EXPECT_EQ(scheduler.poll(), size_t(0));
+        }
+    }
+}
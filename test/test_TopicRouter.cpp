@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "TopicRouter.h"
+
+#include <string>
+#include <vector>
+
+namespace Rovi {
+    namespace Homie {
+        TEST(TopicRouter, exact) {
+            auto router = TopicRouter{};
+            auto calls = std::vector<std::string>{};
+            auto handler = [&calls](const std::string& name) {
+                return [&calls, name](std::string_view topic, std::string_view payload) {
+                    calls.push_back(name + ":" + std::string{topic} + "=" + std::string{payload});
+                };
+            };
+            EXPECT_TRUE(router.add("homie/device/light/power/set", handler("power")));
+            EXPECT_TRUE(router.add("homie/device/light/color/set", handler("color")));
+            EXPECT_TRUE(router.add("homie/other/light/power/set", handler("other")));
+            EXPECT_TRUE(router.add("homie/device/light", handler("node")));
+            EXPECT_EQ(router.size(), size_t(4));
+
+            EXPECT_TRUE(router.dispatch("homie/device/light/power/set", "true"));
+            EXPECT_TRUE(router.dispatch("homie/other/light/power/set", "false"));
+            EXPECT_TRUE(router.dispatch("homie/device/light", "x"));
+            EXPECT_FALSE(router.dispatch("homie/device/light/power", "true"));
+            EXPECT_FALSE(router.dispatch("homie/device/light/power/set/", "true"));
+            EXPECT_FALSE(router.dispatch("homie/device", "true"));
+            EXPECT_FALSE(router.dispatch("", "true"));
+            ASSERT_EQ(calls.size(), size_t(3));
+            EXPECT_EQ(calls[0], "power:homie/device/light/power/set=true");
+            EXPECT_EQ(calls[1], "other:homie/other/light/power/set=false");
+            EXPECT_EQ(calls[2], "node:homie/device/light=x");
+
+            // Replace and remove
+            EXPECT_TRUE(router.add("homie/device/light/power/set", handler("replaced")));
+            EXPECT_EQ(router.size(), size_t(4));
+            router.dispatch("homie/device/light/power/set", "false");
+            EXPECT_EQ(calls.back(), "replaced:homie/device/light/power/set=false");
+            EXPECT_TRUE(router.remove("homie/device/light/power/set"));
+            EXPECT_FALSE(router.remove("homie/device/light/power/set"));
+            EXPECT_FALSE(router.remove("homie/device/light/power"));
+            EXPECT_FALSE(router.dispatch("homie/device/light/power/set", "true"));
+            EXPECT_TRUE(router.dispatch("homie/device/light/color/set", "0,0,0"));
+            EXPECT_EQ(router.size(), size_t(3));
+        }
+
+        TEST(TopicRouter, wildcards) {
+            auto router = TopicRouter{};
+            auto last = std::string{};
+            auto handler = [&last](const std::string& name) {
+                return [&last, name](std::string_view, std::string_view) { last = name; };
+            };
+            EXPECT_FALSE(router.add("homie/#/set", handler("invalid")));
+            EXPECT_FALSE(router.add("homie/dev+/set", handler("invalid")));
+            EXPECT_FALSE(router.add("", handler("invalid")));
+            EXPECT_EQ(router.size(), size_t(0));
+
+            EXPECT_TRUE(router.add("homie/device/#", handler("device")));
+            EXPECT_TRUE(router.add("homie/device/+/+/set", handler("set")));
+            EXPECT_TRUE(router.add("homie/device/light/power/set", handler("power")));
+            EXPECT_TRUE(router.add("homie/$broadcast/#", handler("broadcast")));
+            EXPECT_TRUE(router.add("+/+/$state", handler("state")));
+
+            // Most specific route first
+            auto route = [&](std::string_view topic) {
+                last.clear();
+                router.dispatch(topic, "");
+                return last;
+            };
+            EXPECT_EQ(route("homie/device/light/power/set"), "power");
+            EXPECT_EQ(route("homie/device/light/color/set"), "set");
+            EXPECT_EQ(route("homie/device/light/color"), "device");
+            EXPECT_EQ(route("homie/device"), "device");
+            EXPECT_EQ(route("homie/$broadcast/alert"), "broadcast");
+            EXPECT_EQ(route("homie/other/$state"), "state");
+            // Precedence is decided level by level, from the first level on
+            EXPECT_EQ(route("homie/device/$state"), "device");
+            EXPECT_EQ(route("homie/other/light/power/set"), "");
+            // No wildcard match for $ topics in the first level
+            EXPECT_EQ(route("$SYS/broker/$state"), "");
+        }
+
+        TEST(TopicRouter, manyRoutes) {
+            auto router = TopicRouter{};
+            auto calls = std::vector<int>{};
+            for(auto device = 0; device < 100; ++device) {
+                for(auto property = 0; property < 100; ++property) {
+                    auto topic = "homie/device-" + std::to_string(device) + "/node/property-" + std::to_string(property) + "/set";
+                    router.add(topic, [&calls, value = device * 100 + property](std::string_view, std::string_view) { calls.push_back(value); });
+                }
+            }
+            EXPECT_EQ(router.size(), size_t(10000));
+            for(auto i = 0; i < 10000; i += 7) {
+                auto topic = "homie/device-" + std::to_string(i / 100) + "/node/property-" + std::to_string(i % 100) + "/set";
+                ASSERT_TRUE(router.dispatch(topic, ""));
+                EXPECT_EQ(calls.back(), i);
+            }
+            EXPECT_FALSE(router.dispatch("homie/device-100/node/property-0/set", ""));
+        }
+    }
+}